@@ -20,6 +20,9 @@ page_rep_algo="FIFO CLOCK AGING"
 search_algo="quicksort"
 search_algo="quicksort bubblesort"
 
+# storage device of the cost model of mmanage: hdd ssd nvme
+storage="ssd"
+
 ref_result_dir="./LogFiles_mit_SEED_2806"
 
 # Simulation summary file
@@ -29,12 +32,11 @@ all_results=all_results
 rm -rf results $all_results
 mkdir results
 
-for s in $page_sizes ; do
-    # page size be be seed via C define Statement
-    # compile 
-    make clean
-    make VMEM_PAGESIZE=$s 
+# compile once, page size will be set via command line parameter of mmanage
+make clean
+make
 
+for s in $page_sizes ; do
     # iterate for all page replacement algorithms and all seed values
     for a in $page_rep_algo ; do
 		for sa in $search_algo ; do 
@@ -44,8 +46,9 @@ for s in $page_sizes ; do
 				# delete all shared memory areas
 				# ipcrm -ashm
 
-				# start memory manageer
-				./bin/mmanage -$a  &
+				# start memory manageer, statistics will be printed to stdout on termination
+				statsfile="./results/stats_${seed}_${sa}_${a}_${s}.txt"
+				./bin/mmanage -$a -pagesize=$s -storage=$storage > $statsfile &
 				 mmanage_pid=$!
 
 				 sleep 1  # wait for mmange to create shared objects
@@ -62,7 +65,9 @@ for s in $page_sizes ; do
 				 pagefaults="${pagefaults//,/}"
 				 globalcount=$(grep "Global count" logfile.txt | tail -n1 | awk "{ print \$6 }")
 				 globalcount="${globalcount//:/}"
-				 printf "seed = %6i page_rep_algo = %7s search_algo = %12s pagesize = %4i pagefaults %7s global_count %7s\n" "$seed" "$a" "$sa" "$s" "$pagefaults" "$globalcount" >> $all_results
+				 runtime=$(grep "Modeled runtime" $statsfile | awk "{ print \$3 }")
+				 eat=$(grep "Modeled runtime" $statsfile | awk "{ print \$8 }")
+				 printf "seed = %6i page_rep_algo = %7s search_algo = %12s pagesize = %4i pagefaults %7s global_count %7s eat_ns %10s runtime_ms %12s\n" "$seed" "$a" "$sa" "$s" "$pagefaults" "$globalcount" "$eat" "$runtime" >> $all_results
 
 				 # save result files and compare for seed=2806
 				 mv logfile.txt ./results/logfile_${seed}_${sa}_${a}_${s}.txt  
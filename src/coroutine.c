@@ -0,0 +1,138 @@
+/**
+ * @file coroutine.c
+ * @date Oct 2026
+ * @brief This is a stackful coroutine runtime based on ucontext. The scheduler
+ * runs the ready coroutines round robin. Coroutines are switched only when they
+ * yield, block or finish, hence they need no locks among each other.
+ */
+
+#include <stdlib.h>
+#include <ucontext.h>
+#include "error.h"
+#include "coroutine.h"
+
+#define CO_FREE     0   //!< Entry unused
+#define CO_READY    1   //!< Coroutine may run
+#define CO_BLOCKED  2   //!< Coroutine waits for co_wake
+#define CO_DONE     3   //!< Coroutine has finished
+
+/**
+ * A coroutine
+ */
+struct coroutine {
+    ucontext_t ctx;          //!< saved context
+    void *stack;             //!< stack of coroutine
+    int state;               //!< see CO_* states
+    void (*fn)(void *);      //!< function executed by coroutine
+    void *arg;               //!< argument of fn
+    int joiner;              //!< coroutine waiting in co_join; CO_NONE: none
+};
+
+static struct coroutine cos[CO_MAX];
+static int nspawned = 0;            //!< number of coroutines created by the current co_run
+static int current = CO_NONE;       //!< running coroutine
+static ucontext_t scheduler_ctx;    //!< context of co_run
+
+/**
+ *****************************************************************************************
+ *  @brief      This function is the entry of all coroutines. It runs the function of
+ *              the coroutine and returns to the scheduler via uc_link.
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void co_entry(void) {
+    struct coroutine *co = &cos[current];
+    co->fn(co->arg);
+    co->state = CO_DONE;
+    if (co->joiner != CO_NONE) {
+        co_wake(co->joiner);
+    }
+}
+
+int co_spawn(void (*fn)(void *), void *arg) {
+    TEST_AND_EXIT(nspawned >= CO_MAX, (stderr, "co_spawn: more than %d coroutines\n", CO_MAX));
+    int id = nspawned++;
+    struct coroutine *co = &cos[id];
+
+    co->stack = malloc(CO_STACKSIZE);
+    TEST_AND_EXIT_ERRNO(!co->stack, "co_spawn: malloc of stack failed");
+    TEST_AND_EXIT_ERRNO(getcontext(&co->ctx) == -1, "co_spawn: getcontext failed");
+    co->ctx.uc_stack.ss_sp = co->stack;
+    co->ctx.uc_stack.ss_size = CO_STACKSIZE;
+    co->ctx.uc_link = &scheduler_ctx;
+    makecontext(&co->ctx, co_entry, 0);
+    co->fn = fn;
+    co->arg = arg;
+    co->joiner = CO_NONE;
+    co->state = CO_READY;
+    return id;
+}
+
+void co_run(void (*idle)(void)) {
+    int next = 0;
+    int live = 0;
+
+    TEST_AND_EXIT(current != CO_NONE, (stderr, "co_run: called by a coroutine\n"));
+    do {
+        int id = CO_NONE;
+        live = 0;
+        // round robin: first ready coroutine after the one that ran last
+        for (int i = 0; i < nspawned; i++) {
+            int c = (next + i) % nspawned;
+            live += (cos[c].state == CO_READY) || (cos[c].state == CO_BLOCKED);
+            if ((id == CO_NONE) && (cos[c].state == CO_READY)) {
+                id = c;
+            }
+        }
+        if (id != CO_NONE) {
+            current = id;
+            TEST_AND_EXIT_ERRNO(swapcontext(&scheduler_ctx, &cos[id].ctx) == -1, "co_run: swapcontext failed");
+            current = CO_NONE;
+            next = (id + 1) % nspawned;
+        } else if (live > 0) {
+            TEST_AND_EXIT(idle == NULL, (stderr, "co_run: all coroutines blocked\n"));
+            idle();
+        }
+    } while (live > 0);
+
+    for (int i = 0; i < nspawned; i++) {
+        free(cos[i].stack);
+        cos[i].stack = NULL;
+        cos[i].state = CO_FREE;
+    }
+    nspawned = 0;
+}
+
+int co_current(void) {
+    return current;
+}
+
+void co_yield(void) {
+    TEST_AND_EXIT(current == CO_NONE, (stderr, "co_yield: called outside of a coroutine\n"));
+    TEST_AND_EXIT_ERRNO(swapcontext(&cos[current].ctx, &scheduler_ctx) == -1, "co_yield: swapcontext failed");
+}
+
+void co_block(void) {
+    TEST_AND_EXIT(current == CO_NONE, (stderr, "co_block: called outside of a coroutine\n"));
+    cos[current].state = CO_BLOCKED;
+    co_yield();
+}
+
+void co_wake(int id) {
+    TEST_AND_EXIT((id < 0) || (id >= nspawned), (stderr, "co_wake: undefined coroutine\n"));
+    if (cos[id].state == CO_BLOCKED) {
+        cos[id].state = CO_READY;
+    }
+}
+
+void co_join(int id) {
+    TEST_AND_EXIT((id < 0) || (id >= nspawned), (stderr, "co_join: undefined coroutine\n"));
+    TEST_AND_EXIT(cos[id].joiner != CO_NONE, (stderr, "co_join: coroutine joined twice\n"));
+    while (cos[id].state != CO_DONE) {
+        cos[id].joiner = current;
+        co_block();
+    }
+    cos[id].joiner = CO_NONE;
+}
+
+// EOF
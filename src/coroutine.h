@@ -0,0 +1,90 @@
+/**
+ * @file coroutine.h
+ * @date Oct 2026
+ * @brief Header file of a stackful coroutine runtime based on ucontext.
+ *        All coroutines run within the thread that calls co_run. A coroutine
+ *        runs until it finishes, yields or blocks. When no coroutine is ready,
+ *        the scheduler calls the idle function, that must wake up blocked
+ *        coroutines, e.g. after an asynchronous request has been completed.
+ */
+
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#include <stdbool.h>
+
+#define CO_MAX       64          //!< Maximal number of coroutines
+#define CO_STACKSIZE (256 * 1024) //!< Stack size of a coroutine
+#define CO_NONE      -1          //!< Id returned by co_current outside of coroutines
+
+/**
+ *****************************************************************************************
+ *  @brief      This function creates a new coroutine. It will be ready to run.
+ *              It may be called by the main program before co_run or by a coroutine.
+ *
+ *  @param      fn Function executed by the coroutine
+ *  @param      arg Argument passed to fn
+ *
+ *  @return     Id of the coroutine
+ ****************************************************************************************/
+int co_spawn(void (*fn)(void *), void *arg);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function runs the scheduler until all coroutines have finished.
+ *
+ *  @param      idle Function called, when no coroutine is ready. It must block until
+ *              a coroutine has been woken up by co_wake.
+ *
+ *  @return     void
+ ****************************************************************************************/
+void co_run(void (*idle)(void));
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the id of the running coroutine.
+ *
+ *  @return     Id of coroutine; CO_NONE, if called outside of a coroutine
+ ****************************************************************************************/
+int co_current(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function passes control to the next ready coroutine. The running
+ *              coroutine stays ready.
+ *
+ *  @return     void
+ ****************************************************************************************/
+void co_yield(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function blocks the running coroutine until it will be woken up
+ *              by co_wake.
+ *
+ *  @return     void
+ ****************************************************************************************/
+void co_block(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function makes a blocked coroutine ready again.
+ *
+ *  @param      id Id of coroutine
+ *
+ *  @return     void
+ ****************************************************************************************/
+void co_wake(int id);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function blocks the running coroutine until another coroutine
+ *              has finished.
+ *
+ *  @param      id Id of coroutine to wait for
+ *
+ *  @return     void
+ ****************************************************************************************/
+void co_join(int id);
+
+#endif /* COROUTINE_H */
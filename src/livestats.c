@@ -0,0 +1,64 @@
+/**
+ * @file livestats.c
+ * @date Oct 2026
+ * @brief This is the implementation of the live statistics. The statistics are
+ * stored in a POSIX shared memory object apart from virtual memory, so a monitor
+ * needs no knowledge of the backing and the layout of virtual memory.
+ */
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "error.h"
+#include "livestats.h"
+
+struct livestats *livestats_create(int algo) {
+    int fd = shm_open(LIVESTATS_NAME, O_RDWR | O_CREAT | O_TRUNC, 0664);
+    TEST_AND_EXIT_ERRNO(fd == -1, "shm_open of live statistics failed!");
+    TEST_AND_EXIT_ERRNO(ftruncate(fd, sizeof(struct livestats)) == -1, "ftruncate of live statistics failed");
+    struct livestats *ls = mmap(NULL, sizeof(struct livestats), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    TEST_AND_EXIT_ERRNO(ls == MAP_FAILED, "Error mapping live statistics");
+    close(fd);
+
+    // ftruncate has cleared the object; the magic number is set last
+    ls->version = LIVESTATS_VERSION;
+    ls->pid = getpid();
+    ls->pagesize = VMEM_GEO_PAGESIZE;
+    ls->nframes = VMEM_NFRAMES;
+    ls->nclients = VMEM_NCLIENTS;
+    ls->algo = algo;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(ls->magic, LIVESTATS_MAGIC, sizeof(ls->magic));
+    return ls;
+}
+
+struct livestats *livestats_attach(bool writable) {
+    struct stat st;
+    int fd = shm_open(LIVESTATS_NAME, writable ? O_RDWR : O_RDONLY, 0);
+    if (fd == -1) {
+        return NULL;
+    }
+    if ((fstat(fd, &st) == -1) || (st.st_size < (off_t) sizeof(struct livestats))) {
+        close(fd); // not sized yet
+        return NULL;
+    }
+    struct livestats *ls = mmap(NULL, sizeof(struct livestats), writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                                MAP_SHARED, fd, 0);
+    close(fd);
+    if (ls == MAP_FAILED) {
+        return NULL;
+    }
+    if ((memcmp(ls->magic, LIVESTATS_MAGIC, sizeof(ls->magic)) != 0) || (ls->version != LIVESTATS_VERSION)) {
+        munmap(ls, sizeof(struct livestats));
+        return NULL;
+    }
+    return ls;
+}
+
+void livestats_remove(void) {
+    shm_unlink(LIVESTATS_NAME);
+}
+
+// EOF
@@ -0,0 +1,109 @@
+/**
+ * @file livestats.h
+ * @date Oct 2026
+ * @brief Header file of the live statistics of a running simulation. mmanage
+ *        started with -stats creates a shared memory object of its own, that
+ *        mmanage and vmaccess update by relaxed atomic operations. A monitor,
+ *        e.g. vmmon, attaches it read-only and computes rates, so a long run can
+ *        be observed without stopping it.
+ *
+ *        The counters of mmanage and of each client start on their own cache
+ *        line, so the writers do not share lines. The gauges of frames are
+ *        sampled periodically by mmanage.
+ */
+
+#ifndef LIVESTATS_H
+#define LIVESTATS_H
+
+#include <stdbool.h>
+#include "vmem.h"
+#include "pagerep.h"
+
+#define LIVESTATS_NAME      "/BS_A3_vmstat"  //!< name of POSIX shared memory object
+#define LIVESTATS_MAGIC     "VMEMSTAT"       //!< first bytes of shared memory object
+#define LIVESTATS_VERSION   1                //!< incremented, when the layout changes
+#define LIVESTATS_SAMPLE_MS 100              //!< period of sampling the gauges in ms
+
+/**
+ * Counters of mmanage
+ */
+struct livestats_server {
+    long faults;                        //!< page faults served
+    long writebacks;                    //!< dirty pages written back
+    long bytes_read;                    //!< bytes read from the pagefile
+    long bytes_written;                 //!< bytes written to the pagefile
+    long selections[PAGEREP_NALGOS];    //!< victims selected by each page replacement algorithm
+    long scanned[PAGEREP_NALGOS];       //!< frames inspected by these selections
+    int resident_frames;                //!< gauge: frames storing a page
+    int dirty_frames;                   //!< gauge: frames storing a modified page
+} __attribute__((aligned(VMEM_CACHELINE)));
+
+/**
+ * Counters of a client, written by vmaccess
+ */
+struct livestats_client {
+    long ticks;                         //!< accesses, i.e. increments of g_count
+    long ipc_round_trips;               //!< requests sent to mmanage
+    long ipc_wait_ns;                   //!< time waiting for the ACK of synchronous requests
+} __attribute__((aligned(VMEM_CACHELINE)));
+
+/**
+ * Live statistics in shared memory
+ */
+struct livestats {
+    char magic[8];                      //!< LIVESTATS_MAGIC
+    int version;                        //!< LIVESTATS_VERSION
+    int pid;                            //!< process id of mmanage
+    int pagesize;                       //!< geometry of virtual memory
+    int nframes;
+    int nclients;
+    int algo;                           //!< page replacement algorithm of mmanage
+    struct livestats_server server;     //!< written by mmanage
+    struct livestats_client clients[VMEM_MAX_CLIENTS]; //!< indexed by ASID
+};
+
+/**
+ *****************************************************************************************
+ *  @brief      This function creates the shared memory object of the live statistics
+ *              for vmem_geometry. Called by mmanage.
+ *
+ *  @param      algo Page replacement algorithm
+ *
+ *  @return     live statistics, cleared
+ ****************************************************************************************/
+struct livestats *livestats_create(int algo);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function attaches the live statistics created by mmanage.
+ *
+ *  @param      writable false: read-only, e.g. by a monitor
+ *
+ *  @return     live statistics; NULL, if mmanage does not provide them
+ ****************************************************************************************/
+struct livestats *livestats_attach(bool writable);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function removes the shared memory object of the live statistics.
+ *              Mappings stay valid. Called by mmanage on start, to remove the object
+ *              of an old run, and on exit.
+ *
+ *  @return     void
+ ****************************************************************************************/
+void livestats_remove(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function adds a value to a counter of the live statistics.
+ *
+ *  @param      counter Counter
+ *  @param      val Value
+ *
+ *  @return     void
+ ****************************************************************************************/
+static inline void livestats_add(long *counter, long val) {
+    __atomic_fetch_add(counter, val, __ATOMIC_RELAXED);
+}
+
+#endif /* LIVESTATS_H */
@@ -9,15 +9,17 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <stdio.h>
+
 /** 
  * Event struct for logging 
  */
 struct logevent {
-    int req_pageno;    //!< requested page number
-    int replaced_page; //!< replaced page number
-    int alloc_frame;   //!< selected frame
-    int pf_count;      //!< current number of page faults
-    int g_count;       //!< gobal quasi time stamp
+    long req_pageno;    //!< requested page number
+    long replaced_page; //!< replaced page number
+    int alloc_frame;    //!< selected frame
+    long pf_count;      //!< current number of page faults
+    long g_count;       //!< gobal quasi time stamp
 };
 
 #define MMANAGE_LOGFNAME "./logfile.txt"  //!< logfile name 
@@ -48,4 +50,17 @@ void close_logger(void);
  ****************************************************************************************/
 void logger(struct logevent le);
 
+/**
+ *****************************************************************************************
+ *  @brief      This function writes a log entity in the format of the logfile to a 
+ *              stream, e.g. a logfile of the trace driven simulator.
+ *
+ *  @param      out Stream the entity is written to.
+ *
+ *  @param      le This stucture describes the entity that should be logged.
+ *
+ *  @return     void 
+ ****************************************************************************************/
+void logger_write(FILE *out, struct logevent le);
+
 #endif /* LOGGER_H */
@@ -19,9 +19,14 @@
 
 #include <signal.h>
 #include <string.h>
-#include <sys/ipc.h>
-#include <sys/shm.h>
+#include <sched.h>
 #include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "mmanage.h"
 #include "debug.h"
@@ -30,6 +35,11 @@
 #include "logger.h"
 #include "syncdataexchange.h"
 #include "vmem.h"
+#include "zswap.h"
+#include "pagerep.h"
+#include "livestats.h"
+
+struct shard;
 
 /*
  * Signatures of private / static functions
@@ -37,26 +47,32 @@
 
 /**
  *****************************************************************************************
- *  @brief      This function fetchs a page from disk into memory. The page table 
- *              will be updated.
+ *  @brief      This function fetchs a page from disk into memory. A page of a cloned
+ *              address space may be fetched from the backing copy of another address 
+ *              space, see backing_origin.
  *
- *  @param      page Number of the page that should be removed
+ *  @param      sh Shard serving the request
+ *  @param      asid Address space of the page
+ *  @param      page Number of the page that should be fetched
  *  @param      frame Number of frame that should contain the page.
  * 
  *  @return     void 
  ****************************************************************************************/
-
+static void fetch_page(struct shard *sh, int asid, long page, int frame);
 
 /**
  *****************************************************************************************
  *  @brief      This function removes a page from main memory. If the page was modified,
  *              it will be written back to disk. The page table will be updated.
  *
+ *  @param      sh Shard serving the request
+ *  @param      asid Address space of the page
  *  @param      page Number of the page that should be removed
+ *  @param      frame Number of frame that contains the page.
  * 
  *  @return     void 
  ****************************************************************************************/
-
+static void remove_page(struct shard *sh, int asid, long page, int frame);
 
 /**
  *****************************************************************************************
@@ -71,16 +87,19 @@ static void vmem_init(void);
 /**
  *****************************************************************************************
  *  @brief      This function finds an unused frame. At the beginning all frames are 
- *              unused. A frame will never change it's state form used to unused.
+ *              unused. A frame will never change it's state form used to unused, 
+ *              unless its page is moved into a huge frame or merged into a shared frame.
  *
  *              Since the log files to be compared with contain the allocated frames, unused 
  *              frames must always be assigned the same way. Here, the frames are assigned 
  *              according to ascending frame number.
  *            
+ *  @param      sh Shard serving the request
+ *
  *  @return     idx of the unused frame with the smallest idx. 
  *              If all frames are in use, VOID_IDX will be returned.
  ****************************************************************************************/
-static int find_unused_frame();
+static int find_unused_frame(struct shard *sh);
 
 /**
  *****************************************************************************************
@@ -89,6 +108,12 @@ static int find_unused_frame();
  *              replacement algorithm will be called.
  *              Please take into account that allocate_page must update the page table 
  *              and log the page fault as well.
+ *              With local frame allocation, a client that has used its quota of frames
+ *              replaces one of its own pages.
+ *
+ *  @param      sh Shard serving the request
+ *
+ *  @param      asid      Address space of the client that caused the page fault
  *
  *  @param      req_page  The page that must be allocated due to the page fault. 
 
@@ -96,7 +121,201 @@ static int find_unused_frame();
  *
  *  @return     void 
  ****************************************************************************************/
-static void allocate_page(const int req_page, const int g_count);
+static void allocate_page(struct shard *sh, const int asid, const long req_page, const long g_count);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function adds a pin to a page. At the first pin the page will be 
+ *              put into memory (if required) and marked by PTF_PINNED, unless the cap 
+ *              of pinned frames has been reached.
+ *
+ *  @param      sh Shard serving the request
+ *
+ *  @param      asid Address space of the page
+ *
+ *  @param      page Number of the page to be pinned
+ *
+ *  @param      g_count Current g_count value
+ *
+ *  @return     void 
+ ****************************************************************************************/
+static void pin_page(struct shard *sh, int asid, long page, long g_count);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function removes a pin of a page. PTF_PINNED will be cleared, when
+ *              the last pin has been removed.
+ *
+ *  @param      sh Shard serving the request
+ *
+ *  @param      asid Address space of the page
+ *
+ *  @param      page Number of the page to be unpinned
+ *
+ *  @return     void 
+ ****************************************************************************************/
+static void unpin_page(struct shard *sh, int asid, long page);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function checks, whether the page stored in a frame is pinned.
+ *
+ *  @param      frame Number of frame
+ *
+ *  @return     true, if the page is pinned
+ ****************************************************************************************/
+static bool frame_is_pinned(int frame);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function checks, whether the page stored in a frame may be replaced
+ *              by the current page fault: the frame must be used, the page must not be
+ *              pinned and, with local frame allocation, it must belong to the address 
+ *              space of the faulting client.
+ *
+ *  @param      sh Shard serving the request
+ *
+ *  @param      frame Number of frame
+ *
+ *  @return     true, if the page may be replaced
+ ****************************************************************************************/
+static bool frame_is_candidate(struct shard *sh, int frame);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the page stored in a frame.
+ *
+ *  @param      frame Number of frame
+ *
+ *  @return     page; VOID_IDX, if the frame is unused
+ ****************************************************************************************/
+static long find_page_by_frame(int frame);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function demotes a huge page to base pages. The pages stay in their
+ *              frames, so they may be replaced one by one.
+ *
+ *  @param      sh Shard serving the request
+ *
+ *  @param      first First frame of the huge frame
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void demote_huge(struct shard *sh, int first);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function counts page faults of a client on consecutive pages. If
+ *              half of a run of a huge page has been faulted in sequence, the run will
+ *              be promoted to a huge page.
+ *
+ *  @param      sh Shard serving the request
+ *
+ *  @param      asid Address space of the client that caused the page fault
+ *
+ *  @param      page Page of the page fault
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void promote_sequential(struct shard *sh, int asid, long page);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function promotes the runs of base pages to huge pages, whose pages
+ *              are all present and referenced.
+ *
+ *  @param      sh Shard serving the request
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void promote_hot(struct shard *sh);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function scans the frames for identical contents. The pages of 
+ *              frames, that have not changed since the last scan and are equal to the
+ *              contents of another frame, are merged into one shared frame. The frames
+ *              of the merged pages become unused.
+ *
+ *  @param      sh Shard serving the request
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void ksm_scan(struct shard *sh);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function copies a page stored in a shared frame into a frame of its
+ *              own (copy on write). It will be called before vmaccess stores into the
+ *              page and before the page will be pinned.
+ *
+ *  @param      sh Shard serving the request
+ *
+ *  @param      asid Address space of the page
+ *
+ *  @param      page Number of the page
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void break_cow(struct shard *sh, int asid, long page);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function removes all pages but the first one from a shared frame, 
+ *              which has been selected for replacement. Each page will be written back,
+ *              if its backing copy is not up to date.
+ *
+ *  @param      sh Shard serving the request
+ *
+ *  @param      frame Shared frame
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void ksm_remove_sharers(struct shard *sh, int frame);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function clones the address space of a client into a free one, 
+ *              see vmem_fork. Resident pages share their frame with the clone like 
+ *              merged pages, pages of the backing store are shared by reference to the
+ *              backing copy. Pinned pages are copied into the backing store of the clone.
+ *
+ *  @param      sh Shard serving the request
+ *
+ *  @param      parent Address space to be cloned
+ *
+ *  @param      child Free address space claimed by the client
+ *
+ *  @param      g_count g_count of the client
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void fork_address_space(struct shard *sh, int parent, int child, long g_count);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function writes a checkpoint of the simulation into the file set 
+ *              via -checkpoint, see vmem_checkpoint. The checkpoint holds the page
+ *              tables and frames of shared memory, the state of memory management
+ *              and of the page replacement algorithms, the g_count of each client and
+ *              the pages written to the pagefile.
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void write_checkpoint(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function restores the checkpoint set via -restore. The checkpoint
+ *              is mapped into memory and copied into shared memory, the data of memory
+ *              management and the new pagefile. All address spaces become free, so the
+ *              next clients continue with the restored pages and g_counts. Statistics
+ *              start from zero, but pf_count and the numbering of the logfile continue.
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void restore_checkpoint(void);
 
 /**
  *****************************************************************************************
@@ -121,60 +340,53 @@ static void dump_pt(void);
 
 /**
  *****************************************************************************************
- *  @brief      This function implements page replacement algorithm aging.
- *
- *  @param      page Number of page that should be loaded into memory.
+ *  @brief      These functions provide the state of the frames of a shard to the page
+ *              replacement algorithm, see struct pagerep_ops. Clearing the Ref bit 
+ *              shoots down the Ref bits cached by the TLBs of vmaccess.
  *
- *  @param      removedPage Number of page that has been selected for replacement.
- *              If an unused frame has selected, this parameter will not be 
- *              modified.
+ *  @param      pr Page replacement of shard
  *
- *  @param      frame Number of frame that will be used to store the page.
+ *  @param      frame Number of frame
  *
+ *  @return     see struct pagerep_ops
  ****************************************************************************************/
-static void find_remove_aging(int page, int * removedPage, int *frame);
- 
+static bool rep_is_candidate(const struct pagerep *pr, int frame);
+static bool rep_holds_page(const struct pagerep *pr, int frame);
+static bool rep_test_clear_ref(const struct pagerep *pr, int frame);
+
 /**
  *****************************************************************************************
- *  @brief      This function does aging for aging page replacement algorithm.
- *              It will be called periodic based on g_count.
- *              This function must be used only when aging algorithm is activ.
- *              Otherwise update_age_reset_ref may interfere with other page replacement 
- *              alogrithms that base on PTF_REF bit.
+ *  @brief      This function serves a request of vmapp.
  *
- *  @return     void
+ *  @param      sh Shard serving the request
+ *
+ *  @param      m Request
+ *
+ *  @return     void 
  ****************************************************************************************/
-static void update_age_reset_ref(void);
+static void serve_request(struct shard *sh, struct msg m);
 
 /**
  *****************************************************************************************
- *  @brief      This function implements page replacement algorithm fifo.
- *
- *  @param      page Number of page that should be loaded into memory.
+ *  @brief      This function passes a request to the worker threads of the shards in
+ *              sharded mode. A page fault, pin or unpin request is passed to the 
+ *              shard of its page, the end of a time interval to all shards. The last 
+ *              shard that has served the request acknowledges it.
  *
- *  @param      removedPage Number of page that has been selected for replacement.
- *              If an unused frame has selected, this parameter will not be 
- *              modified.
- *
- *  @param      frame Number of frame that will be used to store the page.
+ *  @param      m Request
  *
+ *  @return     void 
  ****************************************************************************************/
-static void find_remove_fifo(int page, int * removedPage, int *frame);
+static void dispatch_request(struct msg m);
 
 /**
  *****************************************************************************************
- *  @brief      This function implements page replacement algorithm clock.
- *
- *  @param      page Number of page that should be loaded into memory.
- *
- *  @param      removedPage Number of page that has been selected for replacement.
- *              If an unused frame has selected, this parameter will not be 
- *              modified.
- *
- *  @param      frame Number of frame that will be used to store the page.
+ *  @brief      This function divides the frames among the shards and, in sharded mode,
+ *              starts the worker threads.
  *
+ *  @return     void 
  ****************************************************************************************/
-static void find_remove_clock(int page, int * removedPage, int *frame);
+static void init_shards(void);
 
 /**
  *****************************************************************************************
@@ -184,6 +396,14 @@ static void find_remove_clock(int page, int * removedPage, int *frame);
  ****************************************************************************************/
 static void cleanup(void) ;
 
+/**
+ *****************************************************************************************
+ *  @brief      This function prints the statistics of the current run to stdout.
+ *
+ *  @return     void 
+ ****************************************************************************************/
+static void print_statistics(void);
+
 /**
  *****************************************************************************************
  *  @brief      This function scans all parameters of the porgram.
@@ -209,43 +429,280 @@ static void scan_params(int argc, char **argv);
  ****************************************************************************************/
 static void print_usage_info_and_exit(char *err_str, char * programName);
 
+/**
+ *****************************************************************************************
+ *  @brief      This function creates the live statistics and starts the thread
+ *              sampling their gauges. The thread blocks the signals, they are handled
+ *              by the main thread.
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void init_livestats(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function is the main function of the thread sampling the gauges
+ *              of the live statistics every LIVESTATS_SAMPLE_MS ms: the frames storing
+ *              a page and the frames storing a modified page. The frames are read 
+ *              without locking, the gauges are approximate.
+ *
+ *  @param      arg not used
+ *
+ *  @return     NULL
+ ****************************************************************************************/
+static void *sample_livestats(void *arg);
+
 void init_linked_list();
 
 /*
  * variables for memory management
  */
 
-static int pf_count = 0;               //!< page fault counter
-static int shm_id = -1;                //!< shared memory id. Will be used to destroy shared memory when mmanage terminates
+static long pf_count = 0;              //!< page fault counter
+static int shm_backing = VMEM_SHM_SYSV; //!< backing of shared memory set via -shm
+static long last_g_count = 0;          //!< sum of the g_counts of the last messages received from the clients
+static size_t zswap_budget = 0;        //!< memory budget of compressed swap pool; 0: pool disabled
+static bool subpage_writeback = false; //!< write back dirty sectors instead of whole pages
+static bool use_checksum = false;      //!< drop dirty pages whose contents equal the contents at fetch time
+static uint64_t *page_checksum = NULL; //!< checksum of the page of each frame taken at fetch time
+static int nthreads = 0;               //!< number of request slots used by vmapp
+static int *pin_count = NULL;          //!< number of pins of the page of each frame
+static int max_pinned = VOID_IDX;     //!< cap of pinned frames; at least one frame stays replaceable. VOID_IDX: half of the frames
+static int in_service = 0;             //!< requests taken from the request channel and not acknowledged yet
+
+/* cost model; the costs of the storage device are modeled by the pagefile module */
+static double mem_ns = 100.0;          //!< modeled latency of a memory access hitting main memory
+static double fault_ns = 2000.0;       //!< modeled trap overhead of a page fault
+
+/* geometry of virtual memory */
+static int pagesize = VMEM_DEFAULT_PAGESIZE;        //!< page size set via -pagesize
+static long virtmemsize = VMEM_DEFAULT_VIRTMEMSIZE; //!< size of virtual memory set via -virtmem
+static int physmemsize = VMEM_DEFAULT_PHYSMEMSIZE; //!< size of physical memory set via -physmem
+static int nclients = 1;                            //!< number of address spaces set via -clients
+static int hugepages = 0;                           //!< base pages per huge page set via -hugepages
+
+#if VMEM_MAX_CLIENTS > SYNC_NCLIENTS
+#error "syncdataexchange supports less clients than VMEM_MAX_CLIENTS"
+#endif
+
+/**
+ * Data of memory management per client (address space) and shard
+ */
+struct client_stats {
+    long pf_count;          //!< page faults of client
+    int rss;                //!< resident set size: frames storing pages of client
+    int pinned;             //!< frames storing pinned pages of client
+    double fault_time_ns;   //!< modeled time of page faults of client
+    double fault_time_max_ns; //!< modeled time of the most expensive page fault of client
+    long seq_page;          //!< page of the last page fault of client
+    int seq_faults;         //!< number of page faults on consecutive pages of one run of a huge page
+};
+
+static long client_g_count[VMEM_MAX_CLIENTS]; //!< g_count of last message of each client
+static int client_rss[VMEM_MAX_CLIENTS];      //!< resident set size of each client over all shards
+static int client_rss_max[VMEM_MAX_CLIENTS];  //!< maximal resident set size of each client
+static bool local_alloc = false;       //!< local frame allocation: a client replaces its own pages only
+
+#define SHARD_QUEUE_LEN (SYNC_NCLIENTS * SYNC_NSLOTS) //!< Length of request queue of a shard
 
-static void (*pageRepAlgo) (int, int*, int*) = NULL; //!< selected page replacement algorithm according to parameters of mmanage
+/**
+ * A shard of memory management. It owns a contiguous range of frames and serves 
+ * the pages mapped to it by shard_of with its own instance of the replacement
+ * algorithm. In sharded mode (-shards) each shard has a worker thread that serves
+ * the requests of its queue, otherwise the main loop serves all requests by shard 0 
+ * owning all frames.
+ */
+struct shard {
+    int id;                     //!< number of shard
+    int first_frame;            //!< first frame of shard
+    int nframes;                //!< number of frames of shard
+    struct pagerep rep;         //!< page replacement of the frames of shard
+    int victim_asid;            //!< address space whose pages may be replaced; VOID_IDX: all
+    int frame_quota;            //!< local frame allocation: frames per client
+    int max_pinned;             //!< cap of pinned frames of shard
+    int pinned_frames;          //!< number of frames storing pinned pages
+    long pf_count;              //!< page faults served
+    long duplicate_faults;      //!< page faults of pages that have been present already (concurrent requests)
+    long writeback_count;       //!< number of dirty pages removed from main memory
+    long dirty_bytes;           //!< bytes of dirty sectors of all removed pages
+    long restored_pages;        //!< dirty pages dropped, because they have been restored
+    long refused_pins;          //!< pins refused because of the cap
+    long pending_sum;           //!< sum of outstanding requests seen on page faults
+    int pending_max;            //!< maximal number of outstanding requests seen on a page fault
+    double io_time_ns;          //!< modeled time of I/O of shard
+    double fault_time_ns;       //!< modeled time of all page faults (trap overhead and I/O)
+    double fault_time_max_ns;   //!< modeled time of the most expensive page fault
+    double exposed_time_ns;     //!< modeled time of all page faults not hidden by other outstanding requests
+    long intervals;             //!< time intervals served
+    int huge_frames;            //!< number of huge frames
+    long promotions_seq;        //!< runs promoted to a huge page after sequential page faults
+    long promotions_hot;        //!< runs promoted to a huge page, because all pages have been present and referenced
+    long demotions;             //!< huge pages demoted to base pages under memory pressure
+    long fill_pages;            //!< pages fetched by a promotion without page fault
+    long bloat_pages;           //!< pages fetched by a promotion and not referenced until demotion
+    long ksm_scans;             //!< scans for identical frames
+    long ksm_merges;            //!< pages merged into a shared frame
+    long cow_breaks;            //!< pages copied out of a shared frame
+    long forks;                 //!< address spaces cloned
+    long fork_shared;           //!< frames shared by a clone
+    long fork_copies;           //!< pinned pages copied into the backing store of a clone
+    long backing_copies;        //!< backing copies shared by clones copied before they have been overwritten
+    int frames_saved;           //!< pages mapping a shared frame besides its first page
+    int frames_saved_max;       //!< maximal number of frames saved
+    struct client_stats clients[VMEM_MAX_CLIENTS]; //!< clients indexed by ASID
+    unsigned char *scratch;     //!< page buffer of shard; a page may be too large for the stack
+
+    /* request queue of worker thread; a slot has at most one outstanding request */
+    pthread_t thread;           //!< worker thread
+    pthread_mutex_t mutex;      //!< protects queue
+    pthread_cond_t cond;        //!< signaled, when a request has been queued
+    struct msg queue[SHARD_QUEUE_LEN]; //!< ring buffer of requests
+    int head;                   //!< first request of queue
+    int count;                  //!< number of requests in queue
+    int count_max;              //!< maximal length of queue
+    long requests;              //!< number of requests served
+};
+
+#define MAX_SHARDS 64          //!< Maximal number of shards
+
+static struct shard shards[MAX_SHARDS]; //!< shards of memory management
+static int nshards = 1;                //!< number of shards
+static bool sharded = false;           //!< shards are served by worker threads
+static int ack_pending[SYNC_NCLIENTS * SYNC_NSLOTS]; //!< sharded mode: shards that must serve the request of a slot before the ACK
+static pthread_mutex_t backing_mutex = PTHREAD_MUTEX_INITIALIZER; //!< serializes zswap and pagefile, see backing_lock
+static pthread_mutex_t logger_mutex = PTHREAD_MUTEX_INITIALIZER;  //!< serializes logging of page faults
+
+static int rep_algo = PAGEREP_FIFO; //!< selected page replacement algorithm according to parameters of mmanage
+static bool use_livestats = false;     //!< live statistics set via -stats
+static struct livestats *livestats = NULL;     //!< live statistics; NULL: disabled
+static struct livestats_server *live = NULL;   //!< counters of mmanage in the live statistics; NULL: disabled
+static const struct pagerep_ops rep_ops = { rep_is_candidate, rep_holds_page, rep_test_clear_ref }; //!< state of the frames of a shard
 
 /* information used for ageing replacement strategy. For each frame, which stores a valid page, 
  * the age and and the corresponding page will be stored.
  */
 
 struct age {
-   unsigned char age;  //!< 8 bit counter for aging page replacement algorithm
-   int page;           //!< page belonging to this entry
+   long page;          //!< page belonging to this entry
+   int asid;           //!< address space of page
+   int origin;         //!< address space whose backing copy holds the page, while the frame is clean
  };
 
 
-struct age age[VMEM_NFRAMES];
+struct age *age = NULL;
+static unsigned char *age_counter = NULL; //!< per frame: 8 bit counter for aging page replacement algorithm
+
+static bool *is_used = NULL;
+
+/* huge pages, see promote_huge */
+#define HUGE_HOT_INTERVAL 16           //!< time intervals between two scans for hot runs
+static int *huge_frame = NULL;         //!< per frame: first frame of the huge frame storing the page; VOID_IDX: base page
+static bool *fill_page = NULL;         //!< per frame: page has been fetched by a promotion and not been referenced since
+
+/**
+ * Further page mapping a frame shared by merged pages, see ksm_scan. The first page
+ * of a shared frame is kept by age like the page of any other frame.
+ */
+struct sharer {
+    int asid;              //!< address space of page
+    long page;             //!< number of page
+    int origin;            //!< address space whose backing copy holds the page, while the frame is clean
+    struct sharer *next;   //!< next page mapping the frame
+};
+
+/**
+ * Frame taken by a scan of same-page merging
+ */
+struct ksm_item {
+    uint64_t hash;         //!< checksum of the contents of the frame
+    int frame;             //!< number of frame
+};
+
+static int ksm_interval = 0;              //!< time intervals between two scans for identical frames set via -ksm; 0: no merging
+static struct sharer **sharers = NULL;    //!< per frame: further pages mapping the frame
+static uint64_t *ksm_hash = NULL;         //!< per frame: checksum of the contents at the last scan
+static struct ksm_item *ksm_items = NULL; //!< frames taken by the current scan
+
+/**
+ * Clones, see fork_address_space. A page of a clone is stored in the backing copy of
+ * the address space it has been cloned from, until the clone writes the page back.
+ * The address space is kept in the frame of a page table entry without PTF_PRESENT; 
+ * entries without frame and pages without entry refer to clone_root.
+ */
+static int clone_root[VMEM_MAX_CLIENTS]; //!< address space whose backing copies hold the unmodified pages of an address space
+static bool forked = false;              //!< an address space has been cloned, so backing copies may be shared
 
-static bool is_used[VMEM_NFRAMES] = {false};
+/**
+ * Checkpoints, see write_checkpoint. The file starts with the header, followed by the
+ * state of each shard, the per frame data of memory management (age, age_counter, is_used, 
+ * page_checksum, pin_count, huge_frame, fill_page), the sharers of the frames, shared 
+ * memory preceding the node pools, the nodes taken from the pools and the pages of 
+ * the pagefile, see checkpoint_pagefile.
+ */
+#define CHECKPOINT_MAGIC   "VMEMCKPT"   //!< first bytes of a checkpoint
+#define CHECKPOINT_VERSION 2            //!< incremented, when the layout changes
+
+struct checkpoint_header {
+    char magic[8];                            //!< CHECKPOINT_MAGIC
+    int version;                              //!< CHECKPOINT_VERSION
+    int pagesize;                             //!< geometry of virtual memory
+    long virtmemsize;
+    int physmemsize;
+    int nclients;
+    int hugepages;
+    int nshards;                              //!< number of shards
+    int nsharers;                             //!< number of sharer records
+    int forked;                               //!< an address space has been cloned
+    long pf_count;                            //!< page fault counter
+    long last_g_count;                        //!< sum of the g_counts of the clients
+    long client_g_count[VMEM_MAX_CLIENTS];    //!< g_count of each client
+    int client_rss[VMEM_MAX_CLIENTS];         //!< resident set size of each client
+    int clone_root[VMEM_MAX_CLIENTS];         //!< see clone_root
+};
 
-static int frame_counter = 0;
+/**
+ * State of a shard in a checkpoint
+ */
+struct checkpoint_shard {
+    int frame_counter;                        //!< hand of fifo and clock
+    int pinned_frames;                        //!< number of frames storing pinned pages
+    int huge_frames;                          //!< number of huge frames
+    int frames_saved;                         //!< pages mapping a shared frame besides its first page
+    int rss[VMEM_MAX_CLIENTS];                //!< frames storing pages of each client
+    int pinned[VMEM_MAX_CLIENTS];             //!< frames storing pinned pages of each client
+};
 
+/**
+ * Page mapping a shared frame in a checkpoint, see struct sharer
+ */
+struct checkpoint_sharer {
+    int frame;                                //!< shared frame
+    int asid;                                 //!< address space of page
+    long page;                                //!< number of page
+    int origin;                               //!< address space of the backing copy
+};
+
+static const char *checkpoint_name = NULL;   //!< file of checkpoints set via -checkpoint; NULL: requests are ignored
+static const char *restore_name = NULL;      //!< checkpoint restored at start set via -restore
+static int checkpoints = 0;                  //!< number of checkpoints written
+static long checkpoint_bytes = 0;            //!< size of the last checkpoint
+static long restored_bytes = 0;              //!< size of the restored checkpoint
+
+static struct vmem_struct vmem_view;     //!< View of shared memory
 static struct vmem_struct *vmem = NULL; //!< Reference to shared memory
 
 int main(int argc, char **argv) {
 
     struct sigaction sigact;
+
+    // scan parameter 
+    scan_params(argc, argv);
+
     init_pagefile(); // init page file
     open_logger();   // open logfile
 
     // Setup IPC for sending commands from vmapp to mmanager
-    setupSyncDataExchange();
+    setupSyncDataExchange(VMEM_NCLIENTS);
 
     // Create shared memory and init vmem structure 
     vmem_init();
@@ -255,12 +712,25 @@ int main(int argc, char **argv) {
     // init aging info
     for(int i = 0; i < VMEM_NFRAMES; i++) {
        age[i].page = VOID_IDX;
-       age[i].age = 0;
+       age[i].asid = VOID_IDX;
+       age[i].origin = VOID_IDX;
+       age_counter[i] = 0;
+       huge_frame[i] = VOID_IDX;
     }
 
-    // scan parameter 
-    pageRepAlgo = find_remove_fifo;
-    scan_params(argc, argv);
+    if (zswap_budget > 0) {
+        zswap_init(zswap_budget);
+    }
+
+    // worker threads are started before the signal handlers are installed, they block the signals
+    init_shards();
+    livestats_remove(); // live statistics of an old run
+    if (use_livestats) {
+        init_livestats();
+    }
+    if (restore_name != NULL) {
+        restore_checkpoint();
+    }
 
     /* Setup signal handler */
     sigact.sa_handler = sighandler;
@@ -275,21 +745,20 @@ int main(int argc, char **argv) {
 
     // Server Loop, waiting for commands from vmapp
     while(1) {
-		struct msg m = waitForMsg();
-        //printf("\n\n\n\n\naaaaaaaaa\nm.cmd: %d\n", m.cmd);
-        switch(m.cmd){
-			case CMD_PAGEFAULT:
-				allocate_page(m.value, m.g_count);
-				break;
-			case CMD_TIME_INTER_VAL:
-                if (pageRepAlgo == find_remove_aging) {
-                   update_age_reset_ref();
-                }
-				break;
-			default:
-				TEST_AND_EXIT(true, (stderr, "Unexpected command received from vmapp\n"));
-        }
-        sendAck();
+		struct msg m = sharded ? takeMsg() : waitForMsg();
+        last_g_count += m.g_count - client_g_count[m.client];
+        client_g_count[m.client] = m.g_count;
+        if (m.slot >= nthreads) {
+            nthreads = m.slot + 1;
+        }
+        if (sharded) {
+            dispatch_request(m);
+        } else {
+            in_service = 1;
+            serve_request(&shards[0], m);
+            in_service = 0;
+            sendAck();
+        }
     }
     return 0;
 }
@@ -298,29 +767,158 @@ void scan_params(int argc, char **argv) {
     int i = 0;
     bool param_ok = false;
     char * programName = argv[0];
+    const char *zswap_str = "-zswap=";
+    const char *storage_str = "-storage=";
+    const char *memns_str = "-memns=";
+    const char *faultns_str = "-faultns=";
+    const char *maxpinned_str = "-maxpinned=";
+    const char *pagesize_str = "-pagesize=";
+    const char *virtmem_str = "-virtmem=";
+    const char *physmem_str = "-physmem=";
+    const char *clients_str = "-clients=";
+    const char *alloc_str = "-alloc=";
+    const char *shards_str = "-shards=";
+    const char *hugepages_str = "-hugepages=";
+    const char *shm_str = "-shm=";
+    const char *ksm_str = "-ksm=";
+    const char *checkpoint_str = "-checkpoint=";
+    const char *restore_str = "-restore=";
 
     // scan all parameters (argv[0] points to program name)
-    if (argc > 2) print_usage_info_and_exit("Wrong number of parameters.\n", programName);
-
     for (i = 1; i < argc; i++) {
         param_ok = false;
         if (0 == strcasecmp("-fifo", argv[i])) {
             // page replacement strategies fifo selected 
-            pageRepAlgo = find_remove_fifo;
+            rep_algo = PAGEREP_FIFO;
             param_ok = true;
         }
         if (0 == strcasecmp("-clock", argv[i])) {
             // page replacement strategies clock selected 
-            pageRepAlgo = find_remove_clock;
+            rep_algo = PAGEREP_CLOCK;
             param_ok = true;
         }
         if (0 == strcasecmp("-aging", argv[i])) {
             // page replacement strategies aging selected 
-            pageRepAlgo = find_remove_aging;
+            rep_algo = PAGEREP_AGING;
+            param_ok = true;
+        }
+        if (0 == strncasecmp(storage_str, argv[i], strlen(storage_str))) {
+            // storage device of cost model
+            param_ok = set_pagefile_storage(argv[i] + strlen(storage_str));
+        }
+        if (0 == strncasecmp(memns_str, argv[i], strlen(memns_str))) {
+            // memory latency of cost model
+            param_ok = (1 == sscanf(argv[i] + strlen(memns_str), "%lf", &mem_ns)) && (mem_ns >= 0.0);
+        }
+        if (0 == strncasecmp(faultns_str, argv[i], strlen(faultns_str))) {
+            // trap overhead of cost model
+            param_ok = (1 == sscanf(argv[i] + strlen(faultns_str), "%lf", &fault_ns)) && (fault_ns >= 0.0);
+        }
+        if (0 == strncasecmp(maxpinned_str, argv[i], strlen(maxpinned_str))) {
+            // cap of pinned frames
+            param_ok = (1 == sscanf(argv[i] + strlen(maxpinned_str), "%d", &max_pinned)) && (max_pinned >= 0);
+        }
+        if (0 == strncasecmp(pagesize_str, argv[i], strlen(pagesize_str))) {
+            // page size, checked by vmem_set_geometry
+            param_ok = (1 == sscanf(argv[i] + strlen(pagesize_str), "%d", &pagesize));
+        }
+        if (0 == strncasecmp(virtmem_str, argv[i], strlen(virtmem_str))) {
+            // size of virtual memory
+            param_ok = vmem_parse_size(argv[i] + strlen(virtmem_str), &virtmemsize);
+        }
+        if (0 == strncasecmp(physmem_str, argv[i], strlen(physmem_str))) {
+            // size of physical memory
+            long size = 0;
+            param_ok = vmem_parse_size(argv[i] + strlen(physmem_str), &size) && (size <= INT_MAX);
+            physmemsize = size;
+        }
+        if (0 == strncasecmp(clients_str, argv[i], strlen(clients_str))) {
+            // number of address spaces, checked by vmem_set_geometry
+            param_ok = (1 == sscanf(argv[i] + strlen(clients_str), "%d", &nclients));
+        }
+        if (0 == strncasecmp(alloc_str, argv[i], strlen(alloc_str))) {
+            // frame allocation among the clients
+            local_alloc = (0 == strcasecmp(argv[i] + strlen(alloc_str), "local"));
+            param_ok = local_alloc || (0 == strcasecmp(argv[i] + strlen(alloc_str), "global"));
+        }
+        if (0 == strncasecmp(shards_str, argv[i], strlen(shards_str))) {
+            // number of shards served by worker threads
+            param_ok = (1 == sscanf(argv[i] + strlen(shards_str), "%d", &nshards)) && (nshards > 0) && (nshards <= MAX_SHARDS);
+            sharded = true;
+        }
+        if (0 == strncasecmp(hugepages_str, argv[i], strlen(hugepages_str))) {
+            // base pages per huge page, checked by vmem_set_geometry
+            param_ok = (1 == sscanf(argv[i] + strlen(hugepages_str), "%d", &hugepages));
+        }
+        if (0 == strncasecmp(checkpoint_str, argv[i], strlen(checkpoint_str))) {
+            // file of checkpoints requested by vmappl
+            checkpoint_name = argv[i] + strlen(checkpoint_str);
+            param_ok = (*checkpoint_name != '\0');
+        }
+        if (0 == strncasecmp(restore_str, argv[i], strlen(restore_str))) {
+            // checkpoint restored at start
+            restore_name = argv[i] + strlen(restore_str);
+            param_ok = (*restore_name != '\0');
+        }
+        if (0 == strncasecmp(ksm_str, argv[i], strlen(ksm_str))) {
+            // time intervals between two scans of same-page merging
+            param_ok = (1 == sscanf(argv[i] + strlen(ksm_str), "%d", &ksm_interval)) && (ksm_interval > 0);
+        }
+        if (0 == strncasecmp(shm_str, argv[i], strlen(shm_str))) {
+            // backing of shared memory
+            shm_backing = vmem_shm_backing(argv[i] + strlen(shm_str));
+            param_ok = (shm_backing != VOID_IDX);
+        }
+        if (0 == strcasecmp("-stats", argv[i])) {
+            // live statistics for monitors
+            use_livestats = true;
+            param_ok = true;
+        }
+        if (0 == strcasecmp("-checksum", argv[i])) {
+            // compare checksums of dirty pages on removal
+            use_checksum = true;
+            param_ok = true;
+        }
+        if (0 == strcasecmp("-subpage", argv[i])) {
+            // write back dirty sectors only
+            subpage_writeback = true;
             param_ok = true;
         }
+        if (0 == strncasecmp(zswap_str, argv[i], strlen(zswap_str))) {
+            // compressed swap pool with given budget in bytes
+            if ((1 == sscanf(argv[i] + strlen(zswap_str), "%zu", &zswap_budget)) && (zswap_budget > 0)) {
+                param_ok = true;
+            }
+        }
         if (!param_ok) print_usage_info_and_exit("Undefined parameter.\n", programName); // undefined parameter found
     } // for loop
+
+    if (!vmem_set_geometry(pagesize, virtmemsize, physmemsize, nclients, hugepages)) {
+        print_usage_info_and_exit("Invalid geometry of virtual memory.\n", programName);
+    }
+    if (VMEM_NFRAMES / nshards < 1) {
+        print_usage_info_and_exit("Each shard requires a frame.\n", programName);
+    }
+    if (sharded && (VMEM_HUGEPAGES > 0)) {
+        // the pages of a run are spread over the shards
+        print_usage_info_and_exit("Huge pages require a single shard.\n", programName);
+    }
+    if ((ksm_interval > 0) && (sharded || (VMEM_HUGEPAGES > 0) || local_alloc)) {
+        // a shared frame is mapped by pages of all shards and clients
+        print_usage_info_and_exit("Same-page merging requires a single shard, global frame allocation and no huge pages.\n", programName);
+    }
+    if (((checkpoint_name != NULL) || (restore_name != NULL)) && (sharded || (zswap_budget > 0))) {
+        // the state of worker threads and of the compressed pool is not saved
+        print_usage_info_and_exit("Checkpoints require a single shard and no zswap pool.\n", programName);
+    }
+    if (local_alloc && (VMEM_NFRAMES / nshards / VMEM_NCLIENTS < 1)) {
+        print_usage_info_and_exit("Local frame allocation requires a frame per client and shard.\n", programName);
+    }
+    if (max_pinned == VOID_IDX) {
+        max_pinned = VMEM_NFRAMES / 2;
+    } else if (max_pinned >= VMEM_NFRAMES) {
+        print_usage_info_and_exit("Cap of pinned frames must be less than the number of frames.\n", programName);
+    }
 }
 
 void print_usage_info_and_exit(char *err_str, char *programName) {
@@ -329,7 +927,27 @@ void print_usage_info_and_exit(char *err_str, char *programName) {
 	fprintf(stderr, " -fifo     : Fifo page replacement algorithm.\n");
 	fprintf(stderr, " -clock    : Clock page replacement algorithm.\n");
 	fprintf(stderr, " -aging    : Aging page replacement algorithm.\n");
-	fprintf(stderr, " -pagesize=[8,16,32,64] : Page size.\n");
+	fprintf(stderr, " -pagesize=<bytes> : Page size, a power of two (default %d).\n", VMEM_DEFAULT_PAGESIZE);
+	fprintf(stderr, " -virtmem=<bytes>  : Size of virtual memory, a multiple of the page size, suffix K, M or G (default %ld).\n", VMEM_DEFAULT_VIRTMEMSIZE);
+	fprintf(stderr, " -physmem=<bytes>  : Size of physical memory, a multiple of the page size, suffix K, M or G (default %d).\n", VMEM_DEFAULT_PHYSMEMSIZE);
+	fprintf(stderr, " -clients=<n> : Number of vmappl processes with own address space, at most %d (default 1).\n", VMEM_MAX_CLIENTS);
+	fprintf(stderr, "                A clone made by vmem_fork takes one of them.\n");
+	fprintf(stderr, " -alloc=[global,local] : Replace pages of all clients or of the faulting client only (default global).\n");
+	fprintf(stderr, " -shards=<n> : Serve page faults by n worker threads, each owning a part of the frames, at most %d.\n", MAX_SHARDS);
+	fprintf(stderr, " -hugepages=<n> : Promote runs of n base pages to huge pages, a power of two of at most %d.\n", VMEM_MAX_HUGEPAGES);
+	fprintf(stderr, " -ksm=<n> : Merge frames of identical contents every n time intervals, a store copies the page.\n");
+	fprintf(stderr, " -shm=[sysv,posix,memfd,hugetlb] : Backing of shared memory (default sysv).\n");
+	fprintf(stderr, " -checkpoint=<file> : Write a checkpoint of the simulation to file, when vmappl requests it.\n");
+	fprintf(stderr, " -restore=<file> : Start with a checkpoint written with the same geometry.\n");
+	fprintf(stderr, " -zswap=<bytes> : Compressed swap pool in front of the pagefile with given budget.\n");
+	fprintf(stderr, " -subpage  : Write back modified sectors of a page only.\n");
+	fprintf(stderr, " -checksum : Drop dirty pages that have been restored to their fetched contents.\n");
+	fprintf(stderr, "             Equal checksums are confirmed by reading the backing copy.\n");
+	fprintf(stderr, " -stats    : Provide live statistics in shared memory %s, see vmmon.\n", LIVESTATS_NAME);
+	fprintf(stderr, " -maxpinned=<frames> : Cap of frames storing pinned pages (default half of the frames).\n");
+	fprintf(stderr, " -storage=[hdd,ssd,nvme] : Storage device of the cost model (default ssd).\n");
+	fprintf(stderr, " -memns=<ns>   : Memory access latency of the cost model (default 100).\n");
+	fprintf(stderr, " -faultns=<ns> : Page fault trap overhead of the cost model (default 2000).\n");
 	fflush(stderr);
 	exit(EXIT_FAILURE);
 }
@@ -351,24 +969,37 @@ void dump_pt(void) {
             "\n======================================\n"
             "\tPage Table Dump\n");
 
-    fprintf(stderr, "VIRT MEM SIZE    = \t %d\n", VMEM_VIRTMEMSIZE);
+    fprintf(stderr, "VIRT MEM SIZE    = \t %ld\n", VMEM_VIRTMEMSIZE);
     fprintf(stderr, "PHYS MEM SIZE    = \t %d\n", VMEM_PHYSMEMSIZE);
-    fprintf(stderr, "PAGESIZE         = \t %d\n", VMEM_PAGESIZE);
-    fprintf(stderr, "Number of Pages  = \t %d\n", VMEM_NPAGES);
+    fprintf(stderr, "PAGESIZE         = \t %d\n", VMEM_GEO_PAGESIZE);
+    fprintf(stderr, "Number of Pages  = \t %ld\n", VMEM_NPAGES);
     fprintf(stderr, "Number of Frames = \t %d\n", VMEM_NFRAMES);
 
     fprintf(stderr, "======================================\n");
-    fprintf(stderr, "shm_id: \t %x\n", shm_id);
-    fprintf(stderr, "pf_count: \t %d\n", pf_count);
-    for(i = 0; i < VMEM_NPAGES; i++) {
-        fprintf(stderr,
-			"Page %5d, Flags %x, Frame %10d, age 0x%2X,  \n", i,
-            vmem->pt[i].flags, vmem->pt[i].frame, age[vmem->pt[i].frame].age);
+    fprintf(stderr, "shm_id: \t %x\n", vmem_shm_id());
+    fprintf(stderr, "pf_count: \t %ld\n", pf_count);
+    // pages without leaf node of page table have never been present
+    for (int asid = 0; asid < VMEM_NCLIENTS; asid++) {
+        if (VMEM_NCLIENTS > 1) {
+            fprintf(stderr, "ASID %d:\n", asid);
+        }
+        for (long page = 0; page < VMEM_NPAGES; page++) {
+            struct pt_entry *pte = vmem_pte(vmem, asid, page);
+            if (pte == NULL) {
+                page |= PT_NODE_ENTRIES - 1; // skip range of leaf node
+                continue;
+            }
+            int frame = (pte_flags(pte) & PTF_PRESENT) ? pte_frame(pte) : VOID_IDX;
+            fprintf(stderr,
+                "Page %5ld, Flags %x, Frame %10d, age 0x%2X,  \n", page,
+                pte_flags(pte) | ((frame != VOID_IDX) ? vmem->access_bits[frame] : 0), frame, 
+                (frame != VOID_IDX) ? age_counter[frame] : 0);
+        }
     }
     fprintf(stderr,
             "\n\n======================================\n"
             "\tData Dump\n");
-    for(i = 0; i < (VMEM_NFRAMES * VMEM_PAGESIZE); i++) {
+    for(i = 0; i < (VMEM_NFRAMES * VMEM_GEO_PAGESIZE); i++) {
         fprintf(stderr, "%10x", vmem->mainMemory[i]);
         if(i % ncols == (ncols - 1)) {
             fprintf(stderr, "\n");
@@ -381,171 +1012,1565 @@ void dump_pt(void) {
 
 /* Your code goes here... */
 
-void cleanup(void) {
-    // distory shared memory 
-	TEST_AND_EXIT_ERRNO(-1 ==  shmctl(shm_id, IPC_RMID, NULL), "shmctl failed"); // Mark vmem for deletion 
-	TEST_AND_EXIT_ERRNO(-1 == shmdt(vmem), "shmdt failed"); // detach shared memory
-	PRINT_DEBUG((stderr, "Shared memory successfully detached\n"));
-    destroySyncDataExchange();
-    cleanup_pagefile();
-}
-
-void vmem_init(void) {
-
-    /* Create System V shared memory */
-
-    /* We are creating the shm, so set the IPC_CREAT flag */
-	key_t shm_key = ftok(SHMKEY, SHMPROCID);
-	TEST_AND_EXIT_ERRNO(shm_key == -1, "ftok failed!");
-	shm_id = shmget(shm_key, sizeof(struct vmem_struct), 0664 | IPC_CREAT);
-	
-	if (shm_id == -1){
-		fprintf(stderr, "Shared memory from old run might still exists\n");
-		fprintf(stderr, "   Use ipcs -ma for checking shared memory ressources\n");
-		fprintf(stderr, "   Use ipcrm for deleting shared memory ressources\n");
-	}
-	
-    /* Attach shared memory to vmem (virtual memory) */
-	TEST_AND_EXIT_ERRNO(shm_id == -1, "shmget failed!");
-	PRINT_DEBUG((stderr, "shmget successfuly allocated %lu bytes\n", sizeof(struct msg)));
-	vmem = (struct vmem_struct *) shmat(shm_id, NULL, 0);
-	TEST_AND_EXIT_ERRNO(vmem == (struct vmem_struct *) -1, "Error attaching shared memory");
-	PRINT_DEBUG((stderr, "Shared memory successfuly attached\n"));
-
-    /* Fill with zeros */
-    memset(vmem, 0, SHMSIZE);
+/**
+ *****************************************************************************************
+ *  @brief      This function prints the statistics of each client and the fairness
+ *              of the page fault rates (Jain's index: 1 if all rates are equal, 1/n if
+ *              one client has all page faults).
+ *
+ *  @return     void 
+ ****************************************************************************************/
+static void print_client_statistics(void) {
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    int n = 0;
+    int quota = 0;
+
+    for (int i = 0; i < nshards; i++) {
+        quota += shards[i].frame_quota;
+    }
+    printf("Frame allocation %10s, quota %6d frames\n", local_alloc ? "local" : "global", quota);
+    for (int asid = 0; asid < VMEM_NCLIENTS; asid++) {
+        struct vmem_client *vc = &vmem->header->clients[asid];
+        struct client_stats c;
+        if (vc->state == VMEM_CLIENT_FREE) {
+            continue;
+        }
+        memset(&c, 0, sizeof(c));
+        for (int i = 0; i < nshards; i++) {
+            struct client_stats *cs = &shards[i].clients[asid];
+            c.pf_count += cs->pf_count;
+            c.fault_time_ns += cs->fault_time_ns;
+            if (cs->fault_time_max_ns > c.fault_time_max_ns) {
+                c.fault_time_max_ns = cs->fault_time_max_ns;
+            }
+        }
+        double rate = client_g_count[asid] ? (double) c.pf_count / client_g_count[asid] : 0.0;
+        printf("Client %2d        pid %8d, page faults %10ld, global count %10ld, fault rate %8.5f\n",
+               asid, vc->pid, c.pf_count, client_g_count[asid], rate);
+        printf("                 RSS %6d frames, max %6d, fault time avg %10.0f ns, max %10.0f ns\n",
+               client_rss[asid], client_rss_max[asid], c.pf_count ? c.fault_time_ns / c.pf_count : 0.0, c.fault_time_max_ns);
+        sum += rate;
+        sum_sq += rate * rate;
+        n++;
+    }
+    printf("Fairness         %10.3f (Jain's index of fault rates of %d clients)\n",
+           (sum_sq > 0.0) ? sum * sum / (n * sum_sq) : 1.0, n);
 }
 
-//VOID_IDX wird returned fall kein unused frame da
-int find_unused_frame() {
-    for(int i = 0; i < VMEM_NFRAMES; i++) {
-        if (!is_used[i]) {
-            return i;
+/**
+ *****************************************************************************************
+ *  @brief      This function prints the statistics of each shard and the balance of
+ *              the page faults among the shards.
+ *
+ *  @return     void 
+ ****************************************************************************************/
+static void print_shard_statistics(void) {
+    long max_faults = 0;
+    for (int i = 0; i < nshards; i++) {
+        struct shard *sh = &shards[i];
+        printf("Shard %2d         frames %6d .. %6d, requests %10ld, page faults %10ld, queue max %4d\n",
+               i, sh->first_frame, sh->first_frame + sh->nframes - 1, sh->requests, sh->pf_count, sh->count_max);
+        printf("                 I/O time %12.3f ms, fault time %12.3f ms\n", sh->io_time_ns / 1e6, sh->fault_time_ns / 1e6);
+        if (sh->pf_count > max_faults) {
+            max_faults = sh->pf_count;
         }
     }
-
-    return VOID_IDX;
+    printf("Shard balance    %10.2f (page faults of busiest shard / average)\n",
+           pf_count ? (double) max_faults * nshards / pf_count : 1.0);
 }
 
-void allocate_page(const int req_page, const int g_count) {//?? muss pt aktualiesieren und neue page in vmem laden
-    pf_count++;
-    int frame = find_unused_frame();//VOID_IDX wird returned fall kein unused frame da
-    //printf("frame %d \n", frame);
-    int removedPage = VOID_IDX; 
-    if (frame == VOID_IDX) {
-        pageRepAlgo(req_page, &removedPage, &frame);
-        vmem->pt[removedPage].flags = false;
-        vmem->pt[removedPage].frame = VOID_IDX;
-    } else {
-        //printf("req_page: %d, frame: %d\n", req_page, frame);
-        fetch_page_from_pagefile(req_page, &vmem->mainMemory[frame * VMEM_PAGESIZE]);
-        is_used[frame] = true;
+void print_statistics(void) {
+    printf("\n======================================\n"
+           "\tStatistics\n");
+    struct pagefile_stats pf_stats;
+    get_pagefile_stats(&pf_stats);
+
+    // counters of vmaccess summed up over all clients
+    struct vmem_client sum;
+    memset(&sum, 0, sizeof(sum));
+    for (int asid = 0; asid < VMEM_NCLIENTS; asid++) {
+        struct vmem_client *vc = &vmem->header->clients[asid];
+        sum.silent_stores += vc->silent_stores;
+        sum.straddles += vc->straddles;
+        sum.threaded |= vc->threaded;
+        sum.coalesced_faults += vc->coalesced_faults;
+        if (vc->tlb.entries > 0) {
+            sum.tlb.entries = vc->tlb.entries;
+            sum.tlb.ways = vc->tlb.ways;
+        }
+        sum.tlb.hits += vc->tlb.hits;
+        sum.tlb.misses += vc->tlb.misses;
+        sum.tlb.shootdowns += vc->tlb.shootdowns;
+        sum.tlb.walks += vc->tlb.walks;
+        sum.tlb.huge_hits += vc->tlb.huge_hits;
+    }
+    // counters of memory management summed up over all shards
+    struct shard all;
+    memset(&all, 0, sizeof(all));
+    for (int i = 0; i < nshards; i++) {
+        struct shard *sh = &shards[i];
+        all.writeback_count += sh->writeback_count;
+        all.dirty_bytes += sh->dirty_bytes;
+        all.restored_pages += sh->restored_pages;
+        all.pinned_frames += sh->pinned_frames;
+        all.refused_pins += sh->refused_pins;
+        all.duplicate_faults += sh->duplicate_faults;
+        all.pending_sum += sh->pending_sum;
+        all.fault_time_ns += sh->fault_time_ns;
+        all.exposed_time_ns += sh->exposed_time_ns;
+        all.huge_frames += sh->huge_frames;
+        all.promotions_seq += sh->promotions_seq;
+        all.promotions_hot += sh->promotions_hot;
+        all.demotions += sh->demotions;
+        all.fill_pages += sh->fill_pages;
+        all.bloat_pages += sh->bloat_pages;
+        all.ksm_scans += sh->ksm_scans;
+        all.ksm_merges += sh->ksm_merges;
+        all.cow_breaks += sh->cow_breaks;
+        all.frames_saved += sh->frames_saved;
+        all.frames_saved_max += sh->frames_saved_max;
+        all.forks += sh->forks;
+        all.fork_shared += sh->fork_shared;
+        all.fork_copies += sh->fork_copies;
+        all.backing_copies += sh->backing_copies;
+        if (sh->pending_max > all.pending_max) {
+            all.pending_max = sh->pending_max;
+        }
+        if (sh->fault_time_max_ns > all.fault_time_max_ns) {
+            all.fault_time_max_ns = sh->fault_time_max_ns;
+        }
     }
-    age[frame].age = 0x80;
-    age[frame].page = req_page;
-    vmem->pt[req_page].frame = frame;
 
-    struct logevent le;
+    printf("Page faults      %10ld, Global count %10ld\n", pf_count, last_g_count);
+    printf("Writebacks       %10ld, dirty bytes %10ld\n", all.writeback_count, all.dirty_bytes);
+    printf("Silent stores    %10ld, restored pages %10ld\n", sum.silent_stores, all.restored_pages);
+    printf("Page straddles   %10ld\n", sum.straddles);
+    printf("Page table       %10d mid nodes, %10d leaf nodes, %10zu bytes\n", vmem->adm->pt_mids, vmem->adm->pt_leaves,
+           vmem->adm->pt_mids * PT_NODE_ENTRIES * sizeof(int) + vmem->adm->pt_leaves * PT_NODE_ENTRIES * sizeof(struct pt_entry));
+    if ((all.pinned_frames > 0) || (all.refused_pins > 0)) {
+        printf("Pinned frames    %10d, cap %4d, refused pins %10ld\n", all.pinned_frames, max_pinned, all.refused_pins);
+    }
+    if (sum.threaded) {
+        printf("Request slots    %10d, coalesced faults %10ld, duplicate faults %10ld\n",
+               nthreads, sum.coalesced_faults, all.duplicate_faults);
+        printf("Fault queue      avg %6.2f, max %4d outstanding requests\n",
+               pf_count ? (double) all.pending_sum / pf_count : 0.0, all.pending_max);
+        printf("Exposed faults   %12.3f ms of %12.3f ms fault time, overlap %6.2f\n",
+               all.exposed_time_ns / 1e6, all.fault_time_ns / 1e6, all.exposed_time_ns > 0.0 ? all.fault_time_ns / all.exposed_time_ns : 0.0);
+    }
+    if (sum.tlb.entries > 0) {
+        struct vmem_tlb_stats *tlb = &sum.tlb;
+        long lookups = tlb->hits + tlb->misses;
+        printf("TLB              %10d entries, %4d ways, reach %10d bytes\n", 
+               tlb->entries, tlb->ways, tlb->entries * VMEM_GEO_PAGESIZE);
+        printf("TLB hits         %10ld, misses %10ld, hit rate %6.2f %%, shootdowns %10ld\n",
+               tlb->hits, tlb->misses, lookups ? 100.0 * tlb->hits / lookups : 0.0, tlb->shootdowns);
+    }
+    if (VMEM_HUGEPAGES > 0) {
+        printf("Huge pages       %10d base pages, promotions %10ld (sequential %ld, hot %ld), demotions %10ld\n",
+               VMEM_HUGEPAGES, all.promotions_seq + all.promotions_hot, all.promotions_seq, all.promotions_hot, all.demotions);
+        printf("Huge frames      %10d, fill pages %10ld, bloat %10ld pages\n", all.huge_frames, all.fill_pages, all.bloat_pages);
+        printf("Page table walks %10ld, huge TLB hits %10ld\n", sum.tlb.walks, sum.tlb.huge_hits);
+    }
+    if (ksm_interval > 0) {
+        printf("Merged pages     %10ld, scans %10ld, COW breaks %10ld\n", all.ksm_merges, all.ksm_scans, all.cow_breaks);
+    }
+    if (forked) {
+        int used = 0;
+        for (int frame = 0; frame < VMEM_NFRAMES; frame++) {
+            used += is_used[frame];
+        }
+        printf("Forks            %10ld, shared frames %10ld, copied pinned pages %10ld\n", all.forks, all.fork_shared, all.fork_copies);
+        printf("COW faults       %10ld, backing copies %10ld, sharing ratio %6.2f pages per frame\n",
+               all.cow_breaks, all.backing_copies, used ? (double) (used + all.frames_saved) / used : 1.0);
+    }
+    if ((ksm_interval > 0) || forked) {
+        printf("Frames saved     %10d, max %10d\n", all.frames_saved, all.frames_saved_max);
+    }
+    if (checkpoint_name != NULL) {
+        printf("Checkpoints      %10d, %10ld bytes, file %s\n", checkpoints, checkpoint_bytes, checkpoint_name);
+    }
+    if (restore_name != NULL) {
+        printf("Restored         %10ld bytes, file %s\n", restored_bytes, restore_name);
+    }
+    if (shm_backing != VMEM_SHM_SYSV) {
+        printf("Shared memory    %10s, %10zu bytes\n", vmem_shm_backing_name(shm_backing), SHMSIZE);
+    }
+    printf("Pagefile reads   %10ld, bytes read %10ld\n", pf_stats.reads, pf_stats.bytes_read);
+    printf("Pagefile writes  %10ld, bytes written %10ld, write amplification %6.2f\n",
+           pf_stats.writes, pf_stats.bytes_written,
+           all.dirty_bytes ? (double) pf_stats.bytes_written / all.dirty_bytes : 0.0);
+
+    // every access hits main memory, faulting accesses after the page has been fetched
+    double runtime_ns = last_g_count * mem_ns + all.exposed_time_ns;
+    printf("Cost model       %10s, seeks %10ld, I/O time %12.3f ms\n",
+           get_pagefile_storage()->name, pf_stats.seeks, pf_stats.io_time_ns / 1e6);
+    printf("Fault time       avg %10.0f ns, max %10.0f ns\n",
+           pf_count ? all.fault_time_ns / pf_count : 0.0, all.fault_time_max_ns);
+    printf("Modeled runtime  %12.3f ms, effective access time %10.2f ns\n",
+           runtime_ns / 1e6, last_g_count ? runtime_ns / last_g_count : 0.0);
+    if (zswap_budget > 0) {
+        zswap_print_stats(stdout);
+    }
+    if ((VMEM_NCLIENTS > 1) || local_alloc) {
+        print_client_statistics();
+    }
+    if (sharded) {
+        print_shard_statistics();
+    }
+    fflush(stdout);
+}
+
+void cleanup(void) {
+    print_statistics();
+    // distory shared memory 
+    vmem_shm_destroy();
+	PRINT_DEBUG((stderr, "Shared memory successfully detached\n"));
+    destroySyncDataExchange();
+    if (livestats != NULL) {
+        livestats_remove();
+    }
+    if (zswap_budget > 0) {
+        zswap_cleanup();
+    }
+    cleanup_pagefile();
+}
+
+void vmem_init(void) {
+
+    /* Create and attach shared memory with the backing selected via -shm */
+	void *shm = vmem_shm_create(shm_backing);
+	PRINT_DEBUG((stderr, "Shared memory successfuly attached\n"));
+
+    /* Fill with zeros and publish geometry for vmaccess. Nodes of the page table 
+       will be initialized on allocation, so the pools are not touched. */
+    memset(shm, 0, vmem_shm_size(false));
+    vmem_map(&vmem_view, shm);
+    vmem = &vmem_view;
+    vmem->header->geometry = vmem_geometry;
+
+    /* Data of memory management depending on geometry */
+    page_checksum = calloc(VMEM_NFRAMES, sizeof(uint64_t));
+    pin_count = calloc(VMEM_NFRAMES, sizeof(int));
+    age = calloc(VMEM_NFRAMES, sizeof(struct age));
+    age_counter = calloc(VMEM_NFRAMES, sizeof(unsigned char));
+    is_used = calloc(VMEM_NFRAMES, sizeof(bool));
+    huge_frame = calloc(VMEM_NFRAMES, sizeof(int));
+    fill_page = calloc(VMEM_NFRAMES, sizeof(bool));
+    TEST_AND_EXIT_ERRNO(!page_checksum || !pin_count || !age || !age_counter || !is_used || !huge_frame || !fill_page, "Error allocating memory management data");
+    // a clone shares frames of all clients like merged pages
+    vmem->adm->fork_enabled = (VMEM_NCLIENTS > 1) && !sharded && (VMEM_HUGEPAGES == 0) && !local_alloc;
+    for (int asid = 0; asid < VMEM_NCLIENTS; asid++) {
+        clone_root[asid] = asid;
+    }
+    if ((ksm_interval > 0) || vmem->adm->fork_enabled) {
+        sharers = calloc(VMEM_NFRAMES, sizeof(struct sharer *));
+        TEST_AND_EXIT_ERRNO(!sharers, "Error allocating data of shared frames");
+    }
+    if (ksm_interval > 0) {
+        ksm_hash = calloc(VMEM_NFRAMES, sizeof(uint64_t));
+        ksm_items = calloc(VMEM_NFRAMES, sizeof(struct ksm_item));
+        TEST_AND_EXIT_ERRNO(!ksm_hash || !ksm_items, "Error allocating data of same-page merging");
+    }
+}
+
+//VOID_IDX wird returned fall kein unused frame da
+int find_unused_frame(struct shard *sh) {
+    for(int i = sh->first_frame; i < sh->first_frame + sh->nframes; i++) {
+        if (!is_used[i]) {
+            return i;
+        }
+    }
+
+    return VOID_IDX;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function updates the resident set size of a client.
+ *
+ *  @param      sh Shard serving the request
+ *  @param      asid Address space of client
+ *  @param      delta frames added (1) or removed (-1)
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void count_resident(struct shard *sh, int asid, int delta) {
+    sh->clients[asid].rss += delta;
+    int rss = __atomic_add_fetch(&client_rss[asid], delta, __ATOMIC_RELAXED);
+    int rss_max = __atomic_load_n(&client_rss_max[asid], __ATOMIC_RELAXED);
+    while ((rss > rss_max) && 
+           !__atomic_compare_exchange_n(&client_rss_max[asid], &rss_max, rss, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function takes a frame for a page of a client: an unused frame or
+ *              the frame of the page selected by the page replacement algorithm. The
+ *              selected page will be removed.
+ *
+ *  @param      sh Shard serving the request
+ *  @param      asid Address space of the client
+ *  @param      page Page that will be stored in the frame
+ *  @param      removedPage Page that has been removed. If an unused frame has been 
+ *              taken, this parameter will not be modified.
+ *
+ *  @return     frame
+ ****************************************************************************************/
+static int take_frame(struct shard *sh, int asid, long page, long *removedPage) {
+    struct client_stats *c = &sh->clients[asid];
+    int frame = VOID_IDX;
+    if (!local_alloc || (c->rss < sh->frame_quota)) {
+        // local allocation: the quotas of all clients fit into the frames of the shard
+        frame = find_unused_frame(sh);//VOID_IDX wird returned fall kein unused frame da
+    }
+    //printf("frame %d \n", frame);
+    if (frame == VOID_IDX) {
+        sh->victim_asid = local_alloc ? asid : VOID_IDX;
+        frame = pagerep_select(&sh->rep);
+        *removedPage = find_page_by_frame(frame);
+        if (live != NULL) {
+            livestats_add(&live->selections[sh->rep.algo], 1);
+            livestats_add(&live->scanned[sh->rep.algo], sh->rep.scanned);
+        }
+        int removedAsid = age[frame].asid;
+        if (huge_frame[frame] != VOID_IDX) {
+            demote_huge(sh, huge_frame[frame]); // memory pressure splits the huge page
+        }
+        if (vmem->access_bits[frame] & PTF_SHARED) {
+            ksm_remove_sharers(sh, frame);
+        }
+        remove_page(sh, removedAsid, *removedPage, frame);
+        count_resident(sh, removedAsid, -1);
+    } else {
+        //printf("req_page: %d, frame: %d\n", req_page, frame);
+        is_used[frame] = true;
+    }
+    return frame;
+}
+
+void allocate_page(struct shard *sh, const int asid, const long req_page, const long g_count) {//?? muss pt aktualiesieren und neue page in vmem laden
+    struct client_stats *c = &sh->clients[asid];
+    sh->pf_count++;
+    c->pf_count++;
+    if (live != NULL) {
+        livestats_add(&live->faults, 1);
+    }
+    long removedPage = VOID_IDX; 
+    int frame = take_frame(sh, asid, req_page, &removedPage);
+    fetch_page(sh, asid, req_page, frame);
+    age_counter[frame] = PAGEREP_AGE_FETCHED;
+    age[frame].page = req_page;
+    age[frame].asid = asid;
+    count_resident(sh, asid, 1);
+    // frame and present bit are published together
+    pte_set(vmem_pte_alloc(vmem, asid, req_page), frame, PTF_PRESENT);
+
+    struct logevent le;
     /* Log action */
     le.req_pageno = req_page;
     le.replaced_page = removedPage;
     le.alloc_frame = frame;
     le.g_count = g_count; 
-    le.pf_count = pf_count;
+    pthread_mutex_lock(&logger_mutex);
+    le.pf_count = ++pf_count;
     logger(le);
+    pthread_mutex_unlock(&logger_mutex);
 }
 
-int find_page_by_frame(int frame) {
-    for (int i = 0; i < VMEM_NPAGES; i++) {
-        if (vmem->pt[i].frame == frame)
-        {
-            return i;
+/**
+ *****************************************************************************************
+ *  @brief      This function computes the FNV-1a checksum of a page.
+ *
+ *  @param      frame_start Starting address of the frame that contains the page.
+ *
+ *  @return     checksum
+ ****************************************************************************************/
+static uint64_t checksum_page(const unsigned char *frame_start) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < VMEM_GEO_PAGESIZE; i++) {
+        hash = (hash ^ frame_start[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function computes the number of a page in backing store (zswap and
+ *              pagefile). The address spaces are stored one after another.
+ *
+ *  @param      asid Address space of page
+ *  @param      page Number of page within its address space
+ *
+ *  @return     number of page in backing store
+ ****************************************************************************************/
+static long backing_page(int asid, long page) {
+    return asid * VMEM_NPAGES + page;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function locks zswap and the pagefile, which serve all shards.
+ *              The modeled I/O time is charged to the shard by backing_unlock.
+ *
+ *  @param      before Statistics of pagefile taken at lock time
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void backing_lock(struct pagefile_stats *before) {
+    pthread_mutex_lock(&backing_mutex);
+    get_pagefile_stats(before);
+}
+
+static void backing_unlock(struct shard *sh, const struct pagefile_stats *before) {
+    struct pagefile_stats after;
+    get_pagefile_stats(&after);
+    sh->io_time_ns += after.io_time_ns - before->io_time_ns;
+    if (live != NULL) {
+        livestats_add(&live->bytes_read, after.bytes_read - before->bytes_read);
+        livestats_add(&live->bytes_written, after.bytes_written - before->bytes_written);
+    }
+    pthread_mutex_unlock(&backing_mutex);
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the address space whose backing copy holds a page
+ *              that is not present, see clone_root.
+ *
+ *  @param      asid Address space of page
+ *  @param      page Number of page
+ *
+ *  @return     address space of the backing copy
+ ****************************************************************************************/
+static int backing_origin(int asid, long page) {
+    struct pt_entry *pte = vmem_pte(vmem, asid, page);
+    int origin = (pte != NULL) ? pte_frame(pte) : VOID_IDX;
+    return (origin != VOID_IDX) ? origin : clone_root[asid];
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function clears the page table entry of a page that has been 
+ *              removed from main memory. The entry keeps the address space of the 
+ *              backing copy, unless it is the default one.
+ *
+ *  @param      pte Page table entry of the page
+ *  @param      asid Address space of page
+ *  @param      origin Address space of the backing copy
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void unmap_page(struct pt_entry *pte, int asid, int origin) {
+    pte_set(pte, (origin == clone_root[asid]) ? VOID_IDX : origin, 0);
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the address space of the backing copy of a page
+ *              stored in a frame. The frame may be shared.
+ *
+ *  @param      asid Address space of page
+ *  @param      page Number of page
+ *  @param      frame Frame storing the page
+ *
+ *  @return     reference to the address space of the backing copy
+ ****************************************************************************************/
+static int *mapping_origin(int asid, long page, int frame) {
+    if ((age[frame].asid == asid) && (age[frame].page == page)) {
+        return &age[frame].origin;
+    }
+    for (struct sharer *s = (sharers != NULL) ? sharers[frame] : NULL; s != NULL; s = s->next) {
+        if ((s->asid == asid) && (s->page == page)) {
+            return &s->origin;
         }
     }
+    TEST_AND_EXIT(true, (stderr, "mapping_origin: page %ld does not map frame %d\n", page, frame));
+    return NULL;
+}
 
-    return VOID_IDX;
+/**
+ *****************************************************************************************
+ *  @brief      This function reads and writes whole pages of the backing store. The 
+ *              backing store must be locked by backing_lock.
+ *
+ *  @param      page Number of page in backing store
+ *  @param      buf Contents of page
+ *  @param      fault true: the page is read for a page fault and counts as zswap load;
+ *              false: the backing copy is read by mmanage itself, see zswap_peek
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void read_backing(long page, unsigned char *buf, bool fault) {
+    bool found = false;
+    if (zswap_budget > 0) {
+        found = fault ? zswap_load(page, buf) : zswap_peek(page, buf);
+    }
+    if (!found) {
+        fetch_page_from_pagefile(page, buf);
+    }
 }
 
-void inc_frame_counter() {
-    frame_counter++;
-    if (frame_counter >= VMEM_NFRAMES) {
-        frame_counter = 0;
+static void write_backing(long page, unsigned char *buf) {
+    if (zswap_budget > 0) {
+        zswap_store(page, buf);
+    } else {
+        store_page_to_pagefile(page, buf);
     }
 }
 
-void find_remove_fifo(int page, int *removedPage, int *frame) {
+/**
+ *****************************************************************************************
+ *  @brief      This function copies the backing copy of a page, before it will be 
+ *              overwritten, into the backing store of each clone still referring to it.
+ *              Afterwards the pages of the clones refer to their own backing copy.
+ *
+ *  @param      sh Shard serving the request
+ *  @param      asid Address space whose backing copy will be overwritten
+ *  @param      page Number of page
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void copy_out(struct shard *sh, int asid, long page) {
+    unsigned char *buf = sh->scratch;
+    struct pagefile_stats before;
+    bool loaded = false;
+    for (int c = 0; c < VMEM_NCLIENTS; c++) {
+        struct pt_entry *pte = vmem_pte(vmem, c, page);
+        int *origin = NULL;
+        if (c == asid) {
+            continue;
+        }
+        if ((pte != NULL) && (pte_flags(pte) & PTF_PRESENT)) {
+            origin = mapping_origin(c, page, pte_frame(pte));
+            if (*origin != asid) {
+                continue;
+            }
+        } else if (backing_origin(c, page) != asid) {
+            continue;
+        }
+        backing_lock(&before);
+        if (!loaded) {
+            read_backing(backing_page(asid, page), buf, false);
+            loaded = true;
+        }
+        write_backing(backing_page(c, page), buf);
+        backing_unlock(sh, &before);
+        if (origin != NULL) {
+            *origin = c;
+        } else {
+            unmap_page(vmem_pte_alloc(vmem, c, page), c, c);
+        }
+        sh->backing_copies++;
+    }
+}
 
-    *frame = frame_counter;
-    *removedPage = find_page_by_frame(*frame);
+void fetch_page(struct shard *sh, int asid, long page, int frame) {
+    unsigned char *frame_start = &vmem->mainMemory[frame * VMEM_GEO_PAGESIZE];
+    struct pagefile_stats before;
+    int origin = backing_origin(asid, page);
+    backing_lock(&before);
+    read_backing(backing_page(origin, page), frame_start, true);
+    backing_unlock(sh, &before);
+    age[frame].origin = origin;
+    if (use_checksum) {
+        page_checksum[frame] = checksum_page(frame_start);
+    }
+}
 
-    if (vmem->pt[*removedPage].flags & PTF_DIRTY) {
-        store_page_to_pagefile(*removedPage, &vmem->mainMemory[*frame * VMEM_PAGESIZE]);
+/**
+ *****************************************************************************************
+ *  @brief      This function hides a page from vmaccess: the present bit is cleared and
+ *              the TLBs are shot down. It returns, when no thread of vmaccess accesses
+ *              the frame anymore.
+ *
+ *  @param      pte Page table entry of the page
+ *  @param      frame Frame storing the page
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void hide_page(struct pt_entry *pte, int frame) {
+    // threads of vmapp check the present bit after pinning the frame, see vmaccess
+    pte_clear_flags(pte, PTF_PRESENT);
+    __atomic_add_fetch(&vmem->adm->tlb_evict_epoch, 1, __ATOMIC_SEQ_CST); // shootdown of TLB entry in vmaccess
+    while (__atomic_load_n(&vmem->busy[frame], __ATOMIC_SEQ_CST) > 0) {
+        sched_yield();
     }
-    
-    fetch_page_from_pagefile(page, &vmem->mainMemory[*frame * VMEM_PAGESIZE]);
+}
 
-    inc_frame_counter();
+/**
+ *****************************************************************************************
+ *  @brief      This function checks, whether the backing copy of the page of a frame
+ *              equals the contents of the frame: the frame is clean or, with -checksum, 
+ *              the page has been restored to its fetched contents. Equal checksums are
+ *              confirmed by comparing the backing copy, so a collision of checksums 
+ *              never drops a modification. The read is charged to the shard.
+ *
+ *  @param      sh Shard serving the request
+ *  @param      frame Number of frame
+ *  @param      page Number of the page stored in frame
+ *  @param      origin Address space of the backing copy of the page
+ *  @param      hash Checksum of the contents of the frame
+ *
+ *  @return     true, if the backing copy is up to date
+ ****************************************************************************************/
+static bool backing_up_to_date(struct shard *sh, int frame, long page, int origin, uint64_t hash) {
+    struct pagefile_stats before;
+
+    if (!(vmem->access_bits[frame] & PTF_DIRTY)) {
+        return true;
+    }
+    if (!use_checksum || (page_checksum[frame] != hash)) {
+        return false;
+    }
+    backing_lock(&before);
+    read_backing(backing_page(origin, page), sh->scratch, false);
+    backing_unlock(sh, &before);
+    return memcmp(sh->scratch, &vmem->mainMemory[frame * VMEM_GEO_PAGESIZE], VMEM_GEO_PAGESIZE) == 0;
 }
 
-static void find_remove_clock(int page, int * removedPage, int *frame){
-    while(true) {
-        int testpage = find_page_by_frame(frame_counter);
-        if (vmem->pt[testpage].flags & PTF_REF) {
-            vmem->pt[testpage].flags &= (~PTF_REF);
-            inc_frame_counter();
-        }else {
-            *removedPage = testpage;
-            break;
+/**
+ *****************************************************************************************
+ *  @brief      This function writes a page back to zswap or the pagefile, if its frame
+ *              is dirty. A page whose backing copy belongs to another address space 
+ *              is written as a whole.
+ *
+ *  @param      sh Shard serving the request
+ *  @param      asid Address space of the page
+ *  @param      page Number of the page
+ *  @param      frame Frame storing the page
+ *  @param      origin Address space of the backing copy of the page
+ *
+ *  @return     address space of the backing copy afterwards
+ ****************************************************************************************/
+static int write_back_page(struct shard *sh, int asid, long page, int frame, int origin) {
+    unsigned char *frame_start = &vmem->mainMemory[frame * VMEM_GEO_PAGESIZE];
+    bool dirty_page = (vmem->access_bits[frame] & PTF_DIRTY) != 0;
+    if (dirty_page && use_checksum && backing_up_to_date(sh, frame, page, origin, checksum_page(frame_start))) {
+        // modified and restored afterwards, backing copy is up to date
+        sh->restored_pages++;
+    } else if (dirty_page) {
+        struct pagefile_stats before;
+        uint64_t sectors = vmem->dirty_sectors[frame];
+        int dirty = __builtin_popcountll(sectors) * VMEM_GEO_SECTORSIZE;
+        sh->writeback_count++;
+        if (live != NULL) {
+            livestats_add(&live->writebacks, 1);
+        }
+        sh->dirty_bytes += (dirty < VMEM_GEO_PAGESIZE) ? dirty : VMEM_GEO_PAGESIZE;
+        if (forked) {
+            copy_out(sh, asid, page);
+        }
+        backing_lock(&before);
+        if ((zswap_budget == 0) && subpage_writeback && (origin == asid)) {
+            store_sectors_to_pagefile(backing_page(asid, page), frame_start, sectors);
+        } else {
+            write_backing(backing_page(asid, page), frame_start);
         }
+        backing_unlock(sh, &before);
+        return asid;
     }
-    *frame = frame_counter;
+    return origin;
+}
+
+void remove_page(struct shard *sh, int asid, long page, int frame) {
+    struct pt_entry *pte = vmem_pte(vmem, asid, page);
+    hide_page(pte, frame);
+    unmap_page(pte, asid, write_back_page(sh, asid, page, frame, age[frame].origin));
+    vmem->access_bits[frame] = 0;
+    vmem->dirty_sectors[frame] = 0;
+}
+
+long find_page_by_frame(int frame) {
+    // the aging information holds the page of each used frame
+    return is_used[frame] ? age[frame].page : VOID_IDX;
+}
 
-    if (vmem->pt[*removedPage].flags & PTF_DIRTY) {
-        store_page_to_pagefile(*removedPage, &vmem->mainMemory[*frame * VMEM_PAGESIZE]);
+/**
+ *****************************************************************************************
+ *  @brief      This function checks the cap of pinned frames. With local frame 
+ *              allocation, at least one frame of the quota of a client stays replaceable.
+ *
+ *  @param      sh Shard of the page to be pinned
+ *  @param      asid Address space of the page to be pinned
+ *
+ *  @return     true, if another frame may be pinned
+ ****************************************************************************************/
+static bool may_pin(struct shard *sh, int asid) {
+    return (sh->pinned_frames < sh->max_pinned) && (!local_alloc || (sh->clients[asid].pinned < sh->frame_quota - 1));
+}
+
+void pin_page(struct shard *sh, int asid, long page, long g_count) {
+    TEST_AND_EXIT((page < 0) || (page >= VMEM_NPAGES), (stderr, "pin_page: page out of range\n"));
+    struct pt_entry *pte = vmem_pte(vmem, asid, page);
+    if ((pte != NULL) && (pte_flags(pte) & PTF_PRESENT) && (vmem->access_bits[pte_frame(pte)] & PTF_SHARED)) {
+        // a pinned page gets a frame of its own
+        break_cow(sh, asid, page);
     }
-    
-    fetch_page_from_pagefile(page, &vmem->mainMemory[*frame * VMEM_PAGESIZE]);
+    if ((pte == NULL) || !(pte_flags(pte) & PTF_PRESENT)) {
+        if (!may_pin(sh, asid)) {
+            sh->refused_pins++;
+            return;
+        }
+        allocate_page(sh, asid, page, g_count);
+        pte = vmem_pte(vmem, asid, page);
+    }
+    int frame = pte_frame(pte);
+    if (pin_count[frame] == 0) {
+        if (!may_pin(sh, asid)) {
+            sh->refused_pins++;
+            return;
+        }
+        pte_set_flags(pte, PTF_PINNED);
+        sh->pinned_frames++;
+        sh->clients[asid].pinned++;
+    }
+    pin_count[frame]++;
+}
+
+void unpin_page(struct shard *sh, int asid, long page) {
+    TEST_AND_EXIT((page < 0) || (page >= VMEM_NPAGES), (stderr, "unpin_page: page out of range\n"));
+    struct pt_entry *pte = vmem_pte(vmem, asid, page);
+    // a pinned page is present
+    if ((pte == NULL) || !(pte_flags(pte) & PTF_PRESENT) || (pin_count[pte_frame(pte)] == 0)) {
+        return;
+    }
+    if (--pin_count[pte_frame(pte)] == 0) {
+        pte_clear_flags(pte, PTF_PINNED);
+        sh->pinned_frames--;
+        sh->clients[asid].pinned--;
+    }
+}
+
+bool frame_is_pinned(int frame) {
+    return pin_count[frame] > 0;
+}
+
+bool frame_is_candidate(struct shard *sh, int frame) {
+    return is_used[frame] && ((sh->pinned_frames == 0) || !frame_is_pinned(frame)) && 
+           ((sh->victim_asid == VOID_IDX) || (age[frame].asid == sh->victim_asid));
+}
 
-    inc_frame_counter();
+bool rep_is_candidate(const struct pagerep *pr, int frame) {
+    return frame_is_candidate(pr->owner, frame);
+}
+
+bool rep_holds_page(const struct pagerep *pr, int frame) {
+    return age[frame].page != VOID_IDX;
+}
+
+bool rep_test_clear_ref(const struct pagerep *pr, int frame) {
+    if (!(vmem->access_bits[frame] & PTF_REF)) {
+        return false;
+    }
+    __atomic_and_fetch(&vmem->access_bits[frame], ~PTF_REF, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&vmem->adm->tlb_ref_epoch, 1, __ATOMIC_SEQ_CST);
+    fill_page[frame] = false;
+    return true;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function moves a present page into an unused frame. Like on
+ *              removal, vmaccess sees the page as not present, until it has been copied.
+ *
+ *  @param      asid Address space of the page
+ *  @param      page Number of the page
+ *  @param      from Frame storing the page
+ *  @param      to Unused frame
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void move_page(int asid, long page, int from, int to) {
+    struct pt_entry *pte = vmem_pte(vmem, asid, page);
+    hide_page(pte, from);
+    memcpy(&vmem->mainMemory[to * VMEM_GEO_PAGESIZE], &vmem->mainMemory[from * VMEM_GEO_PAGESIZE], VMEM_GEO_PAGESIZE);
+    vmem->dirty_sectors[to] = vmem->dirty_sectors[from];
+    vmem->dirty_sectors[from] = 0;
+    vmem->access_bits[to] = vmem->access_bits[from];
+    vmem->access_bits[from] = 0;
+    page_checksum[to] = page_checksum[from];
+    fill_page[to] = fill_page[from];
+    fill_page[from] = false;
+    age[to] = age[from];
+    age_counter[to] = age_counter[from];
+    age[from].page = VOID_IDX;
+    age[from].asid = VOID_IDX;
+    age_counter[from] = 0;
+    is_used[to] = true;
+    is_used[from] = false;
+    pte_set(pte, to, pte_flags(pte) | PTF_PRESENT);
 }
 
-static void find_remove_aging(int page, int * removedPage, int *frame) {
-    //printf("\n");
-    // nach ältestem frame suchen
-    uint8_t smallest_count = 0xFF;
-    for (int i = 0; i < VMEM_NFRAMES; i++) {
-        //printf("vorher: frame %d age counter\t %d \n", i, age[i].age);
-        if (age[i].age <= smallest_count) {
-            smallest_count = age[i].age;
-            *frame = i;
+/**
+ *****************************************************************************************
+ *  @brief      This function promotes the run of a page to a huge page. The run is 
+ *              stored in an aligned run of frames, which are unused or store their page
+ *              of the run already; the run with the most pages in place is taken. The 
+ *              other present pages are moved, the missing pages are fetched without page
+ *              fault. Without such a run of frames, i.e. under memory pressure, and if
+ *              a page of the run is pinned, the run will not be promoted.
+ *
+ *  @param      sh Shard serving the request
+ *  @param      asid Address space of the run
+ *  @param      page A page of the run
+ *  @param      promotions Counter of promotions incremented on success
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void promote_huge(struct shard *sh, int asid, long page, long *promotions) {
+    int n = VMEM_HUGEPAGES;
+    long head = page & ~(long) (n - 1);
+    int missing = 0;
+    int first = VOID_IDX;
+    int first_in_place = -1;
+
+    if (head + n > VMEM_NPAGES) {
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        struct pt_entry *pte = vmem_pte(vmem, asid, head + i);
+        if ((pte != NULL) && (pte_flags(pte) & (PTF_PINNED | PTF_HUGE))) {
+            return;
         }
+        missing += (pte == NULL) || !(pte_flags(pte) & PTF_PRESENT);
     }
-    *removedPage = age[*frame].page;
-    //printf("smallest count %d, *frame %d, *removedPage %d\n", smallest_count, *frame, *removedPage);
+    if (local_alloc && (sh->clients[asid].rss + missing > sh->frame_quota)) {
+        return;
+    }
+    for (int h = (sh->first_frame + n - 1) & ~(n - 1); h + n <= sh->first_frame + sh->nframes; h += n) {
+        int in_place = 0;
+        bool usable = true;
+        for (int i = 0; (i < n) && usable; i++) {
+            if (is_used[h + i]) {
+                usable = (age[h + i].asid == asid) && (age[h + i].page == head + i);
+                in_place += usable;
+            }
+        }
+        if (usable && (in_place > first_in_place)) {
+            first = h;
+            first_in_place = in_place;
+        }
+    }
+    if (first == VOID_IDX) {
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        int frame = first + i;
+        struct pt_entry *pte = vmem_pte_alloc(vmem, asid, head + i);
+        if (!(pte_flags(pte) & PTF_PRESENT)) {
+            is_used[frame] = true;
+            fetch_page(sh, asid, head + i, frame);
+            age_counter[frame] = 0; // not referenced yet
+            age[frame].page = head + i;
+            age[frame].asid = asid;
+            fill_page[frame] = true;
+            count_resident(sh, asid, 1);
+            sh->fill_pages++;
+            pte_set(pte, frame, PTF_PRESENT);
+        } else if (pte_frame(pte) != frame) {
+            move_page(asid, head + i, pte_frame(pte), frame);
+        }
+    }
+    // all pages are in place, vmaccess may cache the run now
+    for (int i = 0; i < n; i++) {
+        huge_frame[first + i] = first;
+        pte_set_flags(vmem_pte(vmem, asid, head + i), PTF_HUGE);
+    }
+    sh->huge_frames++;
+    (*promotions)++;
+}
 
-    if (vmem->pt[*removedPage].flags & PTF_DIRTY) {
-        store_page_to_pagefile(*removedPage, &vmem->mainMemory[*frame * VMEM_PAGESIZE]);
+void demote_huge(struct shard *sh, int first) {
+    for (int frame = first; frame < first + VMEM_HUGEPAGES; frame++) {
+        struct pt_entry *pte = vmem_pte(vmem, age[frame].asid, age[frame].page);
+        if (fill_page[frame] && !(vmem->access_bits[frame] & (PTF_REF | PTF_DIRTY))) {
+            sh->bloat_pages++;
+        }
+        fill_page[frame] = false;
+        huge_frame[frame] = VOID_IDX;
+        pte_clear_flags(pte, PTF_HUGE);
     }
+    __atomic_add_fetch(&vmem->adm->tlb_evict_epoch, 1, __ATOMIC_SEQ_CST); // shootdown of TLB entry of huge page
+    sh->huge_frames--;
+    sh->demotions++;
+}
+
+void promote_sequential(struct shard *sh, int asid, long page) {
+    struct client_stats *c = &sh->clients[asid];
+    int threshold = (VMEM_HUGEPAGES / 2 > 2) ? VMEM_HUGEPAGES / 2 : 2;
 
-    fetch_page_from_pagefile(page, &vmem->mainMemory[*frame * VMEM_PAGESIZE]);
-    //while (pf_count == 25);
+    if ((page == c->seq_page + 1) && (page & (VMEM_HUGEPAGES - 1))) {
+        c->seq_faults++;
+    } else {
+        c->seq_faults = 1;
+    }
+    c->seq_page = page;
+    if (c->seq_faults == threshold) {
+        promote_huge(sh, asid, page, &sh->promotions_seq);
+    }
+}
+
+void promote_hot(struct shard *sh) {
+    for (int frame = sh->first_frame; frame < sh->first_frame + sh->nframes; frame++) {
+        // a run is checked at the frame of its first page
+        if (!is_used[frame] || (huge_frame[frame] != VOID_IDX) || (age[frame].page & (VMEM_HUGEPAGES - 1))) {
+            continue;
+        }
+        int asid = age[frame].asid;
+        long head = age[frame].page;
+        bool hot = (head + VMEM_HUGEPAGES <= VMEM_NPAGES);
+        for (int i = 0; (i < VMEM_HUGEPAGES) && hot; i++) {
+            struct pt_entry *pte = vmem_pte(vmem, asid, head + i);
+            hot = (pte != NULL) && (pte_flags(pte) & PTF_PRESENT) && (vmem->access_bits[pte_frame(pte)] & PTF_REF);
+        }
+        if (hot) {
+            promote_huge(sh, asid, head, &sh->promotions_hot);
+        }
+    }
+}
+
+static void count_saved(struct shard *sh, int delta) {
+    sh->frames_saved += delta;
+    if (sh->frames_saved > sh->frames_saved_max) {
+        sh->frames_saved_max = sh->frames_saved;
+    }
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function merges the page of a frame into a frame of identical 
+ *              contents. Both pages are hidden from vmaccess, until the contents have 
+ *              been compared again and the page table has been updated. If a backing 
+ *              copy is not up to date, the shared frame gets dirty, so each of its 
+ *              pages will be written back on removal.
+ *
+ *  @param      sh Shard serving the request
+ *  @param      from Frame storing a page that is not shared
+ *  @param      to Frame the page will be merged into
+ *
+ *  @return     true, if the page has been merged
+ ****************************************************************************************/
+static bool ksm_merge(struct shard *sh, int from, int to) {
+    unsigned char *from_start = &vmem->mainMemory[from * VMEM_GEO_PAGESIZE];
+    unsigned char *to_start = &vmem->mainMemory[to * VMEM_GEO_PAGESIZE];
+    int asid = age[from].asid;
+    long page = age[from].page;
+    struct pt_entry *pte = vmem_pte(vmem, asid, page);
+    struct pt_entry *to_pte = vmem_pte(vmem, age[to].asid, age[to].page);
+    bool shared = (vmem->access_bits[to] & PTF_SHARED) != 0;
+
+    // a shared frame is never stored into
+    hide_page(pte, from);
+    if (!shared) {
+        hide_page(to_pte, to);
+    }
+    if (memcmp(from_start, to_start, VMEM_GEO_PAGESIZE) != 0) {
+        // modified since the scan or different contents of equal checksum
+        pte_set_flags(pte, PTF_PRESENT);
+        if (!shared) {
+            pte_set_flags(to_pte, PTF_PRESENT);
+        }
+        return false;
+    }
+    uint64_t hash = checksum_page(to_start);
+    if (!backing_up_to_date(sh, from, page, age[from].origin, hash) ||
+        !backing_up_to_date(sh, to, age[to].page, age[to].origin, hash)) {
+        __atomic_fetch_or(&vmem->access_bits[to], PTF_DIRTY, __ATOMIC_SEQ_CST);
+        vmem->dirty_sectors[to] |= vmem->dirty_sectors[from];
+        page_checksum[to] = ~hash;
+    }
+    __atomic_fetch_or(&vmem->access_bits[to], (vmem->access_bits[from] & PTF_REF) | PTF_SHARED, __ATOMIC_SEQ_CST);
+    struct sharer *s = malloc(sizeof(struct sharer));
+    TEST_AND_EXIT_ERRNO(s == NULL, "ksm_merge: malloc failed");
+    s->asid = asid;
+    s->page = page;
+    s->origin = age[from].origin;
+    s->next = sharers[to];
+    sharers[to] = s;
+    pte_set(pte, to, PTF_PRESENT);
+    if (!shared) {
+        pte_set_flags(to_pte, PTF_PRESENT);
+    }
+    // frame of merged page becomes unused
+    is_used[from] = false;
+    age[from].page = VOID_IDX;
+    age[from].asid = VOID_IDX;
+    age_counter[from] = 0;
+    vmem->access_bits[from] = 0;
+    vmem->dirty_sectors[from] = 0;
+    count_resident(sh, asid, -1);
+    sh->ksm_merges++;
+    count_saved(sh, 1);
+    return true;
+}
+
+static int compare_ksm_items(const void *a, const void *b) {
+    const struct ksm_item *x = a;
+    const struct ksm_item *y = b;
+    if (x->hash != y->hash) {
+        return (x->hash < y->hash) ? -1 : 1;
+    }
+    return x->frame - y->frame;
+}
+
+void ksm_scan(struct shard *sh) {
+    int n = 0;
+    for (int frame = sh->first_frame; frame < sh->first_frame + sh->nframes; frame++) {
+        if (!is_used[frame] || frame_is_pinned(frame)) {
+            continue;
+        }
+        uint64_t hash = checksum_page(&vmem->mainMemory[frame * VMEM_GEO_PAGESIZE]);
+        // like KSM, a page is merged only if it has not changed since the last scan
+        if ((vmem->access_bits[frame] & PTF_SHARED) || (hash == ksm_hash[frame])) {
+            ksm_items[n].hash = hash;
+            ksm_items[n].frame = frame;
+            n++;
+        }
+        ksm_hash[frame] = hash;
+    }
+    qsort(ksm_items, n, sizeof(struct ksm_item), compare_ksm_items);
+    for (int first = 0, last = 0; first < n; first = last + 1) {
+        // frames of equal checksum are merged into a shared one, if there is one
+        int to = ksm_items[first].frame;
+        for (last = first; (last + 1 < n) && (ksm_items[last + 1].hash == ksm_items[first].hash); last++) {
+            if (vmem->access_bits[ksm_items[last + 1].frame] & PTF_SHARED) {
+                to = ksm_items[last + 1].frame;
+            }
+        }
+        for (int i = first; i <= last; i++) {
+            int from = ksm_items[i].frame;
+            if ((from != to) && !(vmem->access_bits[from] & PTF_SHARED)) {
+                ksm_merge(sh, from, to);
+            }
+        }
+    }
+    sh->ksm_scans++;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function removes a page from the pages mapping a shared frame. If 
+ *              the page is the first one, the next page takes over the frame. The last 
+ *              page keeps the frame unshared.
+ *
+ *  @param      sh Shard serving the request
+ *  @param      asid Address space of the page
+ *  @param      page Number of the page
+ *  @param      frame Shared frame
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void ksm_detach(struct shard *sh, int asid, long page, int frame) {
+    struct sharer **p = &sharers[frame];
+    if ((age[frame].asid == asid) && (age[frame].page == page)) {
+        count_resident(sh, asid, -1);
+        age[frame].asid = (*p)->asid;
+        age[frame].page = (*p)->page;
+        age[frame].origin = (*p)->origin;
+        count_resident(sh, age[frame].asid, 1);
+    } else {
+        while ((*p != NULL) && (((*p)->asid != asid) || ((*p)->page != page))) {
+            p = &(*p)->next;
+        }
+        TEST_AND_EXIT(*p == NULL, (stderr, "ksm_detach: page %ld does not map frame %d\n", page, frame));
+    }
+    struct sharer *s = *p;
+    *p = s->next;
+    free(s);
+    count_saved(sh, -1);
+    if (sharers[frame] == NULL) {
+        __atomic_and_fetch(&vmem->access_bits[frame], ~PTF_SHARED, __ATOMIC_SEQ_CST);
+    }
 }
 
-static void update_age_reset_ref(void) {
-    for (int i = 0; i < VMEM_NFRAMES; i++) {
-        //printf("vorher: frame %d age counter\t %d \n", i, age[i].age);
-        unsigned char new_age = (age[i].age >> 1);
-        if (age[i].page == VOID_IDX) {
+void break_cow(struct shard *sh, int asid, long page) {
+    struct pt_entry *pte = ((page >= 0) && (page < VMEM_NPAGES)) ? vmem_pte(vmem, asid, page) : NULL;
+    if ((pte == NULL) || !(pte_flags(pte) & PTF_PRESENT) || !(vmem->access_bits[pte_frame(pte)] & PTF_SHARED)) {
+        return; // sharing has been broken already
+    }
+    int shared = pte_frame(pte);
+    if ((sh->pinned_frames + 1 >= sh->nframes) && (find_unused_frame(sh) == VOID_IDX)) {
+        // the shared frame is the only one that may be replaced: the page leaves it and will be fetched again
+        hide_page(pte, shared);
+        int origin = write_back_page(sh, asid, page, shared, *mapping_origin(asid, page, shared));
+        ksm_detach(sh, asid, page, shared);
+        unmap_page(pte, asid, origin);
+        sh->cow_breaks++;
+        return;
+    }
+    // the shared frame is exempt from replacement meanwhile
+    long removedPage = VOID_IDX;
+    pin_count[shared]++;
+    sh->pinned_frames++;
+    int frame = take_frame(sh, asid, page, &removedPage);
+    pin_count[shared]--;
+    sh->pinned_frames--;
+
+    memcpy(&vmem->mainMemory[frame * VMEM_GEO_PAGESIZE], &vmem->mainMemory[shared * VMEM_GEO_PAGESIZE], VMEM_GEO_PAGESIZE);
+    // the backing copy of the page is as up to date as the shared frame
+    vmem->access_bits[frame] = vmem->access_bits[shared] & PTF_DIRTY;
+    vmem->dirty_sectors[frame] = vmem->dirty_sectors[shared];
+    page_checksum[frame] = page_checksum[shared];
+    age_counter[frame] = PAGEREP_AGE_FETCHED;
+    age[frame].page = page;
+    age[frame].asid = asid;
+    age[frame].origin = *mapping_origin(asid, page, shared); // may have been copied out by take_frame
+    count_resident(sh, asid, 1);
+    ksm_detach(sh, asid, page, shared);
+    pte_set(pte, frame, PTF_PRESENT);
+    __atomic_add_fetch(&vmem->adm->tlb_evict_epoch, 1, __ATOMIC_SEQ_CST); // TLB entries of the shared frame
+    sh->cow_breaks++;
+}
+
+void ksm_remove_sharers(struct shard *sh, int frame) {
+    while (sharers[frame] != NULL) {
+        struct sharer *s = sharers[frame];
+        struct pt_entry *pte = vmem_pte(vmem, s->asid, s->page);
+        hide_page(pte, frame);
+        unmap_page(pte, s->asid, write_back_page(sh, s->asid, s->page, frame, s->origin));
+        sharers[frame] = s->next;
+        free(s);
+        count_saved(sh, -1);
+    }
+}
+
+void fork_address_space(struct shard *sh, int parent, int child, long g_count) {
+    bool empty = (child >= 0) && (child < VMEM_NCLIENTS) && (child != parent) &&
+                 (vmem->header->clients[child].state == VMEM_CLIENT_ATTACHED);
+    for (int i = 0; empty && (i < vmem_geometry.pt_roots); i++) {
+        empty = (vmem->pt_root[(long) child * vmem_geometry.pt_roots + i] == 0);
+    }
+    TEST_AND_EXIT(!vmem->adm->fork_enabled || !empty,
+                  (stderr, "fork_address_space: address space %d cannot be cloned into %d\n", parent, child));
+    // pages that have never been written back refer to the same backing copies
+    clone_root[child] = clone_root[parent];
+    client_g_count[child] = g_count; // the clone continues with the g_count of its parent
+    forked = true;
+    for (long page = 0; page < VMEM_NPAGES; page++) {
+        struct pt_entry *pte = vmem_pte(vmem, parent, page);
+        if (pte == NULL) {
+            page |= PT_NODE_ENTRIES - 1; // range of leaf node refers to clone_root
+            continue;
+        }
+        if (!(pte_flags(pte) & PTF_PRESENT)) {
+            int origin = backing_origin(parent, page);
+            if (origin != clone_root[child]) {
+                unmap_page(vmem_pte_alloc(vmem, child, page), child, origin);
+            }
+            continue;
+        }
+        int frame = pte_frame(pte);
+        if (pin_count[frame] > 0) {
+            // a pinned frame stays private, the clone gets a backing copy of its own
+            struct pagefile_stats before;
+            backing_lock(&before);
+            write_backing(backing_page(child, page), &vmem->mainMemory[frame * VMEM_GEO_PAGESIZE]);
+            backing_unlock(sh, &before);
+            unmap_page(vmem_pte_alloc(vmem, child, page), child, child);
+            sh->fork_copies++;
+            continue;
+        }
+        struct sharer *s = malloc(sizeof(struct sharer));
+        TEST_AND_EXIT_ERRNO(s == NULL, "fork_address_space: malloc failed");
+        s->asid = child;
+        s->page = page;
+        s->origin = *mapping_origin(parent, page, frame);
+        s->next = sharers[frame];
+        sharers[frame] = s;
+        // the parent waits for the ACK, so it does not store into the frame meanwhile
+        __atomic_fetch_or(&vmem->access_bits[frame], PTF_SHARED, __ATOMIC_SEQ_CST);
+        pte_set(vmem_pte_alloc(vmem, child, page), frame, PTF_PRESENT);
+        sh->fork_shared++;
+        count_saved(sh, 1);
+    }
+    sh->forks++;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      These functions write a part of a checkpoint and read it back from the
+ *              mapped checkpoint.
+ *
+ *  @param      f File of the checkpoint
+ *  @param      pos Current position in the mapped checkpoint
+ *  @param      end End of the mapped checkpoint
+ *  @param      data Data of the part
+ *  @param      size Size of the part
+ *
+ *  @return     position following the part
+ ****************************************************************************************/
+static void write_part(FILE *f, const void *data, size_t size) {
+    TEST_AND_EXIT_ERRNO((size > 0) && (fwrite(data, size, 1, f) != 1), "write_checkpoint: fwrite failed");
+}
+
+static const unsigned char *read_part(const unsigned char *pos, const unsigned char *end, void *data, size_t size) {
+    TEST_AND_EXIT((size_t) (end - pos) < size, (stderr, "restore_checkpoint: %s is truncated\n", restore_name));
+    memcpy(data, pos, size);
+    return pos + size;
+}
+
+void write_checkpoint(void) {
+    struct checkpoint_header hdr;
+    FILE *f = fopen(checkpoint_name, "w");
+    TEST_AND_EXIT_ERRNO(f == NULL, "write_checkpoint: cannot create checkpoint");
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, CHECKPOINT_MAGIC, sizeof(hdr.magic));
+    hdr.version = CHECKPOINT_VERSION;
+    hdr.pagesize = VMEM_GEO_PAGESIZE;
+    hdr.virtmemsize = VMEM_VIRTMEMSIZE;
+    hdr.physmemsize = VMEM_PHYSMEMSIZE;
+    hdr.nclients = VMEM_NCLIENTS;
+    hdr.hugepages = VMEM_HUGEPAGES;
+    hdr.nshards = nshards;
+    hdr.forked = forked;
+    hdr.pf_count = pf_count;
+    hdr.last_g_count = last_g_count;
+    for (int frame = 0; (sharers != NULL) && (frame < VMEM_NFRAMES); frame++) {
+        for (struct sharer *s = sharers[frame]; s != NULL; s = s->next) {
+            hdr.nsharers++;
+        }
+    }
+    memcpy(hdr.client_g_count, client_g_count, sizeof(client_g_count));
+    memcpy(hdr.client_rss, client_rss, sizeof(client_rss));
+    memcpy(hdr.clone_root, clone_root, sizeof(clone_root));
+    write_part(f, &hdr, sizeof(hdr));
+
+    for (int i = 0; i < nshards; i++) {
+        struct checkpoint_shard cs;
+        memset(&cs, 0, sizeof(cs));
+        cs.frame_counter = shards[i].rep.hand;
+        cs.pinned_frames = shards[i].pinned_frames;
+        cs.huge_frames = shards[i].huge_frames;
+        cs.frames_saved = shards[i].frames_saved;
+        for (int asid = 0; asid < VMEM_NCLIENTS; asid++) {
+            cs.rss[asid] = shards[i].clients[asid].rss;
+            cs.pinned[asid] = shards[i].clients[asid].pinned;
+        }
+        write_part(f, &cs, sizeof(cs));
+    }
+    write_part(f, age, VMEM_NFRAMES * sizeof(struct age));
+    write_part(f, age_counter, VMEM_NFRAMES * sizeof(unsigned char));
+    write_part(f, is_used, VMEM_NFRAMES * sizeof(bool));
+    write_part(f, page_checksum, VMEM_NFRAMES * sizeof(uint64_t));
+    write_part(f, pin_count, VMEM_NFRAMES * sizeof(int));
+    write_part(f, huge_frame, VMEM_NFRAMES * sizeof(int));
+    write_part(f, fill_page, VMEM_NFRAMES * sizeof(bool));
+    for (int frame = 0; (sharers != NULL) && (frame < VMEM_NFRAMES); frame++) {
+        for (struct sharer *s = sharers[frame]; s != NULL; s = s->next) {
+            struct checkpoint_sharer cs = { frame, s->asid, s->page, s->origin };
+            write_part(f, &cs, sizeof(cs));
+        }
+    }
+
+    // shared memory up to the node pools and the nodes taken from the pools
+    write_part(f, vmem->header, vmem_shm_size(false));
+    write_part(f, vmem->pt_mid, (size_t) vmem->adm->pt_mids * PT_NODE_ENTRIES * sizeof(int));
+    write_part(f, vmem->pt_leaf, (size_t) vmem->adm->pt_leaves * PT_NODE_ENTRIES * sizeof(struct pt_entry));
+    checkpoint_pagefile(f);
+
+    checkpoint_bytes = ftell(f);
+    TEST_AND_EXIT_ERRNO(fclose(f) == EOF, "write_checkpoint: fclose failed");
+    checkpoints++;
+}
+
+void restore_checkpoint(void) {
+    struct checkpoint_header hdr;
+    struct stat st;
+    int fd = open(restore_name, O_RDONLY);
+    TEST_AND_EXIT_ERRNO(fd == -1, "restore_checkpoint: cannot open checkpoint");
+    TEST_AND_EXIT_ERRNO(fstat(fd, &st) == -1, "restore_checkpoint: fstat failed");
+    TEST_AND_EXIT((size_t) st.st_size < sizeof(hdr), (stderr, "restore_checkpoint: %s is truncated\n", restore_name));
+    const unsigned char *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    TEST_AND_EXIT_ERRNO(data == MAP_FAILED, "restore_checkpoint: mmap failed");
+    close(fd);
+    const unsigned char *end = data + st.st_size;
+
+    const unsigned char *pos = read_part(data, end, &hdr, sizeof(hdr));
+    TEST_AND_EXIT((memcmp(hdr.magic, CHECKPOINT_MAGIC, sizeof(hdr.magic)) != 0) || (hdr.version != CHECKPOINT_VERSION),
+                  (stderr, "restore_checkpoint: %s is not a checkpoint of this version\n", restore_name));
+    TEST_AND_EXIT((hdr.pagesize != VMEM_GEO_PAGESIZE) || (hdr.virtmemsize != VMEM_VIRTMEMSIZE) || (hdr.physmemsize != VMEM_PHYSMEMSIZE) ||
+                  (hdr.nclients != VMEM_NCLIENTS) || (hdr.hugepages != VMEM_HUGEPAGES) || (hdr.nshards != nshards),
+                  (stderr, "restore_checkpoint: %s has been written with another geometry\n", restore_name));
+    pf_count = hdr.pf_count;
+    last_g_count = hdr.last_g_count;
+    forked = hdr.forked;
+    memcpy(client_g_count, hdr.client_g_count, sizeof(client_g_count));
+    memcpy(client_rss, hdr.client_rss, sizeof(client_rss));
+    memcpy(client_rss_max, hdr.client_rss, sizeof(client_rss_max));
+    memcpy(clone_root, hdr.clone_root, sizeof(clone_root));
+
+    for (int i = 0; i < nshards; i++) {
+        struct checkpoint_shard cs;
+        pos = read_part(pos, end, &cs, sizeof(cs));
+        shards[i].rep.hand = cs.frame_counter;
+        shards[i].pinned_frames = cs.pinned_frames;
+        shards[i].huge_frames = cs.huge_frames;
+        shards[i].frames_saved = cs.frames_saved;
+        shards[i].frames_saved_max = cs.frames_saved;
+        for (int asid = 0; asid < VMEM_NCLIENTS; asid++) {
+            shards[i].clients[asid].rss = cs.rss[asid];
+            shards[i].clients[asid].pinned = cs.pinned[asid];
+        }
+    }
+    pos = read_part(pos, end, age, VMEM_NFRAMES * sizeof(struct age));
+    pos = read_part(pos, end, age_counter, VMEM_NFRAMES * sizeof(unsigned char));
+    pos = read_part(pos, end, is_used, VMEM_NFRAMES * sizeof(bool));
+    pos = read_part(pos, end, page_checksum, VMEM_NFRAMES * sizeof(uint64_t));
+    pos = read_part(pos, end, pin_count, VMEM_NFRAMES * sizeof(int));
+    pos = read_part(pos, end, huge_frame, VMEM_NFRAMES * sizeof(int));
+    pos = read_part(pos, end, fill_page, VMEM_NFRAMES * sizeof(bool));
+    TEST_AND_EXIT((hdr.nsharers > 0) && (sharers == NULL),
+                  (stderr, "restore_checkpoint: %s has shared frames, they require -ksm or a second client\n", restore_name));
+    for (int i = 0; i < hdr.nsharers; i++) {
+        struct checkpoint_sharer cs;
+        pos = read_part(pos, end, &cs, sizeof(cs));
+        TEST_AND_EXIT((cs.frame < 0) || (cs.frame >= VMEM_NFRAMES), (stderr, "restore_checkpoint: invalid sharer\n"));
+        struct sharer **p = &sharers[cs.frame];
+        while (*p != NULL) {
+            p = &(*p)->next; // keep the order of the sharers
+        }
+        *p = malloc(sizeof(struct sharer));
+        TEST_AND_EXIT_ERRNO(*p == NULL, "restore_checkpoint: malloc failed");
+        (*p)->asid = cs.asid;
+        (*p)->page = cs.page;
+        (*p)->origin = cs.origin;
+        (*p)->next = NULL;
+    }
+
+    int fork_enabled = vmem->adm->fork_enabled;
+    pos = read_part(pos, end, vmem->header, vmem_shm_size(false));
+    pos = read_part(pos, end, vmem->pt_mid, (size_t) vmem->adm->pt_mids * PT_NODE_ENTRIES * sizeof(int));
+    pos = read_part(pos, end, vmem->pt_leaf, (size_t) vmem->adm->pt_leaves * PT_NODE_ENTRIES * sizeof(struct pt_entry));
+    vmem->adm->fork_enabled = fork_enabled;
+    memset(vmem->busy, 0, VMEM_NFRAMES * sizeof(int));
+    for (int asid = 0; asid < VMEM_NCLIENTS; asid++) {
+        // the address spaces are taken over by the next clients
+        memset(&vmem->header->clients[asid], 0, sizeof(struct vmem_client));
+        vmem->header->clients[asid].state = VMEM_CLIENT_FREE;
+        vmem->header->clients[asid].g_count = client_g_count[asid];
+    }
+    pos += restore_pagefile(pos, end - pos);
+    TEST_AND_EXIT(pos != end, (stderr, "restore_checkpoint: %s has trailing data\n", restore_name));
+    restored_bytes = st.st_size;
+    TEST_AND_EXIT_ERRNO(munmap((void *) data, st.st_size) == -1, "restore_checkpoint: munmap failed");
+}
+
+void serve_request(struct shard *sh, struct msg m) {
+    sh->requests++;
+    //printf("\n\n\n\n\naaaaaaaaa\nm.cmd: %d\n", m.cmd);
+    switch(m.cmd){
+        case CMD_PAGEFAULT: {
+            struct pt_entry *pte = ((m.value >= 0) && (m.value < VMEM_NPAGES)) ? vmem_pte(vmem, m.client, m.value) : NULL;
+            struct client_stats *c = &sh->clients[m.client];
+            if ((pte != NULL) && (pte_flags(pte) & PTF_PRESENT)) {
+                // concurrent request of another thread has fetched the page already
+                sh->duplicate_faults++;
+                break;
+            }
+            int pending = countPendingMsgs() + __atomic_load_n(&in_service, __ATOMIC_RELAXED);
+            sh->pending_sum += pending;
+            if (pending > sh->pending_max) {
+                sh->pending_max = pending;
+            }
+            double io_time_ns = sh->io_time_ns;
+            allocate_page(sh, m.client, m.value, m.g_count);
+            if (VMEM_HUGEPAGES > 0) {
+                promote_sequential(sh, m.client, m.value);
+            }
+            double t = fault_ns + sh->io_time_ns - io_time_ns;
+            sh->fault_time_ns += t;
+            c->fault_time_ns += t;
+            if (t > c->fault_time_max_ns) {
+                c->fault_time_max_ns = t;
+            }
+            // outstanding requests are served with overlapping I/O
+            sh->exposed_time_ns += t / pending;
+            if (t > sh->fault_time_max_ns) {
+                sh->fault_time_max_ns = t;
+            }
+            break;
+        }
+        case CMD_PIN:
+            pin_page(sh, m.client, m.value, m.g_count);
+            break;
+        case CMD_UNPIN:
+            unpin_page(sh, m.client, m.value);
+            break;
+        case CMD_COW:
+            break_cow(sh, m.client, m.value);
             break;
+        case CMD_FORK:
+            fork_address_space(sh, m.client, m.value, m.g_count);
+            break;
+        case CMD_CHECKPOINT:
+            if (checkpoint_name != NULL) {
+                write_checkpoint();
+            }
+            break;
+        case CMD_TIME_INTER_VAL:
+            sh->intervals++;
+            if ((VMEM_HUGEPAGES > 0) && (sh->intervals % HUGE_HOT_INTERVAL == 0)) {
+                promote_hot(sh); // before aging resets the Ref bits
+            }
+            pagerep_interval(&sh->rep);
+            if ((ksm_interval > 0) && (sh->intervals % ksm_interval == 0)) {
+                ksm_scan(sh);
+            }
+            break;
+        default:
+            TEST_AND_EXIT(true, (stderr, "Unexpected command received from vmapp\n"));
+    }
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function maps a page to its shard. The pages are spread by a 
+ *              multiplicative hash, so neighboring pages are served by different shards.
+ *
+ *  @param      asid Address space of page
+ *  @param      page Number of page
+ *
+ *  @return     shard of page
+ ****************************************************************************************/
+static struct shard *shard_of(int asid, long page) {
+    if ((page < 0) || (page >= VMEM_NPAGES)) {
+        return &shards[0]; // will be rejected
+    }
+    uint64_t hash = (uint64_t) backing_page(asid, page) * 0x9E3779B97F4A7C15ULL;
+    return &shards[(hash >> 32) % nshards];
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function appends a request to the queue of a shard.
+ *
+ *  @param      sh Shard
+ *  @param      m Request
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void enqueue_request(struct shard *sh, struct msg m) {
+    pthread_mutex_lock(&sh->mutex);
+    TEST_AND_EXIT(sh->count == SHARD_QUEUE_LEN, (stderr, "enqueue_request: queue of shard %d is full\n", sh->id));
+    sh->queue[(sh->head + sh->count) % SHARD_QUEUE_LEN] = m;
+    if (++sh->count > sh->count_max) {
+        sh->count_max = sh->count;
+    }
+    pthread_cond_signal(&sh->cond);
+    pthread_mutex_unlock(&sh->mutex);
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function is the worker thread of a shard. It serves the requests
+ *              of the queue of the shard in order.
+ *
+ *  @param      arg Shard
+ *
+ *  @return     never returns
+ ****************************************************************************************/
+static void *shard_worker(void *arg) {
+    struct shard *sh = arg;
+    while (true) {
+        pthread_mutex_lock(&sh->mutex);
+        while (sh->count == 0) {
+            pthread_cond_wait(&sh->cond, &sh->mutex);
+        }
+        struct msg m = sh->queue[sh->head];
+        sh->head = (sh->head + 1) % SHARD_QUEUE_LEN;
+        sh->count--;
+        pthread_mutex_unlock(&sh->mutex);
+
+        serve_request(sh, m);
+        if (__atomic_sub_fetch(&ack_pending[m.client * SYNC_NSLOTS + m.slot], 1, __ATOMIC_SEQ_CST) == 0) {
+            __atomic_sub_fetch(&in_service, 1, __ATOMIC_SEQ_CST);
+            sendAckOfMsg(m);
+        }
+    }
+    return NULL;
+}
+
+void dispatch_request(struct msg m) {
+    int *pending = &ack_pending[m.client * SYNC_NSLOTS + m.slot];
+    __atomic_add_fetch(&in_service, 1, __ATOMIC_SEQ_CST);
+    if (m.cmd == CMD_TIME_INTER_VAL) {
+        __atomic_store_n(pending, nshards, __ATOMIC_SEQ_CST);
+        for (int i = 0; i < nshards; i++) {
+            enqueue_request(&shards[i], m);
+        }
+    } else {
+        __atomic_store_n(pending, 1, __ATOMIC_SEQ_CST);
+        enqueue_request(shard_of(m.client, m.value), m);
+    }
+}
+
+void init_shards(void) {
+    sigset_t mask;
+    sigset_t old_mask;
+
+    for (int i = 0; i < nshards; i++) {
+        struct shard *sh = &shards[i];
+        sh->id = i;
+        sh->first_frame = (int) ((long) i * VMEM_NFRAMES / nshards);
+        sh->nframes = (int) ((long) (i + 1) * VMEM_NFRAMES / nshards) - sh->first_frame;
+        pagerep_init(&sh->rep, rep_algo, sh->first_frame, sh->nframes, age_counter, &rep_ops, sh);
+        sh->victim_asid = VOID_IDX;
+        sh->frame_quota = sh->nframes / VMEM_NCLIENTS;
+        sh->max_pinned = (int) ((long) max_pinned * sh->nframes / VMEM_NFRAMES);
+        sh->scratch = malloc(VMEM_GEO_PAGESIZE);
+        TEST_AND_EXIT_ERRNO(!sh->scratch, "Error allocating buffer of shard");
+    }
+    if (!sharded) {
+        return;
+    }
+    // signals are handled by the main thread
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGUSR2);
+    TEST_AND_EXIT(pthread_sigmask(SIG_BLOCK, &mask, &old_mask) != 0, (stderr, "init_shards: pthread_sigmask failed\n"));
+    for (int i = 0; i < nshards; i++) {
+        struct shard *sh = &shards[i];
+        TEST_AND_EXIT(pthread_mutex_init(&sh->mutex, NULL) != 0, (stderr, "init_shards: pthread_mutex_init failed\n"));
+        TEST_AND_EXIT(pthread_cond_init(&sh->cond, NULL) != 0, (stderr, "init_shards: pthread_cond_init failed\n"));
+        TEST_AND_EXIT(pthread_create(&sh->thread, NULL, shard_worker, sh) != 0, (stderr, "init_shards: pthread_create failed\n"));
+    }
+    TEST_AND_EXIT(pthread_sigmask(SIG_SETMASK, &old_mask, NULL) != 0, (stderr, "init_shards: pthread_sigmask failed\n"));
+}
+
+void init_livestats(void) {
+    sigset_t mask;
+    sigset_t old_mask;
+    pthread_t thread;
+
+    livestats = livestats_create(rep_algo);
+    live = &livestats->server;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGUSR2);
+    TEST_AND_EXIT(pthread_sigmask(SIG_BLOCK, &mask, &old_mask) != 0, (stderr, "init_livestats: pthread_sigmask failed\n"));
+    TEST_AND_EXIT(pthread_create(&thread, NULL, sample_livestats, NULL) != 0, (stderr, "init_livestats: pthread_create failed\n"));
+    TEST_AND_EXIT(pthread_sigmask(SIG_SETMASK, &old_mask, NULL) != 0, (stderr, "init_livestats: pthread_sigmask failed\n"));
+}
+
+void *sample_livestats(void *arg) {
+    while (true) {
+        int resident = 0;
+        int dirty = 0;
+        for (int i = 0; i < VMEM_NCLIENTS; i++) {
+            resident += __atomic_load_n(&client_rss[i], __ATOMIC_RELAXED);
         }
-        
-        if (vmem->pt[age[i].page].flags & PTF_REF) {
-            vmem->pt[age[i].page].flags &= (~PTF_REF);
-            new_age |= (0x01 << 7);
+        for (int i = 0; i < VMEM_NFRAMES; i++) {
+            dirty += (__atomic_load_n(&vmem->access_bits[i], __ATOMIC_RELAXED) & PTF_DIRTY) != 0;
         }
-        age[i].age = new_age;
-        //printf("frame %d age counter\t %d \n", i, age[i].age);
+        __atomic_store_n(&live->resident_frames, resident, __ATOMIC_RELAXED);
+        __atomic_store_n(&live->dirty_frames, dirty, __ATOMIC_RELAXED);
+        usleep(LIVESTATS_SAMPLE_MS * 1000);
     }
+    return NULL;
 }
 
 // EOF
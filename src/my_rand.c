@@ -24,4 +24,19 @@ int32_t my_rand(void){
    return x_n;
 }
 
+void my_rand_skip(uint64_t n){
+   // x_n+1 = (a * x_n + c) mod m, the step is composed by squaring
+   uint64_t a = A, c = C;
+   uint64_t x = (uint32_t) x_n;
+   while (n > 0) {
+      if (n & 1) {
+         x = (a * x + c) % M;
+      }
+      c = ((a + 1) * c) % M;
+      a = (a * a) % M;
+      n >>= 1;
+   }
+   x_n = x;
+}
+
 // EOF
@@ -28,5 +28,10 @@ extern void my_srand(int32_t seed);
   */
 extern int32_t my_rand(void);
 
+/**
+  * @brief Skips the next n random numbers in O(log n) steps
+  */
+extern void my_rand_skip(uint64_t n);
+
 // EOF
 
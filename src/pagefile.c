@@ -10,7 +10,9 @@
   */
 
 #include <errno.h>
+#include <stdlib.h>
 #include <limits.h>
+#include <string.h>
 #include "error.h"
 #include "vmem.h"
 #include "my_rand.h"
@@ -20,48 +22,285 @@
 #define SEED_PF        070514           //!< Get reproducable pseudo-random numbers to init pagefile
 
 static FILE *pagefile = NULL;           //!< Reference to pagefile
+static struct pagefile_cost cost = { .next_offset = -1 }; //!< I/O statistics of the cost model
+
+/**
+ * Pages that have been written to the pagefile. The bitmap is divided into chunks
+ * that will be allocated on the first write to one of their pages. Like the page 
+ * table, the chunks are referred to by mid nodes allocated on the first write to 
+ * their range, so the bitmap uses memory in proportion to the pages written.
+ */
+#define PF_CHUNK_PAGES  4096                                      //!< pages per chunk of the bitmap
+#define PF_MID_CHUNKS   1024                                      //!< chunks per mid node
+#define PF_MID_PAGES    ((long) PF_CHUNK_PAGES * PF_MID_CHUNKS)   //!< pages per mid node
+static uint64_t ***written = NULL;      //!< mid nodes of the chunks of the bitmap; NULL: no page of mid node or chunk written
+static unsigned char *page_buf = NULL;  //!< scratch page; the pagefile is serialized by its caller
+
+/**
+ * Presets of the storage cost model
+ */
+static const struct storage_cost storage_presets[] = {
+    // name     seek       read     r/byte  write    w/byte
+    { "hdd",  8000000.0, 100000.0,  6.67, 100000.0,  6.67 }, // 7200 rpm disk, 150 MB/s
+    { "ssd",        0.0,  80000.0,  1.82, 200000.0,  2.00 }, // SATA SSD, 550 / 500 MB/s
+    { "nvme",       0.0,  20000.0,  0.29,  30000.0,  0.33 }, // NVMe SSD, 3.5 / 3 GB/s
+};
+
+static const struct storage_cost *storage = &storage_presets[1]; //!< cost model in use
+
+void account_pagefile_io(struct pagefile_cost *c, const struct storage_cost *dev, long offset, int nbytes, bool write) {
+    if (offset != c->next_offset) {
+        c->stats.seeks++;
+        c->stats.io_time_ns += dev->seek_ns;
+    }
+    c->next_offset = offset + nbytes;
+    if (write) {
+        c->stats.writes++;
+        c->stats.bytes_written += nbytes;
+        c->stats.io_time_ns += dev->write_ns + nbytes * dev->write_byte_ns;
+    } else {
+        c->stats.reads++;
+        c->stats.bytes_read += nbytes;
+        c->stats.io_time_ns += dev->read_ns + nbytes * dev->read_byte_ns;
+    }
+}
+
+bool set_pagefile_storage(const char *name) {
+    for (int i = 0; i < sizeof(storage_presets) / sizeof(storage_presets[0]); i++) {
+        if (0 == strcasecmp(name, storage_presets[i].name)) {
+            storage = &storage_presets[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+const struct storage_cost *get_pagefile_storage(void) {
+    return storage;
+}
 
 void init_pagefile(void) {
-    int i;
     /* Always generate a new file. 
        Otherwise: Run into problem if sizes change */
     pagefile = fopen(MMANAGE_PFNAME, "w+");
     TEST_AND_EXIT_ERRNO(!pagefile, "Error creating pagefile with w+");
+    written = calloc((VMEM_NBACKING_PAGES + PF_MID_PAGES - 1) / PF_MID_PAGES, sizeof(uint64_t **));
+    TEST_AND_EXIT_ERRNO(!written, "Error allocating bitmap of pagefile");
+    page_buf = malloc(VMEM_GEO_PAGESIZE); // a page may be too large for the stack
+    TEST_AND_EXIT_ERRNO(!page_buf, "Error allocating buffer of pagefile");
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the chunk of the bitmap holding the bit of a page.
+ *
+ *  @param      pageNo Number of the page
+ *  @param      create true: allocate the mid node and the chunk, if required
+ *
+ *  @return     chunk; NULL, if create is false and no page of the chunk has been written
+ ****************************************************************************************/
+static uint64_t *written_chunk(long pageNo, bool create) {
+    uint64_t ***mid = &written[pageNo / PF_MID_PAGES];
+    if (*mid == NULL) {
+        if (!create) {
+            return NULL;
+        }
+        *mid = calloc(PF_MID_CHUNKS, sizeof(uint64_t *));
+        TEST_AND_EXIT_ERRNO(!*mid, "Error allocating bitmap of pagefile");
+    }
+    uint64_t **chunk = &(*mid)[(pageNo / PF_CHUNK_PAGES) % PF_MID_CHUNKS];
+    if ((*chunk == NULL) && create) {
+        *chunk = calloc(PF_CHUNK_PAGES / 64, sizeof(uint64_t));
+        TEST_AND_EXIT_ERRNO(!*chunk, "Error allocating bitmap of pagefile");
+    }
+    return *chunk;
+}
 
+static bool page_written(long pageNo) {
+    uint64_t *chunk = written_chunk(pageNo, false);
+    int bit = pageNo % PF_CHUNK_PAGES;
+    return (chunk != NULL) && (chunk[bit / 64] & ((uint64_t) 1 << (bit % 64)));
+}
+
+static void mark_written(long pageNo) {
+    uint64_t *chunk = written_chunk(pageNo, true);
+    int bit = pageNo % PF_CHUNK_PAGES;
+    chunk[bit / 64] |= (uint64_t) 1 << (bit % 64);
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function computes the initial contents of a page. These are the 
+ *              bytes pageNo * VMEM_GEO_PAGESIZE ... of the random sequence of SEED_PF.
+ *
+ *  @param      pageNo Number of the page
+ *  @param      buf Buffer of VMEM_GEO_PAGESIZE bytes
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void initial_contents(long pageNo, unsigned char *buf) {
     my_srand(SEED_PF);
+    my_rand_skip((uint64_t) pageNo * VMEM_GEO_PAGESIZE);
+    for (int i = 0; i < VMEM_GEO_PAGESIZE; i++) {
+        buf[i] = my_rand() % (UCHAR_MAX + 1);
+    }
+}
 
-    for(i = 0; i < (VMEM_PAGESIZE * VMEM_NPAGES * sizeof(unsigned char)); i++) {
-        unsigned char rndval = my_rand() % (UCHAR_MAX + 1);
-        fwrite(&rndval, 1, 1, pagefile);
+/**
+ *****************************************************************************************
+ *  @brief      This function writes the initial contents of a page to the pagefile, 
+ *              if the page has never been written. This is not accounted, since the 
+ *              cost model assumes a pagefile that has been initialized completely.
+ *
+ *  @param      pageNo Number of the page
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void materialize_page(long pageNo) {
+    if (page_written(pageNo)) {
+        return;
     }
+    initial_contents(pageNo, page_buf);
+    TEST_AND_EXIT_ERRNO(fseeko(pagefile, pageNo * VMEM_GEO_PAGESIZE, SEEK_SET) == -1, "Positioning in pagefile failed! ");
+    TEST_AND_EXIT_ERRNO(fwrite(page_buf, sizeof(unsigned char), VMEM_GEO_PAGESIZE, pagefile) != VMEM_GEO_PAGESIZE, "Error writing page to disk");
+    mark_written(pageNo);
 }
 
-void fetch_page_from_pagefile(int pageNo, unsigned char *frame_start) {
+void fetch_page_from_pagefile(long pageNo, unsigned char *frame_start) {
     // check page pageNo
     TEST_AND_EXIT(pageNo <  0,           (stderr, "find_page: pageNo out of range\n"));
-    TEST_AND_EXIT(pageNo >= VMEM_NPAGES, (stderr, "find_page: pageNo out of range\n"));
+    TEST_AND_EXIT(pageNo >= VMEM_NBACKING_PAGES, (stderr, "find_page: pageNo out of range\n"));
     
-    int offset = pageNo * sizeof(unsigned char) * VMEM_PAGESIZE;
+    long offset = pageNo * VMEM_GEO_PAGESIZE;
 
-    TEST_AND_EXIT_ERRNO(fseek(pagefile, offset, SEEK_SET) == -1, "Positioning in pagefile failed!");
-    TEST_AND_EXIT_ERRNO(fread(frame_start, sizeof(unsigned char), VMEM_PAGESIZE, pagefile) != VMEM_PAGESIZE, "Error reading page from disk");
+    if (page_written(pageNo)) {
+        TEST_AND_EXIT_ERRNO(fseeko(pagefile, offset, SEEK_SET) == -1, "Positioning in pagefile failed!");
+        TEST_AND_EXIT_ERRNO(fread(frame_start, sizeof(unsigned char), VMEM_GEO_PAGESIZE, pagefile) != VMEM_GEO_PAGESIZE, "Error reading page from disk");
+    } else {
+        initial_contents(pageNo, frame_start); // hole of the sparse pagefile
+    }
+    account_pagefile_io(&cost, storage, offset, VMEM_GEO_PAGESIZE, false);
 }
 
-void store_page_to_pagefile(int pageNo, unsigned char *frame_start) {
+void store_page_to_pagefile(long pageNo, unsigned char *frame_start) {
     // check pageNo
     TEST_AND_EXIT(pageNo <  0,           (stderr, "store_page: pageNo out of range\n"));
-    TEST_AND_EXIT(pageNo >= VMEM_NPAGES, (stderr, "store_page: pageNo out of range\n"));
+    TEST_AND_EXIT(pageNo >= VMEM_NBACKING_PAGES, (stderr, "store_page: pageNo out of range\n"));
+
+
+    long offset = pageNo * VMEM_GEO_PAGESIZE;
+
+    TEST_AND_EXIT_ERRNO(fseeko(pagefile, offset, SEEK_SET) == -1, "Positioning in pagefile failed! ");
+    TEST_AND_EXIT_ERRNO(fwrite(frame_start, sizeof(unsigned char), VMEM_GEO_PAGESIZE, pagefile) != VMEM_GEO_PAGESIZE, "Error writing page to disk");
+    mark_written(pageNo);
+    account_pagefile_io(&cost, storage, offset, VMEM_GEO_PAGESIZE, true);
+}
+
+void store_sectors_to_pagefile(long pageNo, unsigned char *frame_start, uint64_t dirty_sectors) {
+    // check pageNo
+    TEST_AND_EXIT(pageNo <  0,           (stderr, "store_sectors: pageNo out of range\n"));
+    TEST_AND_EXIT(pageNo >= VMEM_NBACKING_PAGES, (stderr, "store_sectors: pageNo out of range\n"));
+
+    int sector = 0;
+    materialize_page(pageNo); // clean sectors must be valid in pagefile
+    while (sector < VMEM_NSECTORS) {
+        if (!(dirty_sectors & ((uint64_t) 1 << sector))) {
+            sector++;
+            continue;
+        }
+        // coalesce adjacent dirty sectors
+        int first = sector;
+        while ((sector < VMEM_NSECTORS) && (dirty_sectors & ((uint64_t) 1 << sector))) {
+            sector++;
+        }
+        int start = first * VMEM_GEO_SECTORSIZE;
+        int end = sector * VMEM_GEO_SECTORSIZE;
+        if (end > VMEM_GEO_PAGESIZE) {
+            end = VMEM_GEO_PAGESIZE;
+        }
+        long offset = pageNo * VMEM_GEO_PAGESIZE + start;
+
+        TEST_AND_EXIT_ERRNO(fseeko(pagefile, offset, SEEK_SET) == -1, "Positioning in pagefile failed! ");
+        TEST_AND_EXIT_ERRNO(fwrite(frame_start + start, sizeof(unsigned char), end - start, pagefile) != (size_t) (end - start), "Error writing sectors to disk");
+        account_pagefile_io(&cost, storage, offset, end - start, true);
+    }
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function finds the next page that has been written to the pagefile.
+ *              Unused mid nodes and chunks of the bitmap are skipped as a whole.
+ *
+ *  @param      pageNo Number of the first page to be checked
+ *
+ *  @return     Number of the page; VMEM_NBACKING_PAGES, if no further page has been written
+ ****************************************************************************************/
+static long next_written(long pageNo) {
+    while (pageNo < VMEM_NBACKING_PAGES) {
+        if (written[pageNo / PF_MID_PAGES] == NULL) {
+            pageNo = (pageNo / PF_MID_PAGES + 1) * PF_MID_PAGES; // no page of mid node written
+            continue;
+        }
+        uint64_t *chunk = written_chunk(pageNo, false);
+        if (chunk == NULL) {
+            pageNo = (pageNo / PF_CHUNK_PAGES + 1) * PF_CHUNK_PAGES; // no page of chunk written
+            continue;
+        }
+        int bit = pageNo % PF_CHUNK_PAGES;
+        uint64_t word = chunk[bit / 64] >> (bit % 64);
+        if (word != 0) {
+            pageNo += __builtin_ctzll(word);
+            break;
+        }
+        pageNo += 64 - bit % 64; // next word
+    }
+    return (pageNo < VMEM_NBACKING_PAGES) ? pageNo : VMEM_NBACKING_PAGES;
+}
 
+void checkpoint_pagefile(FILE *out) {
+    long npages = 0;
 
-    int offset = pageNo * sizeof(unsigned char) * VMEM_PAGESIZE;
+    for (long pageNo = next_written(0); pageNo < VMEM_NBACKING_PAGES; pageNo = next_written(pageNo + 1)) {
+        npages++;
+    }
+    TEST_AND_EXIT_ERRNO(fwrite(&npages, sizeof(npages), 1, out) != 1, "Error writing checkpoint of pagefile");
+    for (long pageNo = next_written(0); pageNo < VMEM_NBACKING_PAGES; pageNo = next_written(pageNo + 1)) {
+        TEST_AND_EXIT_ERRNO(fseeko(pagefile, pageNo * VMEM_GEO_PAGESIZE, SEEK_SET) == -1, "Positioning in pagefile failed!");
+        TEST_AND_EXIT_ERRNO(fread(page_buf, sizeof(unsigned char), VMEM_GEO_PAGESIZE, pagefile) != VMEM_GEO_PAGESIZE, "Error reading page from disk");
+        TEST_AND_EXIT_ERRNO(fwrite(&pageNo, sizeof(pageNo), 1, out) != 1, "Error writing checkpoint of pagefile");
+        TEST_AND_EXIT_ERRNO(fwrite(page_buf, sizeof(unsigned char), VMEM_GEO_PAGESIZE, out) != VMEM_GEO_PAGESIZE, "Error writing checkpoint of pagefile");
+    }
+}
+
+size_t restore_pagefile(const unsigned char *data, size_t size) {
+    long npages = 0;
+    size_t record = sizeof(long) + VMEM_GEO_PAGESIZE;
+
+    TEST_AND_EXIT(size < sizeof(npages), (stderr, "restore_pagefile: checkpoint truncated\n"));
+    memcpy(&npages, data, sizeof(npages));
+    TEST_AND_EXIT((npages < 0) || (npages > VMEM_NBACKING_PAGES) || (size - sizeof(npages) < npages * record),
+                  (stderr, "restore_pagefile: checkpoint truncated\n"));
+    for (long i = 0; i < npages; i++) {
+        const unsigned char *p = data + sizeof(npages) + i * record;
+        long pageNo;
+        memcpy(&pageNo, p, sizeof(pageNo));
+        TEST_AND_EXIT((pageNo < 0) || (pageNo >= VMEM_NBACKING_PAGES), (stderr, "restore_pagefile: pageNo out of range\n"));
+        TEST_AND_EXIT_ERRNO(fseeko(pagefile, pageNo * VMEM_GEO_PAGESIZE, SEEK_SET) == -1, "Positioning in pagefile failed! ");
+        TEST_AND_EXIT_ERRNO(fwrite(p + sizeof(pageNo), sizeof(unsigned char), VMEM_GEO_PAGESIZE, pagefile) != VMEM_GEO_PAGESIZE, "Error writing page to disk");
+        mark_written(pageNo);
+    }
+    return sizeof(npages) + npages * record;
+}
 
-    TEST_AND_EXIT_ERRNO(fseek(pagefile, offset, SEEK_SET) == -1, "Positioning in pagefile failed! ");
-    TEST_AND_EXIT_ERRNO(fwrite(frame_start, sizeof(unsigned char), VMEM_PAGESIZE, pagefile) != VMEM_PAGESIZE, "Error writing page to disk");
+void get_pagefile_stats(struct pagefile_stats *s) {
+    *s = cost.stats;
 }
 
 
 void cleanup_pagefile(void) {
     TEST_AND_EXIT_ERRNO(fclose(pagefile) == -1, "fclose in cleanup_pagefile failed! ")
+    free(page_buf);
+    page_buf = NULL;
 }
 
 // EOF
@@ -8,9 +8,72 @@
 #ifndef PAGEFILE_H
 #define PAGEFILE_H
 
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * I/O statistics of the pagefile
+ */
+struct pagefile_stats {
+    long reads;          //!< number of read operations
+    long writes;         //!< number of write operations
+    long bytes_read;     //!< number of bytes read from pagefile
+    long bytes_written;  //!< number of bytes written to pagefile
+    long seeks;          //!< number of non sequential operations
+    double io_time_ns;   //!< modeled time of all operations in ns
+};
+
+/**
+ * Cost model of the storage device holding the pagefile. 
+ * An operation costs its latency, the seek time if it does not continue the 
+ * previous operation and the transfer time of its bytes.
+ */
+struct storage_cost {
+    const char *name;        //!< name of preset
+    double seek_ns;          //!< positioning time of a non sequential operation
+    double read_ns;          //!< latency of a read operation
+    double read_byte_ns;     //!< transfer time of one byte read
+    double write_ns;         //!< latency of a write operation
+    double write_byte_ns;    //!< transfer time of one byte written
+};
+
+/**
+ * State of the cost model: statistics and position following the previous operation,
+ * used to detect sequential access
+ */
+struct pagefile_cost {
+    struct pagefile_stats stats; //!< statistics of the operations accounted
+    long next_offset;            //!< offset following the previous operation; -1: none
+};
+
+/**
+ *****************************************************************************************
+ *  @brief      This function accounts an operation by the cost model of a storage 
+ *              device. The pagefile accounts its operations by this function, the 
+ *              trace driven simulator accounts the operations of its modeled pagefiles.
+ *
+ *  @param      c State of the cost model
+ *
+ *  @param      dev Cost model of the storage device
+ *
+ *  @param      offset Position of the operation
+ *
+ *  @param      nbytes Number of bytes transfered
+ *
+ *  @param      write true for write operation
+ *
+ *  @return     void 
+ ****************************************************************************************/
+void account_pagefile_io(struct pagefile_cost *c, const struct storage_cost *dev, long offset, int nbytes, bool write);
+
 /**
  *****************************************************************************************
- *  @brief      This function creates and initializes a new pagefile.
+ *  @brief      This function creates a new pagefile. The pagefile grows sparsely:
+ *              a page that has never been written is read as the pseudo-random 
+ *              contents it would have had in a pagefile initialized completely.
+ *              The pagefile holds the address spaces of all clients one after another, 
+ *              the pages are numbered 0 .. VMEM_NBACKING_PAGES - 1.
  *
  *  @return     void 
  ****************************************************************************************/
@@ -27,7 +90,7 @@ void init_pagefile(void);
  *
  *  @return     void 
  ****************************************************************************************/
-void fetch_page_from_pagefile(int pageNo, unsigned char *frame_start);
+void fetch_page_from_pagefile(long pageNo, unsigned char *frame_start);
 
 /**
  *****************************************************************************************
@@ -39,7 +102,71 @@ void fetch_page_from_pagefile(int pageNo, unsigned char *frame_start);
  *
  *  @return     void 
  ****************************************************************************************/
-void store_page_to_pagefile(int pageNo, unsigned char *frame_start);
+void store_page_to_pagefile(long pageNo, unsigned char *frame_start);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function writes the modified sectors of a page to pagefile.
+ *              Adjacent dirty sectors will be written by one write operation.
+ *
+ *  @param      pageNo Number of the page that should be written to pagefile.
+ * 
+ *  @param      frame_start Starting address of the frame that contains the page.
+ *
+ *  @param      dirty_sectors Bitmap of modified sectors, see VMEM_GEO_SECTORSIZE.
+ *
+ *  @return     void 
+ ****************************************************************************************/
+void store_sectors_to_pagefile(long pageNo, unsigned char *frame_start, uint64_t dirty_sectors);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function writes the pages that have been written to the pagefile
+ *              into a checkpoint: the number of pages, followed by number and contents
+ *              of each page. This is not accounted.
+ *  @param      out File of the checkpoint
+ *  @return     void 
+ ****************************************************************************************/
+void checkpoint_pagefile(FILE *out);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function writes the pages of a checkpoint into the new pagefile.
+ *              This is not accounted.
+ *  @param      data Pages written by checkpoint_pagefile
+ *  @param      size Number of bytes available at data
+ *  @return     number of bytes of the pages of the checkpoint
+ ****************************************************************************************/
+size_t restore_pagefile(const unsigned char *data, size_t size);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function selects the cost model of the storage device.
+ *              Supported presets are hdd, ssd and nvme. Default is ssd.
+ *
+ *  @param      name Name of the preset
+ *
+ *  @return     false, if there is no preset with this name
+ ****************************************************************************************/
+bool set_pagefile_storage(const char *name);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the cost model of the storage device.
+ *
+ *  @return     current cost model
+ ****************************************************************************************/
+const struct storage_cost *get_pagefile_storage(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the I/O statistics of the pagefile.
+ *
+ *  @param      stats Will be filled with the current statistics.
+ *
+ *  @return     void 
+ ****************************************************************************************/
+void get_pagefile_stats(struct pagefile_stats *stats);
 
 /**
  *****************************************************************************************
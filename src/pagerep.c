@@ -0,0 +1,124 @@
+/**
+ * @file pagerep.c
+ * @date Oct 2026
+ * @brief This is the implementation of the page replacement algorithms fifo,
+ * clock and aging. They are shared by the memory manager and the trace driven
+ * simulator, so both select the same pages for replacement.
+ */
+
+#include <stdint.h>
+#include <strings.h>
+#include "error.h"
+#include "vmem.h"
+#include "pagerep.h"
+
+static const char *names[PAGEREP_NALGOS] = { "FIFO", "CLOCK", "AGING" };
+
+void pagerep_init(struct pagerep *pr, int algo, int first_frame, int nframes, unsigned char *age,
+                  const struct pagerep_ops *ops, void *owner) {
+    pr->algo = algo;
+    pr->first_frame = first_frame;
+    pr->nframes = nframes;
+    pr->hand = first_frame;
+    pr->scanned = 0;
+    pr->age = age;
+    pr->ops = ops;
+    pr->owner = owner;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function advances the hand of fifo and clock to the next frame.
+ *              The frame left has been inspected.
+ *
+ *  @param      pr Page replacement
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void advance_hand(struct pagerep *pr) {
+    pr->scanned++;
+    pr->hand++;
+    if (pr->hand >= pr->first_frame + pr->nframes) {
+        pr->hand = pr->first_frame;
+    }
+}
+
+static int select_fifo(struct pagerep *pr) {
+    pr->scanned = 0;
+    while (!pr->ops->is_candidate(pr, pr->hand)) {
+        advance_hand(pr);
+    }
+    int frame = pr->hand;
+    advance_hand(pr);
+    return frame;
+}
+
+static int select_clock(struct pagerep *pr) {
+    pr->scanned = 0;
+    while (true) {
+        if (!pr->ops->is_candidate(pr, pr->hand)) {
+            advance_hand(pr); // pinned pages, pages of other clients and unused frames are skipped
+        } else if (pr->ops->test_clear_ref(pr, pr->hand)) {
+            advance_hand(pr); // second chance
+        } else {
+            break;
+        }
+    }
+    int frame = pr->hand;
+    advance_hand(pr);
+    return frame;
+}
+
+static int select_aging(struct pagerep *pr) {
+    // nach ältestem frame suchen
+    uint8_t smallest_count = 0xFF;
+    int frame = VOID_IDX;
+    pr->scanned = pr->nframes;
+    for (int i = pr->first_frame; i < pr->first_frame + pr->nframes; i++) {
+        if ((pr->age[i] <= smallest_count) && pr->ops->is_candidate(pr, i)) {
+            smallest_count = pr->age[i];
+            frame = i;
+        }
+    }
+    TEST_AND_EXIT(frame == VOID_IDX, (stderr, "pagerep_select: no frame may be replaced\n"));
+    return frame;
+}
+
+int pagerep_select(struct pagerep *pr) {
+    switch (pr->algo) {
+        case PAGEREP_CLOCK: return select_clock(pr);
+        case PAGEREP_AGING: return select_aging(pr);
+        default:            return select_fifo(pr);
+    }
+}
+
+void pagerep_interval(struct pagerep *pr) {
+    if (pr->algo != PAGEREP_AGING) {
+        return;
+    }
+    for (int i = pr->first_frame; i < pr->first_frame + pr->nframes; i++) {
+        if (!pr->ops->holds_page(pr, i)) {
+            continue;
+        }
+        unsigned char new_age = pr->age[i] >> 1;
+        if (pr->ops->test_clear_ref(pr, i)) {
+            new_age |= (0x01 << 7);
+        }
+        pr->age[i] = new_age;
+    }
+}
+
+int pagerep_algo_of(const char *name) {
+    for (int i = 0; i < PAGEREP_NALGOS; i++) {
+        if (0 == strcasecmp(names[i], name)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char *pagerep_name(int algo) {
+    return ((algo >= 0) && (algo < PAGEREP_NALGOS)) ? names[algo] : "undefined";
+}
+
+// EOF
@@ -0,0 +1,109 @@
+/**
+ * @file pagerep.h
+ * @date Oct 2026
+ * @brief Header file of the page replacement algorithms fifo, clock and aging.
+ *        An algorithm selects the frame whose page will be replaced within a
+ *        contiguous range of frames. The owner of the frames, the memory manager
+ *        or the trace driven simulator, provides the state of the frames by
+ *        callbacks. The algorithms keep the hand of fifo and clock.
+ */
+
+#ifndef PAGEREP_H
+#define PAGEREP_H
+
+#include <stdbool.h>
+
+#define PAGEREP_FIFO    0   //!< first in first out
+#define PAGEREP_CLOCK   1   //!< second chance by the Ref bit
+#define PAGEREP_AGING   2   //!< 8 bit age counters updated each time interval
+#define PAGEREP_NALGOS  3   //!< number of algorithms
+
+#define PAGEREP_AGE_FETCHED 0x80 //!< age of a page that has just been fetched
+
+struct pagerep;
+
+/**
+ * Callbacks of the owner of the frames
+ */
+struct pagerep_ops {
+    bool (*is_candidate)(const struct pagerep *pr, int frame);    //!< frame stores a page that may be replaced
+    bool (*holds_page)(const struct pagerep *pr, int frame);      //!< frame stores a page
+    bool (*test_clear_ref)(const struct pagerep *pr, int frame);  //!< returns the Ref bit of the page of frame and clears it
+};
+
+/**
+ * Page replacement of a range of frames
+ */
+struct pagerep {
+    int algo;                       //!< PAGEREP_FIFO, PAGEREP_CLOCK or PAGEREP_AGING
+    int first_frame;                //!< first frame of range
+    int nframes;                    //!< number of frames of range
+    int hand;                       //!< hand of fifo and clock
+    int scanned;                    //!< frames inspected by the last pagerep_select
+    unsigned char *age;             //!< 8 bit age counter of each frame indexed by number of frame, see pagerep_interval
+    const struct pagerep_ops *ops;  //!< callbacks of the owner
+    void *owner;                    //!< data of the owner, e.g. its shard
+};
+
+/**
+ *****************************************************************************************
+ *  @brief      This function initializes the page replacement of a range of frames.
+ *
+ *  @param      pr Page replacement
+ *  @param      algo PAGEREP_FIFO, PAGEREP_CLOCK or PAGEREP_AGING
+ *  @param      first_frame First frame of range
+ *  @param      nframes Number of frames of range
+ *  @param      age Age counters of the frames, maintained by the owner on fetch
+ *  @param      ops Callbacks of the owner
+ *  @param      owner Data of the owner
+ *
+ *  @return     void
+ ****************************************************************************************/
+void pagerep_init(struct pagerep *pr, int algo, int first_frame, int nframes, unsigned char *age,
+                  const struct pagerep_ops *ops, void *owner);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function selects the frame whose page will be replaced. At least
+ *              one frame must be a candidate.
+ *
+ *  @param      pr Page replacement
+ *
+ *  @return     frame
+ ****************************************************************************************/
+int pagerep_select(struct pagerep *pr);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function ends a time interval. Aging shifts the age counter of
+ *              each frame storing a page and adds the Ref bit, which will be reset.
+ *              The other algorithms ignore the call, since they base on the Ref bit
+ *              themselves.
+ *
+ *  @param      pr Page replacement
+ *
+ *  @return     void
+ ****************************************************************************************/
+void pagerep_interval(struct pagerep *pr);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the algorithm of a name, e.g. fifo. Case is ignored.
+ *
+ *  @param      name Name of algorithm
+ *
+ *  @return     algorithm; -1, if undefined
+ ****************************************************************************************/
+int pagerep_algo_of(const char *name);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the name of an algorithm, e.g. FIFO.
+ *
+ *  @param      algo Algorithm
+ *
+ *  @return     name
+ ****************************************************************************************/
+const char *pagerep_name(int algo);
+
+#endif /* PAGEREP_H */
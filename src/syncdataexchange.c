@@ -13,6 +13,9 @@
  */
 
 #include "syncdataexchange.h"
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <sys/ipc.h>
 #include <fcntl.h> 
@@ -25,19 +28,90 @@
 #define SHMPROCID_SYNC_COM         3112                                //!< Second paremater for shared memory generation via ftok function
 
 #define NAMED_SEM_WAKEUP_MMANAGER  "BS_A3_mmanager" //!< Semaphore to inform memory manager about new task
-#define NAMED_SEM_WAKEUP_VMAPP     "BS_A3_vmapp"    //!< Semaphore to inform vmapp that task has been
+#define NAMED_SEM_WAKEUP_VMAPP     "BS_A3_vmapp_%d" //!< Semaphore to inform vmapp that task of a slot has been finished
+#define NAMED_SEM_COMPLETION       "BS_A3_vmapp_any_%d" //!< Semaphore to inform vmapp that an asynchronous task has been finished
 
+#define SLOT_FREE     0    //!< Slot enthaelt keinen Auftrag
+#define SLOT_REQUEST  1    //!< Slot enthaelt einen Auftrag, der noch nicht gelesen wurde
+#define SLOT_SERVING  2    //!< Der Server bearbeitet den Auftrag des Slots
+#define SLOT_DONE     3    //!< Die Antwort des Servers liegt im Slot
+
+/*
+ * @brief Ein Slot des gemeinsamen Speichers. Jeder Thread des Clients verwendet 
+ *        einen eigenen Slot, so dass mehrere Auftraege gleichzeitig ausstehen koennen.
+ */
+struct sync_slot {
+	struct msg msg;    //!< Auftrag bzw. Antwort
+	int state;         //!< Zustand des Slots, siehe SLOT_*
+};
 
 /*
  * Globale Variablen, daher nur eine Instanz des Moduls pro Programm
  */
 
 static int shm_id = -1;                      //!< Id zum Zugriff auf das shared memory
-static struct msg *sharedData = NULL;
+static struct sync_slot *sharedData = NULL;  //!< SYNC_NSLOTS Slots je Client im shared memory
+static int nClients = 1;                     //!< Server: Anzahl der Clients
+static int client = 0;                       //!< Client: Nummer des Clients
 static sem_t *wakeupMManager = SEM_FAILED;   //!< Named semaphores that informs memory manager about a new task
-static sem_t *wakeupVmApp = SEM_FAILED;      //!< Named semaphores that informs vmapp that task has been finished
+static sem_t *wakeupVmApp[SYNC_NCLIENTS * SYNC_NSLOTS]; //!< Named semaphores that inform vmapp that the task of a slot has been finished
+static sem_t *completion[SYNC_NCLIENTS];     //!< Named semaphores that inform vmapp that an asynchronous task has been finished
 static bool nextOpWaitForMsg = true;         //!< For checking correct order of waitForMsg and reply (sendAck)
-static int refNoForAck = -1;	             //!< waitForMsg stores refCounter of msg for sendAck
+static int slotForAck = -1;	                 //!< waitForMsg stores slot of msg for sendAck
+static int nextScanSlot = 0;                 //!< Server: Slot, bei dem die Suche nach dem naechsten Auftrag beginnt
+static long refNo[SYNC_NSLOTS];              //!< Client: Number of current reference send to memory manager per slot
+static int nextSlot = 0;                     //!< Client: naechster freier Slot fuer einen neuen Thread
+static __thread int threadSlot = -1;         //!< Client: Slot des aktuellen Threads
+static pthread_once_t clientSetup = PTHREAD_ONCE_INIT; //!< Client: Ressourcen werden einmal pro Prozess erzeugt
+
+/**
+ * @brief  Diese Funktion liefert den Namen der Semaphore eines Slots
+ * @param  slot Nummer des Slots ueber alle Clients
+ * @param  name Puffer fuer den Namen
+ * @param  len Laenge des Puffers
+ */
+static void semNameOfSlot(int slot, char *name, size_t len) {
+	snprintf(name, len, NAMED_SEM_WAKEUP_VMAPP, slot);
+}
+
+/**
+ * @brief  Diese Funktion liefert den Namen der Semaphore fuer asynchrone Auftraege
+ *         eines Clients
+ * @param  c Nummer des Clients
+ * @param  name Puffer fuer den Namen
+ * @param  len Laenge des Puffers
+ */
+static void semNameOfClient(int c, char *name, size_t len) {
+	snprintf(name, len, NAMED_SEM_COMPLETION, c);
+}
+
+/**
+ * @brief  Diese Funktion liefert einen Slot des Clients
+ * @param  slot Nummer des Slots innerhalb des Clients
+ * @return Slot im shared memory
+ */
+static struct sync_slot *slotOfClient(int slot) {
+	return &sharedData[client * SYNC_NSLOTS + slot];
+}
+
+/**
+ * @brief  Diese Funktion oeffnet die Semaphoren eines Clients
+ * @param  c Nummer des Clients
+ * @param  isServer Ist dieses Flag true, so werden die Semaphoren erzeugt.
+ */
+static void openSemaphoresOfClient(int c, bool isServer) {
+	char name[32];
+	semNameOfClient(c, name, sizeof(name));
+	completion[c] = (isServer) ? sem_open(name, O_CREAT | O_EXCL, 0644, 0)
+							   : sem_open(name, 0);
+	TEST_AND_EXIT_ERRNO(completion[c]  == SEM_FAILED, "setupSyncDataExchangeInternal: Error in creating named semaphore");
+	for (int i = c * SYNC_NSLOTS; i < (c + 1) * SYNC_NSLOTS; i++) {
+		semNameOfSlot(i, name, sizeof(name));
+		wakeupVmApp[i] = (isServer) ? sem_open(name, O_CREAT | O_EXCL, 0644, 0)
+								    : sem_open(name, 0);
+		TEST_AND_EXIT_ERRNO(wakeupVmApp[i]  == SEM_FAILED, "setupSyncDataExchangeInternal: Error creating named semaphore");
+	}
+}
 
 /**
  * @brief  Diese Funktion erzeugt die Ressourcen, die zum synchronnen Austausch
@@ -51,7 +125,8 @@ static void setupSyncDataExchangeInternal(bool isServer) {
 	key_t shm_key = ftok(SHMKEY_SYNC_COM, SHMPROCID_SYNC_COM);
 	TEST_AND_EXIT_ERRNO(shm_key == -1, "setupSyncDataExchangeInternal:ftok failed!");
 	// Use IPC:CREAT flag for server only
-	shm_id = shmget(shm_key, sizeof(struct msg), 0664 | ((isServer)?IPC_CREAT:0));
+	shm_id = (isServer) ? shmget(shm_key, nClients * SYNC_NSLOTS * sizeof(struct sync_slot), 0664 | IPC_CREAT)
+					   : shmget(shm_key, 0, 0664);
 	
 	if (shm_id == -1){
 		fprintf(stderr, "Shared memory from old run might still exists\n");
@@ -61,33 +136,68 @@ static void setupSyncDataExchangeInternal(bool isServer) {
 	
 	TEST_AND_EXIT_ERRNO(shm_id == -1, "setupSyncDataExchangeInternal:shmget failed!");
 	PRINT_DEBUG((stderr, "setupSyncDataExchangeInternal: shmget successfuly allocated %lu bytes\n", sizeof(struct msg)));
-	sharedData = (struct msg *) shmat(shm_id, NULL, 0);
-	TEST_AND_EXIT_ERRNO(sharedData == (struct msg *) -1, "setupSyncDataExchangeInternal: Error attaching shared memory");
+	sharedData = (struct sync_slot *) shmat(shm_id, NULL, 0);
+	TEST_AND_EXIT_ERRNO(sharedData == (struct sync_slot *) -1, "setupSyncDataExchangeInternal: Error attaching shared memory");
 	PRINT_DEBUG((stderr, "setupSyncDataExchangeInternal: Shared memory successfuly attached\n"));
 
 	// Server: Delete old instances of the semaphores
 	if (isServer) {
+		for (int i = 0; i < nClients * SYNC_NSLOTS; i++) {
+			sharedData[i].state = SLOT_FREE;
+		}
 		if (sem_unlink(NAMED_SEM_WAKEUP_MMANAGER)) {
 		 TEST_AND_EXIT_ERRNO(errno != ENOENT, "setupSyncDataExchangeInternal: Cannot unlink old instance of semaphore");
 		}
-		if (sem_unlink(NAMED_SEM_WAKEUP_VMAPP)) {
-		 TEST_AND_EXIT_ERRNO(errno != ENOENT, "setupSyncDataExchangeInternal: Cannot unlink old instance of semaphore");
+		for (int c = 0; c < nClients; c++) {
+			char name[32];
+			semNameOfClient(c, name, sizeof(name));
+			if (sem_unlink(name)) {
+			 TEST_AND_EXIT_ERRNO(errno != ENOENT, "setupSyncDataExchangeInternal: Cannot unlink old instance of semaphore");
+			}
+		}
+		for (int i = 0; i < nClients * SYNC_NSLOTS; i++) {
+			char name[32];
+			semNameOfSlot(i, name, sizeof(name));
+			if (sem_unlink(name)) {
+			 TEST_AND_EXIT_ERRNO(errno != ENOENT, "setupSyncDataExchangeInternal: Cannot unlink old instance of semaphore");
+			}
 		}
 	}
-	// create semaphore for sync access
+	// create semaphore for sync access; the client opens the semaphores of its own slots only
 	wakeupMManager = (isServer) ? sem_open(NAMED_SEM_WAKEUP_MMANAGER, O_CREAT | O_EXCL, 0644, 0)
 							   : sem_open(NAMED_SEM_WAKEUP_MMANAGER, 0);
 	TEST_AND_EXIT_ERRNO(wakeupMManager  == SEM_FAILED, "setupSyncDataExchangeInternal: Error in creating named semaphore");
-	wakeupVmApp = (isServer) ? sem_open(NAMED_SEM_WAKEUP_VMAPP, O_CREAT | O_EXCL, 0644, 0)
-							: sem_open(NAMED_SEM_WAKEUP_VMAPP, 0);
-	TEST_AND_EXIT_ERRNO(wakeupVmApp  == SEM_FAILED, "setupSyncDataExchangeInternal: Error creating named semaphore");
+	for (int c = 0; c < SYNC_NCLIENTS; c++) {
+		if ((isServer) ? (c < nClients) : (c == client)) {
+			openSemaphoresOfClient(c, isServer);
+		}
+	}
 	PRINT_DEBUG((stderr, "setupSyncDataExchangeInternal: semaphores successfully created\n"));
 }
 
-void setupSyncDataExchange(void) {
+void setupSyncDataExchange(int nclients) {
+	TEST_AND_EXIT((nclients <= 0) || (nclients > SYNC_NCLIENTS), (stderr, "setupSyncDataExchange: invalid number of clients\n"));
+	nClients = nclients;
 	setupSyncDataExchangeInternal(true);
 }
 
+void setSyncClient(int c) {
+	TEST_AND_EXIT((c < 0) || (c >= SYNC_NCLIENTS) || (sharedData != NULL), (stderr, "setSyncClient: invalid client\n"));
+	client = c;
+}
+
+void forkSyncClient(int c) {
+	TEST_AND_EXIT((c < 0) || (c >= SYNC_NCLIENTS), (stderr, "forkSyncClient: invalid client\n"));
+	// Der Kindprozess beginnt mit leeren Slots des neuen Clients
+	client = c;
+	nextSlot = 0;
+	threadSlot = -1;
+	memset(refNo, 0, sizeof(refNo));
+	if (sharedData != NULL) {
+		openSemaphoresOfClient(c, false);
+	}
+}
+
 void destroySyncDataExchange(void) {
 	// distory shared memory 
 	TEST_AND_EXIT_ERRNO(-1 ==  shmctl(shm_id, IPC_RMID, NULL), "distroySyncDataExchange: shmctl failed"); // Mark vmem for deletion 
@@ -97,45 +207,170 @@ void destroySyncDataExchange(void) {
 	// distory semaphores
 	TEST_AND_EXIT_ERRNO(sem_close(wakeupMManager) == -1, "distroySyncDataExchange: sem_close failed");
 	TEST_AND_EXIT_ERRNO(sem_unlink(NAMED_SEM_WAKEUP_MMANAGER) == -1, "distroySyncDataExchange: sem_unlink failed");
-	TEST_AND_EXIT_ERRNO(sem_close(wakeupVmApp) == -1, "distroySyncDataExchange: sem_close failed");
-	TEST_AND_EXIT_ERRNO(sem_unlink(NAMED_SEM_WAKEUP_VMAPP) == -1, "distroySyncDataExchange: sem_unlink failed");
+	for (int c = 0; c < nClients; c++) {
+		char name[32];
+		semNameOfClient(c, name, sizeof(name));
+		TEST_AND_EXIT_ERRNO(sem_close(completion[c]) == -1, "distroySyncDataExchange: sem_close failed");
+		TEST_AND_EXIT_ERRNO(sem_unlink(name) == -1, "distroySyncDataExchange: sem_unlink failed");
+	}
+	for (int i = 0; i < nClients * SYNC_NSLOTS; i++) {
+		char name[32];
+		semNameOfSlot(i, name, sizeof(name));
+		TEST_AND_EXIT_ERRNO(sem_close(wakeupVmApp[i]) == -1, "distroySyncDataExchange: sem_close failed");
+		TEST_AND_EXIT_ERRNO(sem_unlink(name) == -1, "distroySyncDataExchange: sem_unlink failed");
+	}
 	PRINT_DEBUG((stderr, "distroySyncDataExchange: Semaphore successfully destroyed\n"));
 }
 
-void sendMsgToMmanager(struct msg msg){
-	static int refNo = 0; //!< Number of current reference send to memory manager
-	msg.ref = refNo; // Wird zur Ueberpruefung der Kommunikation hoch gezaehlt.
+/**
+ * @brief  Diese Funktion erzeugt die Ressourcen des Clients. Sie wird einmal pro 
+ *         Prozess ueber pthread_once aufgerufen.
+ */
+static void setupClient(void) {
+	TEST_AND_EXIT(((shm_id != -1) || (sharedData != NULL) || (wakeupMManager != SEM_FAILED)), 
+				 (stderr, "sendMsgToMmanager:Internal error detected\n"));
+	//printf("setting up sync data exchange\n");
+	setupSyncDataExchangeInternal(false);
+}
+
+int allocSlot(void) {
+	int slot = __atomic_fetch_add(&nextSlot, 1, __ATOMIC_RELAXED);
+	return (slot < SYNC_NSLOTS) ? slot : -1;
+}
+
+int getSlotOfThread(void) {
+	if (threadSlot == -1) {
+		threadSlot = allocSlot();
+		TEST_AND_EXIT(threadSlot == -1, (stderr, "sendMsgToMmanager: more than %d threads\n", SYNC_NSLOTS));
+	}
+	return threadSlot;
+}
+
+/**
+ * @brief  Diese Funktion uebertraegt einen Auftrag in einen Slot und weckt den Server.
+ * @param  msg Auftrag
+ * @param  slot Slot des Auftrags
+ * @param  notify Ist dieses Flag true, so meldet der Server die Antwort ueber die
+ *                gemeinsame Semaphore completion.
+ */
+static void postMsg(struct msg msg, int slot, bool notify) {
 	// Beim ersten Aufruf erzeugt der Client die Datenstrukturen
-	if ((shm_id == -1) && (sharedData == NULL) && (wakeupMManager == SEM_FAILED) && (wakeupVmApp == SEM_FAILED)) {
-		// Erster Aufruf durch den Client
-		TEST_AND_EXIT(((shm_id != -1) || (sharedData != NULL) || (wakeupMManager != SEM_FAILED) || (wakeupVmApp != SEM_FAILED)), 
-					 (stderr, "sendMsgToMmanager:Internal error detected\n"));
-		//printf("setting up sync data exchange\n");
-		setupSyncDataExchangeInternal(false);
-	} // end if erzeuge Kommunikationstrukturen
+	TEST_AND_EXIT(pthread_once(&clientSetup, setupClient) != 0, (stderr, "sendMsgToMmanager: pthread_once failed\n"));
+	struct sync_slot *s = slotOfClient(slot);
+	TEST_AND_EXIT(s->state != SLOT_FREE, (stderr, "postMsgToMmanager: slot %d is in use\n", slot));
+
+	msg.ref = refNo[slot]; // Wird zur Ueberpruefung der Kommunikation hoch gezaehlt.
+	msg.slot = slot;
+	msg.notify = notify;
 	// Uebertrage Daten an den Server
-	*sharedData = msg;
+	s->msg = msg;
+	__atomic_store_n(&s->state, SLOT_REQUEST, __ATOMIC_RELEASE);
 	TEST_AND_EXIT_ERRNO(sem_post(wakeupMManager) == -1, "sendMsgToMmanager:sem_post failed!");
+}
+
+/**
+ * @brief  Diese Funktion prueft die Antwort des Servers und gibt den Slot frei.
+ * @param  slot Slot des Auftrags
+ */
+static void finishMsg(int slot) {
+	struct sync_slot *s = slotOfClient(slot);
+	TEST_AND_EXIT((s->msg.ref != refNo[slot]), (stderr, "Application and memory manager asynchronous"));
+	TEST_AND_EXIT(s->msg.cmd != CMD_ACK, (stderr, "Unexpected answer from memory manager"));
+	s->state = SLOT_FREE;
+	refNo[slot]++;
+	PRINT_DEBUG((stderr, "Receive Msg form mem manager (cmd = %d, val = %ld, ref = %ld)\n", s->msg.cmd, s->msg.value, s->msg.ref));
+}
+
+void sendMsgToMmanager(struct msg msg){
+	int slot = getSlotOfThread();
+	postMsg(msg, slot, false);
 	// Warte auf Antwort vom Server
-	TEST_AND_EXIT_ERRNO(sem_wait(wakeupVmApp) == -1, "sendMsgToMmanager:sem_post:sem_wait failed!");
-	TEST_AND_EXIT((sharedData->ref != refNo), (stderr, "Application and memory manager asynchronous"));
-	TEST_AND_EXIT(sharedData->cmd != CMD_ACK, (stderr, "Unexpected answer from memory manager"));
-	refNo++;
-	PRINT_DEBUG((stderr, "Receive Msg form mem manager (cmd = %d, val = %d, ref = %d)\n", sharedData->cmd, sharedData->value, sharedData->ref));
+	while (sem_wait(wakeupVmApp[client * SYNC_NSLOTS + slot]) == -1) {
+		TEST_AND_EXIT_ERRNO(errno != EINTR, "sendMsgToMmanager:sem_post:sem_wait failed!");
+	}
+	TEST_AND_EXIT(__atomic_load_n(&slotOfClient(slot)->state, __ATOMIC_ACQUIRE) != SLOT_DONE, (stderr, "Unexpected slot state"));
+	finishMsg(slot);
 }
 
-struct msg waitForMsg(void){
-	// Ueberpruefe Reihenfolge waitForMsg und SendAck
-	TEST_AND_EXIT((!nextOpWaitForMsg), (stderr, "waitForMsg:Internal error, waitForMsg call not expected\n"));
-	nextOpWaitForMsg = false;
+void postMsgToMmanager(struct msg msg, int slot) {
+	postMsg(msg, slot, true);
+}
+
+bool pollAckFromMmanager(int slot) {
+	if (__atomic_load_n(&slotOfClient(slot)->state, __ATOMIC_ACQUIRE) != SLOT_DONE) {
+		return false;
+	}
+	finishMsg(slot);
+	return true;
+}
+
+void waitForAnyAck(void) {
+	while (sem_wait(completion[client]) == -1) {
+		TEST_AND_EXIT_ERRNO(errno != EINTR, "waitForAnyAck:sem_wait failed!");
+	}
+}
+
+/**
+ * @brief  Diese Funktion wartet auf den naechsten Auftrag und markiert seinen Slot 
+ *         als in Bearbeitung.
+ * @return Slot des Auftrags ueber alle Clients
+ */
+static int receiveMsg(void) {
+	int found = -1;
 	// Teste Kommunikationsparameter
-	TEST_AND_EXIT(((shm_id == -1) || (sharedData == NULL) || (wakeupMManager == SEM_FAILED) || (wakeupVmApp == SEM_FAILED)), 
+	TEST_AND_EXIT(((shm_id == -1) || (sharedData == NULL) || (wakeupMManager == SEM_FAILED)), 
 				 (stderr, "waitForMsg:Internal error detected\n"));
 	// Warte auf Auftrag
 	TEST_AND_EXIT_ERRNO(sem_wait(wakeupMManager) == -1, "waitForMsg:sem_post:sem_wait failed!");
-	TEST_AND_EXIT(sharedData->cmd == CMD_ACK, (stderr, "waitForMsg: Unexpected command from vmapp"));
-	refNoForAck = sharedData->ref;
-	return *sharedData;
+	// Suche reihum den naechsten Slot mit einem Auftrag. Jeder Auftrag hat die 
+	// Semaphore genau einmal erhoeht, daher gibt es mindestens einen Slot mit Auftrag.
+	for (int i = 0; (i < nClients * SYNC_NSLOTS) && (found == -1); i++) {
+		int slot = (nextScanSlot + i) % (nClients * SYNC_NSLOTS);
+		if (__atomic_load_n(&sharedData[slot].state, __ATOMIC_ACQUIRE) == SLOT_REQUEST) {
+			found = slot;
+		}
+	}
+	TEST_AND_EXIT(found == -1, (stderr, "waitForMsg: no request found\n"));
+	struct sync_slot *s = &sharedData[found];
+	s->state = SLOT_SERVING;
+	nextScanSlot = (found + 1) % (nClients * SYNC_NSLOTS);
+	TEST_AND_EXIT(s->msg.cmd == CMD_ACK, (stderr, "waitForMsg: Unexpected command from vmapp"));
+	s->msg.slot = found % SYNC_NSLOTS;
+	s->msg.client = found / SYNC_NSLOTS;
+	return found;
+}
+
+/**
+ * @brief  Diese Funktion schreibt die Antwort in einen Slot und weckt den Client.
+ * @param  slot Slot des Auftrags ueber alle Clients
+ */
+static void ackSlot(int slot) {
+	struct sync_slot *s = &sharedData[slot];
+	TEST_AND_EXIT(s->state != SLOT_SERVING, (stderr, "sendAck: slot %d is not served\n", slot));
+	s->msg.cmd = CMD_ACK;
+	s->msg.value = 0;
+	__atomic_store_n(&s->state, SLOT_DONE, __ATOMIC_RELEASE);
+	TEST_AND_EXIT_ERRNO(sem_post(s->msg.notify ? completion[s->msg.client] : wakeupVmApp[slot]) == -1, "sendAck:sem_post failed!");
+}
+
+struct msg waitForMsg(void){
+	// Ueberpruefe Reihenfolge waitForMsg und SendAck
+	TEST_AND_EXIT((!nextOpWaitForMsg), (stderr, "waitForMsg:Internal error, waitForMsg call not expected\n"));
+	nextOpWaitForMsg = false;
+	slotForAck = receiveMsg();
+	return sharedData[slotForAck].msg;
+}
+
+struct msg takeMsg(void) {
+	return sharedData[receiveMsg()].msg;
+}
+
+int countPendingMsgs(void) {
+	int n = 0;
+	for (int i = 0; i < nClients * SYNC_NSLOTS; i++) {
+		n += (__atomic_load_n(&sharedData[i].state, __ATOMIC_ACQUIRE) == SLOT_REQUEST);
+	}
+	return n;
 }
 
 void sendAck(void){
@@ -143,12 +378,15 @@ void sendAck(void){
 	TEST_AND_EXIT((nextOpWaitForMsg), (stderr, "sendAck:Internal error, sendAck call not expected\n"));
 	nextOpWaitForMsg = true;
 	// Teste Kommunikationsparameter
-	TEST_AND_EXIT(((shm_id == -1) || (sharedData == NULL) || (wakeupMManager == SEM_FAILED) || (wakeupVmApp == SEM_FAILED)), 
+	TEST_AND_EXIT(((shm_id == -1) || (sharedData == NULL) || (wakeupMManager == SEM_FAILED) || (slotForAck == -1)), 
 				 (stderr, "sendAck:Internal error detected\n"));
-	sharedData->cmd = CMD_ACK;
-	sharedData->value = 0;
-	sharedData->ref = refNoForAck;
-	TEST_AND_EXIT_ERRNO(sem_post(wakeupVmApp) == -1, "sendAck:sem_post failed!");
+	ackSlot(slotForAck);
+}
+
+void sendAckOfMsg(struct msg msg) {
+	TEST_AND_EXIT((msg.client < 0) || (msg.client >= nClients) || (msg.slot < 0) || (msg.slot >= SYNC_NSLOTS), 
+				 (stderr, "sendAckOfMsg:Internal error detected\n"));
+	ackSlot(msg.client * SYNC_NSLOTS + msg.slot);
 }
 
 //EOF
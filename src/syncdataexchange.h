@@ -15,6 +15,17 @@
  *          Der gemeinsame Speicher ist über einen Mutex geschützt. Analog zum Erzeuger
  *          Verbrauchen Problem werden zwei Semaphore zur Synchronisation zwischen Client
  *          und Server verwendet.
+ *          Jeder Thread des Clients verwendet einen eigenen Slot im gemeinsamen 
+ *          Speicher und eine eigene Semaphore fuer die Antwort. So koennen mehrere 
+ *          Threads gleichzeitig Auftraege ausstehen haben. Der Server bearbeitet
+ *          die Auftraege nacheinander.
+ *          Asynchrone Auftraege werden ohne Warten abgeschickt. Der Server meldet
+ *          ihre Bearbeitung ueber eine gemeinsame Semaphore, danach fragt der Client
+ *          die Slots seiner Auftraege ab.
+ *          Mehrere Clients (vmapp Prozesse) koennen gleichzeitig mit dem Server 
+ *          kommunizieren. Jeder Client hat einen eigenen Bereich von SYNC_NSLOTS 
+ *          Slots mit eigenen Semaphoren. Die Nummer des Clients ist die Nummer 
+ *          seines Adressraums (ASID) im Memory Manager.
  *
  *          Der Server ist für die Initialiserung und Freigabe der Komponenten 
  *          verantwortlich.
@@ -32,26 +43,57 @@
 struct msg {
 	/// @brief Der auszufuehrende Befehl
 	int cmd;
-	/// @brief Parameter des Befehls
-	int value;
+	/// @brief Parameter des Befehls, z.B. eine Seitennummer (64 Bit)
+	long value;
 	/// @brief Der g_count modelliert die aktuelle Zeit, in dem die Anzahl der 
-	///        Speicherzugriffe durch vmaccess gezählt wird.
-	int g_count;
+	///        Speicherzugriffe durch vmaccess gezählt wird (64 Bit).
+	long g_count;
 	/// @brief Fortlaufender Ref-Counter zur Zuordnung zwischen Befehl und Antwort.
-	int ref;
+	long ref;
+	/// @brief Slot des Auftrags innerhalb des Clients. Jeder Thread des Clients hat einen eigenen Slot.
+	int slot;
+	/// @brief Client des Auftrags, wird von waitForMsg gesetzt.
+	int client;
+	/// @brief Asynchroner Auftrag: Der Server meldet die Antwort ueber die gemeinsame Semaphore.
+	int notify;
 };
 
+#define SYNC_NSLOTS		16	// Maximale Anzahl der Threads des Clients mit eigenem Slot
+#define SYNC_NCLIENTS		8	// Maximale Anzahl der Clients
+
 #define CMD_PAGEFAULT		1	// value gibt die einzulagernde Page mit
 #define CMD_TIME_INTER_VAL   	2	// Ein Time Interval ist abgelaufen
 #define CMD_ACK 		3	// value hat keine Bedeutung
+#define CMD_PIN 		4	// value gibt die zu fixierende Page mit
+#define CMD_UNPIN 		5	// value gibt die freizugebende Page mit
+#define CMD_COW 		6	// value gibt die geteilte Page mit, die eine eigene Kopie erhalten soll
+#define CMD_FORK 		7	// value gibt den Adressraum mit, der eine Kopie des Adressraums des Clients erhalten soll
+#define CMD_CHECKPOINT 		8	// value hat keine Bedeutung; der Memory Manager schreibt einen Checkpoint
 
 /**
  * @brief  Diese Funktion erzeugt die Ressourcen, die zum synchronnen Austausch
  *         der Daten benötigt werden, von Seiten des Servers.
  *         Da die Daten vor der ersten Kommunikation vorliegen müssen, wird die
  *         Funktion von Server aufgerufen.
+ * @param  nclients Anzahl der Clients, hoechstens SYNC_NCLIENTS
+ */
+extern void setupSyncDataExchange(int nclients);
+
+/**
+ * @brief  Diese Funktion legt die Nummer des Clients fest. Sie muss vom Client 
+ *         vor dem ersten Auftrag aufgerufen werden, sonst wird Client 0 verwendet.
+ * @param  client Nummer des Clients
+ */
+extern void setSyncClient(int client);
+
+/**
+ * @brief  Diese Funktion wechselt im Kindprozess nach fork die Nummer des Clients.
+ *         Die Slots des neuen Clients werden ab Slot 0 vergeben, die Semaphoren 
+ *         des neuen Clients werden geoeffnet. Der Kindprozess darf nur einen 
+ *         Thread haben und keine Auftraege des alten Clients ausstehen haben.
+ * @param  client Nummer des neuen Clients
  */
-extern void setupSyncDataExchange(void);
+extern void forkSyncClient(int client);
 
 /**
  * @brief   Diese Funktion gibt die Ressourcen, die zum synchronnen Austausch
@@ -69,6 +111,53 @@ extern void destroySyncDataExchange(void);
  ****************************************************************************************/
 extern void sendMsgToMmanager(struct msg msg);
 
+/**
+ *****************************************************************************************
+ *  @brief      This function sends a message to memory manager without waiting for
+ *              the ACK. The ACK must be fetched by pollAckFromMmanager.
+ *  @param      msg Message to be send.
+ *  @param      slot Slot allocated by allocSlot; it must not have an outstanding message.
+ * 
+ *  @return     void
+ ****************************************************************************************/
+extern void postMsgToMmanager(struct msg msg, int slot);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function checks, whether the message posted in a slot has been 
+ *              acknowledged by the memory manager. If so, the slot will be released.
+ *  @param      slot Slot of the message.
+ * 
+ *  @return     true, if the ACK has been received
+ ****************************************************************************************/
+extern bool pollAckFromMmanager(int slot);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function blocks until the memory manager has acknowledged a 
+ *              message posted by postMsgToMmanager. Each ACK wakes up one call.
+ * 
+ *  @return     void
+ ****************************************************************************************/
+extern void waitForAnyAck(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function allocates an unused slot of the client.
+ *
+ *  @return     slot; -1, if all slots are in use
+ ****************************************************************************************/
+extern int allocSlot(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the slot of the current thread. At the first call
+ *              of a thread a new slot will be assigned.
+ *
+ *  @return     slot of current thread
+ ****************************************************************************************/
+extern int getSlotOfThread(void);
+
 /**
  *****************************************************************************************
  *  @brief      This function blocks until a message from vmapp has arrived.
@@ -77,6 +166,26 @@ extern void sendMsgToMmanager(struct msg msg);
  ****************************************************************************************/
 extern struct msg waitForMsg(void);
 
+/**
+ *****************************************************************************************
+ *  @brief      This function blocks until a message from vmapp has arrived. Unlike 
+ *              waitForMsg, several messages may be taken before they are acknowledged
+ *              by sendAckOfMsg, so the memory manager may serve them concurrently.
+ *              It must be called by one thread of the memory manager only.
+ *              
+ *  @return     Message that has been received 
+ ****************************************************************************************/
+extern struct msg takeMsg(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function counts the requests of vmapp that wait for the memory
+ *              manager. The request received by waitForMsg is not included.
+ *              
+ *  @return     Number of outstanding requests
+ ****************************************************************************************/
+extern int countPendingMsgs(void);
+
 /**
  *****************************************************************************************
  *  @brief      This function sends an ACK to vmapp 
@@ -85,5 +194,16 @@ extern struct msg waitForMsg(void);
  ****************************************************************************************/
 extern void sendAck(void);
 
+/**
+ *****************************************************************************************
+ *  @brief      This function sends an ACK to vmapp for a message received by takeMsg.
+ *              It may be called by any thread of the memory manager.
+ *
+ *  @param      msg Message to be acknowledged
+ *
+ *  @return     void
+ ****************************************************************************************/
+extern void sendAckOfMsg(struct msg msg);
+
 #endif
 //EOF
\ No newline at end of file
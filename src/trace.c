@@ -0,0 +1,109 @@
+/**
+ * @file trace.c
+ * @date Oct 2026
+ * @brief This is the implementation of the format of access traces.
+ * Numbers are stored as LEB128 varints: 7 bits per byte, the high bit marks
+ * a following byte. Signed differences are zigzag coded before, so small
+ * negative values take few bytes as well.
+ */
+
+#include <string.h>
+#include "vmem.h"
+#include "trace.h"
+
+void trace_init_header(struct trace_header *hdr, int seed, const char *workload) {
+    memset(hdr, 0, sizeof(*hdr));
+    memcpy(hdr->magic, TRACE_MAGIC, sizeof(hdr->magic));
+    hdr->version = TRACE_VERSION;
+    hdr->pagesize = VMEM_GEO_PAGESIZE;
+    hdr->virtmemsize = VMEM_VIRTMEMSIZE;
+    hdr->physmemsize = VMEM_PHYSMEMSIZE;
+    hdr->nclients = VMEM_NCLIENTS;
+    hdr->hugepages = VMEM_HUGEPAGES;
+    hdr->seed = seed;
+    strncpy(hdr->workload, workload, TRACE_NAMELEN - 1);
+}
+
+bool trace_check_header(const struct trace_header *hdr) {
+    return (memcmp(hdr->magic, TRACE_MAGIC, sizeof(hdr->magic)) == 0) && (hdr->version == TRACE_VERSION);
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function writes a varint.
+ *
+ *  @param      buf Buffer of at least 10 bytes
+ *  @param      val Value
+ *
+ *  @return     Number of bytes of the varint
+ ****************************************************************************************/
+static size_t put_varint(unsigned char *buf, unsigned long val) {
+    size_t n = 0;
+    while (val >= 0x80) {
+        buf[n++] = (val & 0x7F) | 0x80;
+        val >>= 7;
+    }
+    buf[n++] = val;
+    return n;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function reads a varint.
+ *
+ *  @param      buf Encoded varint
+ *  @param      size Number of bytes of buf
+ *  @param      val Value of the varint
+ *
+ *  @return     Number of bytes of the varint; 0, if buf is truncated
+ ****************************************************************************************/
+static size_t get_varint(const unsigned char *buf, size_t size, unsigned long *val) {
+    unsigned long v = 0;
+    for (size_t n = 0; (n < size) && (n < 10); n++) {
+        v |= (unsigned long) (buf[n] & 0x7F) << (7 * n);
+        if (!(buf[n] & 0x80)) {
+            *val = v;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+size_t trace_encode(unsigned char *buf, const struct trace_event *ev, long *next) {
+    long delta = ev->address - *next;
+    unsigned long zigzag = ((unsigned long) delta << 1) ^ (unsigned long) (delta >> 63);
+    size_t n = put_varint(buf, (zigzag << TRACE_KIND_BITS) | ev->kind);
+    if (ev->kind & (TRACE_RUN | TRACE_VALUE)) {
+        n += put_varint(buf + n, ev->len);
+    }
+    *next = ev->address + ev->len;
+    return n;
+}
+
+size_t trace_decode(const unsigned char *buf, size_t size, struct trace_event *ev, long *next) {
+    unsigned long word = 0;
+    unsigned long len = 1;
+    size_t n = get_varint(buf, size, &word);
+    if (n == 0) {
+        return 0;
+    }
+    ev->kind = word & ((1 << TRACE_KIND_BITS) - 1);
+    if (ev->kind & (TRACE_RUN | TRACE_VALUE)) {
+        size_t m = get_varint(buf + n, size - n, &len);
+        if (m == 0) {
+            return 0;
+        }
+        n += m;
+    }
+    unsigned long zigzag = word >> TRACE_KIND_BITS;
+    ev->address = *next + (long) ((zigzag >> 1) ^ -(zigzag & 1));
+    ev->len = len;
+    *next = ev->address + ev->len;
+    return n;
+}
+
+long trace_accesses(const struct trace_event *ev) {
+    return (ev->kind & TRACE_RUN) ? ev->len : 1;
+}
+
+// EOF
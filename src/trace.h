@@ -0,0 +1,120 @@
+/**
+ * @file trace.h
+ * @date Oct 2026
+ * @brief Header file of the format of access traces. A trace records the
+ *        accesses of vmappl to virtual memory, see vmem_trace. It starts with
+ *        struct trace_header, followed by the encoded events.
+ *
+ *        An event is a read or a write of len consecutive bytes. Its address is
+ *        stored as difference to the end of the previous event, hence sequential
+ *        accesses take one byte. The first varint of an event holds the zigzag
+ *        coded difference shifted left by TRACE_KIND_BITS and the kind of the
+ *        event. A run or a value is followed by a varint holding len.
+ *        All numbers are stored in host byte order.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define TRACE_MAGIC      "VMEMTRC"  //!< first bytes of a trace
+#define TRACE_VERSION    1          //!< incremented, when the format changes
+#define TRACE_NAMELEN    32         //!< size of the name of the workload
+#define TRACE_MAXEVENT   20         //!< longest encoded event: two varints of 64 bit values
+
+/**
+ * Kind of an event
+ */
+#define TRACE_WRITE      0x1        //!< event writes; otherwise it reads
+#define TRACE_RUN        0x2        //!< len bytes, each byte is one access (range functions)
+#define TRACE_VALUE      0x4        //!< len bytes read or written by one access to each page they occupy (vmem_read_u16 ...)
+#define TRACE_KIND_BITS  3          //!< bits of the kind
+
+/**
+ * Header of a trace
+ */
+struct trace_header {
+    char magic[8];                  //!< TRACE_MAGIC
+    int version;                    //!< TRACE_VERSION
+    int pagesize;                   //!< geometry of virtual memory while recording
+    long virtmemsize;
+    int physmemsize;
+    int nclients;
+    int hugepages;
+    int seed;                       //!< seed of vmappl
+    char workload[TRACE_NAMELEN];   //!< workload or sort algorithm of vmappl
+    long events;                    //!< number of events, written when the trace is closed
+    long accesses;                  //!< number of accesses, written when the trace is closed
+};
+
+/**
+ * Event of a trace
+ */
+struct trace_event {
+    long address;                   //!< first byte
+    long len;                       //!< number of bytes
+    int kind;                       //!< TRACE_WRITE, TRACE_RUN, TRACE_VALUE
+};
+
+/**
+ *****************************************************************************************
+ *  @brief      This function initializes the header of a trace with the geometry of
+ *              virtual memory.
+ *
+ *  @param      hdr Header of the trace
+ *  @param      seed Seed of vmappl
+ *  @param      workload Name of the workload or of the sort algorithm
+ *
+ *  @return     void
+ ****************************************************************************************/
+void trace_init_header(struct trace_header *hdr, int seed, const char *workload);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function checks magic number and version of a trace header.
+ *
+ *  @param      hdr Header of the trace
+ *
+ *  @return     true, if the header belongs to a trace of this version
+ ****************************************************************************************/
+bool trace_check_header(const struct trace_header *hdr);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function encodes an event.
+ *
+ *  @param      buf Buffer of at least TRACE_MAXEVENT bytes
+ *  @param      ev Event
+ *  @param      next End of the previous event; updated to the end of ev
+ *
+ *  @return     Number of bytes stored in buf
+ ****************************************************************************************/
+size_t trace_encode(unsigned char *buf, const struct trace_event *ev, long *next);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function decodes an event.
+ *
+ *  @param      buf Encoded events
+ *  @param      size Number of bytes of buf
+ *  @param      ev Decoded event
+ *  @param      next End of the previous event; updated to the end of ev
+ *
+ *  @return     Number of bytes of the encoded event; 0, if buf holds no complete event
+ ****************************************************************************************/
+size_t trace_decode(const unsigned char *buf, size_t size, struct trace_event *ev, long *next);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the number of accesses of an event: len for
+ *              a run, 1 otherwise.
+ *
+ *  @param      ev Event
+ *
+ *  @return     Number of accesses
+ ****************************************************************************************/
+long trace_accesses(const struct trace_event *ev);
+
+#endif /* TRACE_H */
@@ -6,19 +6,29 @@
  */
 
 #include "vmaccess.h"
-#include <sys/ipc.h>
-#include <sys/shm.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
 
 #include "syncdataexchange.h"
+#include "coroutine.h"
 #include "vmem.h"
 #include "debug.h"
 #include "error.h"
+#include "trace.h"
+#include "livestats.h"
 
 /*
  * static variables
  */
 
+static struct vmem_struct vmem_view;     //!< View of shared memory
 static struct vmem_struct *vmem = NULL; //!< Reference to virtual memory
+static int asid = 0;                    //!< address space of this process
 
 /**
  * The progression of time is simulated by the counter g_count, which is incremented by 
@@ -28,9 +38,167 @@ static struct vmem_struct *vmem = NULL; //!< Reference to virtual memory
  * Based on this information, memory manager will update aging information
  */
 
-static int g_count = 0;    //!< global acces counter as quasi-timestamp - will be increment by each memory access
-static int shm_id = -1; 
-#define TIME_WINDOW   20
+static long g_count = 0;   //!< global acces counter as quasi-timestamp - will be increment atomically by each memory access
+static int tick_mode = VMEM_TICKS_BULK; //!< g_count handling of accesses to one page, see vmem_set_tick_mode
+#define TIME_WINDOW   VMEM_TIME_WINDOW
+
+/**
+ * Thread safe mode, see vmem_enable_threads. Concurrent page faults on one page are 
+ * coalesced: the first thread sends the request, the others wait for fault_done.
+ */
+static bool mt_mode = false;                                  //!< thread safe mode enabled
+static pthread_mutex_t fault_mutex = PTHREAD_MUTEX_INITIALIZER; //!< protects fault_pending
+static pthread_cond_t fault_done = PTHREAD_COND_INITIALIZER;    //!< signaled, when a page fault request has been answered
+static long fault_pending[SYNC_NSLOTS];                       //!< pages with an outstanding request; VOID_IDX: entry unused
+static pthread_key_t tlb_key;                                 //!< publishes TLB statistics of a thread on thread exit
+
+/**
+ * Asynchronous mode, see vmem_enable_async. A coroutine that faults posts its request 
+ * in a slot of the pool and blocks. The idle function of the scheduler collects the 
+ * ACKs and wakes up the coroutines waiting for the page.
+ */
+#define ASYNC_WAIT_NONE  -1   //!< coroutine does not wait
+#define ASYNC_WAIT_SLOT  -2   //!< coroutine waits for a free slot of the pool
+
+static bool async_mode = false;            //!< asynchronous mode enabled
+static int async_slots[SYNC_NSLOTS];       //!< slots of the pool
+static int async_nslots = 0;               //!< number of slots of the pool
+static long slot_page[SYNC_NSLOTS];        //!< page requested via slot; VOID_IDX: no outstanding request
+static long co_wait[CO_MAX];               //!< page a coroutine waits for or ASYNC_WAIT_*
+
+/**
+ * Entry of the software TLB. It caches the translation page -> frame and remembers
+ * which flags of the page table entry have been written already. So Ref and Dirty 
+ * bits will be written once per time window only.
+ * An entry of a huge page caches the translation of all pages of the run. The Ref
+ * bits are remembered per page of the run, the dirty sectors are not cached.
+ */
+struct tlb_entry {
+    long page;                //!< cached page, first page of the run of a huge page; VOID_IDX: entry unused
+    int frame;                //!< frame storing the page
+    bool huge;                //!< entry caches a huge page
+    unsigned long last_use;   //!< tlb_clock of the last hit; used for LRU replacement within a set
+    uint64_t ref_set;         //!< bit i: PTF_REF of page + i has been written since the manager cleared it last
+    uint64_t dirty_sectors;   //!< sectors already marked dirty in the page table
+};
+
+/* The geometry of the TLB is global, the TLB itself is private to each thread. */
+static int tlb_sets = 0;                 //!< number of sets; 0: TLB disabled
+static int tlb_ways = 0;                 //!< associativity
+static __thread struct tlb_entry tlb[VMEM_TLB_MAXENTRIES]; //!< software TLB, set i occupies entries [i * tlb_ways, (i + 1) * tlb_ways)
+static __thread bool tlb_ready = false;           //!< TLB of this thread has been initialized
+static __thread unsigned long tlb_clock = 0;      //!< local time stamp for LRU replacement
+static __thread unsigned long tlb_evict_epoch = 0; //!< last shootdown epoch of evictions seen
+static __thread unsigned long tlb_ref_epoch = 0;   //!< last shootdown epoch of Ref bit resets seen
+static __thread struct vmem_tlb_stats tlb_stats;   //!< local statistics, published to shared memory on exit
+
+/**
+ * Recorder of the accesses, see vmem_trace. The accesses append their events to the
+ * current buffer. A full buffer is handed over to the writer thread, which writes it
+ * to the trace, and the next free buffer becomes the current one. In thread safe mode
+ * the accesses append under trace_mutex.
+ */
+#define TRACE_BUFSIZE  (64 * 1024)   //!< size of a buffer
+#define TRACE_NBUFS    4             //!< number of buffers
+
+struct trace_buf {
+    unsigned char data[TRACE_BUFSIZE];  //!< encoded events
+    size_t len;                         //!< bytes used
+};
+
+static bool trace_on = false;                //!< accesses are recorded
+static int trace_fd = -1;                    //!< file of the trace
+static struct trace_header trace_hdr;        //!< header, rewritten when the trace is closed
+static struct trace_buf trace_bufs[TRACE_NBUFS]; //!< ring of buffers
+static int trace_cur = 0;                    //!< buffer filled by the accesses
+static int trace_queued = 0;                 //!< buffers handed over, they precede trace_cur in the ring
+static bool trace_stop = false;              //!< writer thread terminates, when the queue is empty
+static long trace_next = 0;                  //!< end of the last event
+static pthread_t trace_thread;               //!< writer thread
+static pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER; //!< protects the ring
+static pthread_cond_t trace_cond = PTHREAD_COND_INITIALIZER;    //!< signaled, when a buffer has been handed over or written
+
+/**
+ * Live statistics of mmanage -stats. The counters of this address space are shared by
+ * the threads of the process and updated by relaxed atomic operations.
+ */
+static struct livestats *livestats = NULL;   //!< NULL: mmanage provides no live statistics
+static struct livestats_client *live = NULL; //!< counters of this address space
+
+/**
+ *****************************************************************************************
+ *  @brief      This function adds the TLB statistics of the current thread to the 
+ *              shared memory, so the memory manager can report them. It will be called
+ *              on exit and, in thread safe mode, on thread exit.
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void tlb_publish_stats(void) {
+    if (vmem != NULL) {
+        __atomic_add_fetch(&vmem->client->tlb.hits, tlb_stats.hits, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&vmem->client->tlb.misses, tlb_stats.misses, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&vmem->client->tlb.shootdowns, tlb_stats.shootdowns, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&vmem->client->tlb.walks, tlb_stats.walks, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&vmem->client->tlb.huge_hits, tlb_stats.huge_hits, __ATOMIC_RELAXED);
+        memset(&tlb_stats, 0, sizeof(tlb_stats));
+    }
+}
+
+static void tlb_thread_exit(void *arg) {
+    tlb_publish_stats();
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function publishes the statistics and releases the address space
+ *              on exit. An address space will not be used again by another client.
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void vmem_detach(void) {
+    tlb_publish_stats();
+    __atomic_store_n(&vmem->client->state, VMEM_CLIENT_DETACHED, __ATOMIC_SEQ_CST);
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function reserves the first free address space of shared memory.
+ *
+ *  @return     ASID of the address space
+ ****************************************************************************************/
+static int reserve_address_space(void) {
+    for (int i = 0; i < VMEM_NCLIENTS; i++) {
+        int expected = VMEM_CLIENT_FREE;
+        if (__atomic_compare_exchange_n(&vmem->header->clients[i].state, &expected, VMEM_CLIENT_ATTACHED,
+                                        false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+            return i;
+        }
+    }
+    TEST_AND_EXIT(true, (stderr, "vmem_init: all %d address spaces of mmanage have been used\n", VMEM_NCLIENTS));
+    return VOID_IDX;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function claims the first free address space of shared memory.
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void claim_address_space(void) {
+    asid = reserve_address_space();
+    vmem->client = &vmem->header->clients[asid];
+    vmem->client->pid = getpid();
+    setSyncClient(asid);
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function selects the accessors specialized for the page size of
+ *              vmem_geometry, see access_ops.
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void select_access(void);
 
 /**
  *****************************************************************************************
@@ -42,35 +210,552 @@ static int shm_id = -1;
 static void vmem_init(void) {
 
     //printf("vmem_init\n");
-    /* Create System V shared memory */
-
-    /* We are only using the shm, don't set the IPC_CREAT flag */
-	key_t shm_key = ftok(SHMKEY, SHMPROCID);
-	TEST_AND_EXIT_ERRNO(shm_key == -1, "ftok failed!");
-	shm_id = shmget(shm_key, sizeof(struct vmem_struct), 0664);
-	
-	if (shm_id == -1){
-		fprintf(stderr, "Shared memory from old run might still exists\n");
-		fprintf(stderr, "   Use ipcs -ma for checking shared memory ressources\n");
-		fprintf(stderr, "   Use ipcrm for deleting shared memory ressources\n");
-	}
-	
-    /* Attach shared memory to vmem (virtual memory) */
-	TEST_AND_EXIT_ERRNO(shm_id == -1, "shmget failed!");
-	PRINT_DEBUG((stderr, "shmget successfuly allocated %lu bytes\n", sizeof(struct msg)));
-	vmem = (struct vmem_struct *) shmat(shm_id, NULL, 0);
-	TEST_AND_EXIT_ERRNO(vmem == (struct vmem_struct *) -1, "Error attaching shared memory");
+    /* Attach shared memory to vmem (virtual memory), whatever backing mmanage has chosen */
+	void *shm = vmem_shm_attach();
 	PRINT_DEBUG((stderr, "Shared memory successfuly attached\n"));
+
+    /* Take geometry from header of shared memory */
+    struct vmem_geometry *g = &((struct vmem_header *) shm)->geometry;
+    TEST_AND_EXIT(!vmem_set_geometry(g->pagesize, g->virtmemsize, g->physmemsize, g->nclients, g->hugepages),
+                  (stderr, "vmem_init: geometry of mmanage (page size %d, virtual memory %ld, physical memory %d) not supported\n",
+                   g->pagesize, g->virtmemsize, g->physmemsize));
+    for (int i = 0; i < SYNC_NSLOTS; i++) {
+        fault_pending[i] = VOID_IDX;
+    }
+    vmem_map(&vmem_view, shm);
+    select_access();
+    vmem = &vmem_view;
+    claim_address_space();
+    g_count = vmem->client->g_count; // continues the run of a restored checkpoint
+    livestats = livestats_attach(true);
+    if (livestats != NULL) {
+        live = &livestats->clients[asid];
+    }
+    atexit(vmem_detach);
+    if (VMEM_NCLIENTS > 1) {
+        // the memory manager may remove pages of this process while it is running
+        vmem_enable_threads();
+    }
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function initializes the TLB of the current thread at its first use.
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void tlb_thread_init(void) {
+    if (tlb_ready) {
+        return;
+    }
+    for (int i = 0; i < tlb_sets * tlb_ways; i++) {
+        tlb[i].page = VOID_IDX;
+    }
+    tlb_evict_epoch = __atomic_load_n(&vmem->adm->tlb_evict_epoch, __ATOMIC_SEQ_CST);
+    tlb_ref_epoch = __atomic_load_n(&vmem->adm->tlb_ref_epoch, __ATOMIC_SEQ_CST);
+    if (mt_mode) {
+        pthread_setspecific(tlb_key, tlb); // any non NULL value triggers tlb_thread_exit
+    }
+    tlb_ready = true;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function checks the shootdown epochs of the memory manager.
+ *              If pages have been removed, all entries whose translation is no longer
+ *              valid will be invalidated. If Ref bits have been reset, Ref bits 
+ *              must be written again.
+ *              In thread safe mode a page may have been removed and fetched again into
+ *              the same frame by the faults of other threads. Hence the whole TLB will
+ *              be flushed. An entry of a huge page is invalid, when the huge page has
+ *              been demoted.
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void tlb_sync(void) {
+    unsigned long epoch = __atomic_load_n(&vmem->adm->tlb_evict_epoch, __ATOMIC_SEQ_CST);
+    if (epoch != tlb_evict_epoch) {
+        tlb_evict_epoch = epoch;
+        tlb_stats.shootdowns++;
+        for (int i = 0; i < tlb_sets * tlb_ways; i++) {
+            struct pt_entry *pte = (tlb[i].page != VOID_IDX) ? vmem_pte(vmem, asid, tlb[i].page) : NULL;
+            if ((pte != NULL) && (mt_mode || !(pte_flags(pte) & PTF_PRESENT) || (pte_frame(pte) != tlb[i].frame) ||
+                                  (tlb[i].huge && !(pte_flags(pte) & PTF_HUGE)))) {
+                tlb[i].page = VOID_IDX;
+            }
+        }
+    }
+    epoch = __atomic_load_n(&vmem->adm->tlb_ref_epoch, __ATOMIC_SEQ_CST);
+    if (epoch != tlb_ref_epoch) {
+        tlb_ref_epoch = epoch;
+        for (int i = 0; i < tlb_sets * tlb_ways; i++) {
+            tlb[i].ref_set = 0;
+        }
+    }
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function computes the first page of the run of a huge page.
+ *
+ *  @param      page page of the run
+ *
+ *  @return     first page of the run
+ ****************************************************************************************/
+static long huge_head(long page) {
+    return page & ~(long) (VMEM_HUGEPAGES - 1);
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the set of the TLB of a page. The entries of 
+ *              huge pages are spread by the number of their run.
+ *
+ *  @param      page page, first page of the run of a huge page
+ *  @param      huge page is the first page of the run of a huge page
+ *
+ *  @return     first entry of the set
+ ****************************************************************************************/
+static struct tlb_entry *tlb_set(long page, bool huge) {
+    long tag = huge ? page / VMEM_HUGEPAGES : page;
+    return &tlb[(tag % tlb_sets) * tlb_ways];
 }
 
-static void send_message(int cmd, int val) {
+/**
+ *****************************************************************************************
+ *  @brief      This function looks up a page in the TLB. The entry of the page or,
+ *              with huge pages, the entry of the run of the page will be returned.
+ *
+ *  @param      page page to be translated
+ *
+ *  @return     TLB entry of the page or NULL
+ ****************************************************************************************/
+static struct tlb_entry *tlb_lookup(long page) {
+    struct tlb_entry *set = tlb_set(page, false);
+    for (int i = 0; i < tlb_ways; i++) {
+        if ((set[i].page == page) && !set[i].huge) {
+            set[i].last_use = ++tlb_clock;
+            return &set[i];
+        }
+    }
+    if (VMEM_HUGEPAGES > 0) {
+        long head = huge_head(page);
+        set = tlb_set(head, true);
+        for (int i = 0; i < tlb_ways; i++) {
+            if ((set[i].page == head) && set[i].huge) {
+                set[i].last_use = ++tlb_clock;
+                return &set[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function checks, whether a TLB entry caches the translation of a page.
+ *
+ *  @param      e TLB entry
+ *  @param      page page to be translated
+ *
+ *  @return     true, if e caches page
+ ****************************************************************************************/
+static bool tlb_covers(const struct tlb_entry *e, long page) {
+    return e->huge ? (e->page == huge_head(page)) : (e->page == page);
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function translates a page by a TLB entry.
+ *
+ *  @param      e TLB entry that caches the page
+ *  @param      page page to be translated
+ *
+ *  @return     frame that stores the page
+ ****************************************************************************************/
+static int tlb_frame(const struct tlb_entry *e, long page) {
+    return e->frame + (int) (page - e->page);
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function stores the translation of a present page in the TLB.
+ *              The least recently used entry of the set will be replaced.
+ *              A page of a huge page is cached by an entry of its run.
+ *
+ *  @param      page page to be cached
+ *  @param      pte page table entry of the page
+ *
+ *  @return     TLB entry of the page
+ ****************************************************************************************/
+static struct tlb_entry *tlb_insert(long page, struct pt_entry *pte) {
+    bool huge = (pte_flags(pte) & PTF_HUGE) != 0;
+    long head = huge ? huge_head(page) : page;
+    struct tlb_entry *set = tlb_set(head, huge);
+    struct tlb_entry *victim = &set[0];
+    for (int i = 0; i < tlb_ways; i++) {
+        if (set[i].page == VOID_IDX) {
+            victim = &set[i];
+            break;
+        }
+        if (set[i].last_use < victim->last_use) {
+            victim = &set[i];
+        }
+    }
+    victim->page = head;
+    victim->frame = pte_frame(pte) - (int) (page - head);
+    victim->huge = huge;
+    victim->last_use = ++tlb_clock;
+    victim->ref_set = 0;
+    victim->dirty_sectors = 0;
+    return victim;
+}
+
+static void send_message(int cmd, long val, long count) {
     //printf("sending msg: %d, val: %d\n", cmd, val);
     struct msg message;
     message.cmd = cmd;
     message.value = val;
-    message.g_count = g_count;
-    message.ref = g_count + val;
+    message.g_count = count;
+    message.ref = count + val;
+    if (live == NULL) {
+        sendMsgToMmanager(message);
+        return;
+    }
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
     sendMsgToMmanager(message);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    livestats_add(&live->ipc_round_trips, 1);
+    livestats_add(&live->ipc_wait_ns, (end.tv_sec - start.tv_sec) * 1000000000L + (end.tv_nsec - start.tv_nsec));
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function releases a frame pinned by vmem_pin_page.
+ *
+ *  @param      frame pinned frame
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void vmem_unpin_page(int frame) {
+    if (mt_mode) {
+        __atomic_sub_fetch(&vmem->busy[frame], 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function advances g_count. For each multiple of TIME_WINDOW that 
+ *              has been reached, the time window message will be sent.
+ *              The pinned frame of the caller will be released before the first 
+ *              message, see vmem_pin_page.
+ *
+ *  @param      ticks Number of accesses
+ *  @param      frame pinned frame
+ *
+ *  @return     true, if a message has been sent and the frame has been released
+ ****************************************************************************************/
+static bool advance_gcount(int ticks, int frame) {
+    long now = __atomic_add_fetch(&g_count, ticks, __ATOMIC_RELAXED);
+    long w = ((now - ticks) / TIME_WINDOW + 1) * TIME_WINDOW;
+    if (live != NULL) {
+        livestats_add(&live->ticks, ticks);
+    }
+    if (w > now) {
+        return false;
+    }
+    vmem_unpin_page(frame);
+    for (; w <= now; w += TIME_WINDOW) {
+        send_message(CMD_TIME_INTER_VAL, w, w);
+        if (tlb_sets > 0) {
+            tlb_sync(); // aging may have reset Ref bits
+        }
+    }
+    return true;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function sets the access bits of a frame. The page table is 
+ *              written by mmanage only. In thread safe mode the bits will be updated
+ *              atomically.
+ *
+ *  @param      frame frame that stores the accessed page
+ *  @param      flags PTF_REF and PTF_DIRTY flags to be set
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void set_access_bits(int frame, int flags) {
+    if (mt_mode) {
+        __atomic_fetch_or(&vmem->access_bits[frame], flags, __ATOMIC_RELAXED);
+    } else {
+        vmem->access_bits[frame] |= flags;
+    }
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function checks the present bit of a page.
+ *
+ *  @param      page page to be checked
+ *
+ *  @return     true, if the page is present
+ ****************************************************************************************/
+static bool page_present(long page) {
+    struct pt_entry *pte = vmem_pte(vmem, asid, page);
+    return (pte != NULL) && (pte_flags(pte) & PTF_PRESENT);
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function checks, whether a request for a page is outstanding.
+ *              There is at most one outstanding request per slot. In thread safe
+ *              mode the caller must hold fault_mutex.
+ *
+ *  @param      page page to be checked
+ *
+ *  @return     true, if a request is outstanding
+ ****************************************************************************************/
+static bool fault_is_pending(long page) {
+    for (int i = 0; i < SYNC_NSLOTS; i++) {
+        if (fault_pending[i] == page) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function marks a page as requested or answered.
+ *
+ *  @param      page page of request
+ *  @param      pending true: request has been sent; false: request has been answered
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void set_fault_pending(long page, bool pending) {
+    long old = pending ? VOID_IDX : page;
+    for (int i = 0; i < SYNC_NSLOTS; i++) {
+        if (fault_pending[i] == old) {
+            fault_pending[i] = pending ? page : VOID_IDX;
+            return;
+        }
+    }
+    TEST_AND_EXIT(true, (stderr, "set_fault_pending: more than %d outstanding requests\n", SYNC_NSLOTS));
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function increments a counter of the shared administrative data.
+ *
+ *  @param      counter counter in vmem->adm
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void count_adm(long *counter) {
+    if (mt_mode) {
+        __atomic_add_fetch(counter, 1, __ATOMIC_RELAXED);
+    } else {
+        (*counter)++;
+    }
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns a slot of the pool without outstanding request. 
+ *              The pool grows until all slots of syncdataexchange are in use.
+ *
+ *  @return     slot; -1, if all slots of the pool have outstanding requests
+ ****************************************************************************************/
+static int async_free_slot(void) {
+    for (int i = 0; i < async_nslots; i++) {
+        if (slot_page[async_slots[i]] == VOID_IDX) {
+            return async_slots[i];
+        }
+    }
+    int slot = allocSlot();
+    if (slot != -1) {
+        async_slots[async_nslots++] = slot;
+        slot_page[slot] = VOID_IDX;
+    }
+    return slot;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function handles a page fault of a coroutine in asynchronous mode. 
+ *              The request will be posted without waiting and the coroutine blocks
+ *              until the page is present. Other coroutines keep running meanwhile.
+ *              Faults on a page with an outstanding request are coalesced.
+ *
+ *  @param      page page that is not present
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void vmem_fault_async(long page) {
+    int id = co_current();
+    int slot = -1;
+
+    if (fault_is_pending(page)) {
+        count_adm(&vmem->client->coalesced_faults);
+    } else {
+        if (page_present(page)) {
+            return;
+        }
+        while ((slot = async_free_slot()) == -1) {
+            co_wait[id] = ASYNC_WAIT_SLOT;
+            co_block();
+        }
+        struct msg message;
+        message.cmd = CMD_PAGEFAULT;
+        message.value = page;
+        message.g_count = __atomic_load_n(&g_count, __ATOMIC_RELAXED);
+        postMsgToMmanager(message, slot);
+        if (live != NULL) {
+            livestats_add(&live->ipc_round_trips, 1);
+        }
+        set_fault_pending(page, true);
+        slot_page[slot] = page;
+    }
+    while (fault_is_pending(page)) {
+        co_wait[id] = page;
+        co_block();
+    }
+    co_wait[id] = ASYNC_WAIT_NONE;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function is the idle function of the coroutine scheduler. It waits
+ *              for an ACK of the memory manager and wakes up all coroutines waiting for
+ *              the pages that have been fetched.
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void vmem_async_idle(void) {
+    waitForAnyAck();
+    for (int i = 0; i < async_nslots; i++) {
+        int slot = async_slots[i];
+        long page = slot_page[slot];
+        if ((page != VOID_IDX) && pollAckFromMmanager(slot)) {
+            slot_page[slot] = VOID_IDX;
+            set_fault_pending(page, false);
+            for (int id = 0; id < CO_MAX; id++) {
+                if ((co_wait[id] == page) || (co_wait[id] == ASYNC_WAIT_SLOT)) {
+                    co_wait[id] = ASYNC_WAIT_NONE;
+                    co_wake(id);
+                }
+            }
+        }
+    }
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function sends a page fault request for a page to the memory 
+ *              manager. In thread safe mode, a thread that faults on a page with an 
+ *              outstanding request waits for that request instead of sending its own.
+ *
+ *  @param      page page that is not present
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void vmem_fault(long page) {
+    if (async_mode && (co_current() != CO_NONE)) {
+        vmem_fault_async(page);
+        return;
+    }
+    if (mt_mode) {
+        pthread_mutex_lock(&fault_mutex);
+        if (fault_is_pending(page)) {
+            count_adm(&vmem->client->coalesced_faults);
+            while (fault_is_pending(page)) {
+                pthread_cond_wait(&fault_done, &fault_mutex);
+            }
+            pthread_mutex_unlock(&fault_mutex);
+            return;
+        }
+        if (page_present(page)) {
+            // request of another thread has been answered in the meantime
+            pthread_mutex_unlock(&fault_mutex);
+            return;
+        }
+        set_fault_pending(page, true);
+        pthread_mutex_unlock(&fault_mutex);
+    }
+
+    send_message(CMD_PAGEFAULT, page, __atomic_load_n(&g_count, __ATOMIC_RELAXED));
+
+    if (mt_mode) {
+        pthread_mutex_lock(&fault_mutex);
+        set_fault_pending(page, false);
+        pthread_cond_broadcast(&fault_done);
+        pthread_mutex_unlock(&fault_mutex);
+    } else if (tlb_sets > 0) {
+        tlb_sync(); // pages have been removed
+    }
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function makes sure that a page is present and returns its frame.
+ *              In thread safe mode the frame will be pinned: the busy counter of the 
+ *              frame will be incremented before the present bit and the frame of the
+ *              page are checked again. The memory manager clears the present bit first 
+ *              and then waits until no thread is busy on the frame. A pinned frame must
+ *              be released by vmem_unpin_page before the next message will be sent to
+ *              the memory manager.
+ *
+ *  @param      page page to be pinned
+ *  @param      e TLB entry of the page; it will be updated, if the TLB is enabled
+ *
+ *  @return     frame that stores the page
+ ****************************************************************************************/
+static int vmem_pin_page(long page, struct tlb_entry **e) {
+    struct pt_entry *pte = NULL;
+    int frame = VOID_IDX;
+
+    if (!mt_mode) {
+        if (*e != NULL) {
+            return tlb_frame(*e, page);
+        }
+        // check ob page(adresse) ist im vmem, wenn nicht page fault senden
+        pte = vmem_pte(vmem, asid, page);
+        if ((pte == NULL) || !(pte_flags(pte) & PTF_PRESENT)) {
+            vmem_fault(page);
+            pte = vmem_pte(vmem, asid, page);
+        }
+        if (tlb_sets > 0) {
+            *e = tlb_insert(page, pte);
+        }
+        return pte_frame(pte);
+    }
+
+    while (true) {
+        pte = vmem_pte(vmem, asid, page);
+        uint32_t word = (pte != NULL) ? __atomic_load_n(&pte->word, __ATOMIC_SEQ_CST) : 0;
+        if (word & PTF_PRESENT) {
+            // flags and frame have been read together, the entry must be unchanged after pinning
+            frame = (int) (word >> PTE_FLAG_BITS) - 1;
+            __atomic_add_fetch(&vmem->busy[frame], 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&pte->word, __ATOMIC_SEQ_CST) == word) {
+                break;
+            }
+            __atomic_sub_fetch(&vmem->busy[frame], 1, __ATOMIC_SEQ_CST);
+        } else {
+            vmem_fault(page);
+        }
+    }
+    if (tlb_sets > 0) {
+        tlb_sync();
+        if ((*e == NULL) || !tlb_covers(*e, page)) {
+            *e = tlb_insert(page, pte);
+        }
+    }
+    return frame;
 }
 
 /**
@@ -81,73 +766,670 @@ static void send_message(int cmd, int val) {
  *              will be send to the memory manager. 
  *              To keep conform with this log files, g_count must be increased before 
  *              the time window will be checked.
- *              vmem_read and vmem_write call this function.
+ *              vmem_read and vmem_write call this function for one access, the range
+ *              functions for all accesses to one page.
+ *              In mode VMEM_TICKS_BULK g_count will be advanced from time window to 
+ *              time window. The Ref bit will be set again before each window, hence
+ *              the memory manager sees the same page table as for single accesses.
+ *              If the TLB is enabled, a TLB hit skips the page table and Ref bit will
+ *              be written only once per time window.
+ *              The page will be returned pinned, see vmem_pin_page.
  *
  *  @param      page The page that stores the contents of this address will be 
  *              put in (if required).
+ *
+ *  @param      naccess Number of consecutive accesses to this page.
+ *
+ *  @param      tlb_e TLB entry of the page or NULL, if not required. The entry is NULL,
+ *              if the TLB is disabled or does not cache the page.
  * 
+ *  @return     frame that stores the page
+ ****************************************************************************************/
+static int vmem_put_page_into_mem(long page, int naccess, struct tlb_entry **tlb_e) {
+    struct tlb_entry *e = NULL;
+	TEST_AND_EXIT_ERRNO((page < 0) || (page >= VMEM_NPAGES), "Page out of bounds!");
+
+    if (tlb_sets > 0) {
+        tlb_thread_init();
+        if (!mt_mode) {
+            tlb_sync();
+        }
+        e = tlb_lookup(page);
+        if (e != NULL) {
+            tlb_stats.hits++;
+            tlb_stats.huge_hits += e->huge;
+        } else {
+            tlb_stats.misses++;
+        }
+    }
+    if (e == NULL) {
+        tlb_stats.walks++;
+    }
+
+    int frame = vmem_pin_page(page, &e);
+    while (naccess > 0) {
+        int ticks = 1;
+        if (tick_mode == VMEM_TICKS_BULK) {
+            // ticks up to and including the next time window
+            ticks = TIME_WINDOW - (__atomic_load_n(&g_count, __ATOMIC_RELAXED) % TIME_WINDOW);
+            if (ticks > naccess) {
+                ticks = naccess;
+            }
+        }
+        if (e == NULL) {
+            set_access_bits(frame, PTF_REF);
+        } else if (!(e->ref_set & ((uint64_t) 1 << (page - e->page)))) {
+            set_access_bits(frame, PTF_REF);
+            e->ref_set |= (uint64_t) 1 << (page - e->page);
+        }
+        naccess -= ticks;
+        // the time window message must not be sent while the page is pinned
+        if (advance_gcount(ticks, frame)) {
+            if ((e != NULL) && !tlb_covers(e, page)) {
+                e = NULL; // entry has been invalidated, the page may have been moved or merged
+            }
+            frame = vmem_pin_page(page, &e);
+        } else if (mt_mode && (e != NULL)) {
+            tlb_sync(); // window messages of other threads may have reset Ref bits
+            if (!tlb_covers(e, page)) {
+                e = NULL;
+            }
+        }
+    }
+    if (tlb_e != NULL) {
+        *tlb_e = e;
+    }
+    return frame;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function asks the memory manager for a copy of a page, whose frame
+ *              is shared by merged pages (copy on write). The frame will be released 
+ *              while the request is served.
+ *
+ *  @param      page Page that is stored in frame
+ *  @param      frame Shared frame, pinned
+ *  @param      e TLB entry of the page afterwards or NULL
+ *
+ *  @return     frame that stores the page afterwards, pinned
+ ****************************************************************************************/
+static int vmem_unshare_page(long page, int frame, struct tlb_entry **e) {
+    *e = NULL;
+    vmem_unpin_page(frame);
+    send_message(CMD_COW, page, __atomic_load_n(&g_count, __ATOMIC_RELAXED));
+    if (tlb_sets > 0) {
+        if (!mt_mode) {
+            tlb_sync(); // page has been moved into a frame of its own
+        }
+        *e = tlb_lookup(page);
+    }
+    return vmem_pin_page(page, e);
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function writes bytes into a frame. Bytes that are equal to the 
+ *              contents of memory will be skipped (silent stores). Only if a byte
+ *              changes, the page gets dirty.
+ *
+ *              The Dirty bit and the dirty sectors of a page will be written only
+ *              once while the page is cached by the TLB, unless it is cached by the 
+ *              entry of a huge page.
+ *
+ *              If the frame is shared by merged pages, the page gets a copy of its own 
+ *              before the first byte changes, see vmem_unshare_page.
+ *
+ *  @param      page Page that is stored in frame
+ *  @param      frame Frame returned by vmem_put_page_into_mem
+ *  @param      e TLB entry returned by vmem_put_page_into_mem
+ *  @param      offset Offset of first byte within page
+ *  @param      data Bytes to be written
+ *  @param      len Number of bytes
+ *
+ *  @return     frame that stores the page afterwards, pinned
+ ****************************************************************************************/
+static int write_to_frame(long page, int frame, struct tlb_entry *e, int offset, const unsigned char *data, int len) {
+    TEST_AND_EXIT_ERRNO(frame >= VMEM_NFRAMES, "Frame out of bounds!");
+    if ((e != NULL) && e->huge) {
+        e = NULL; // dirty sectors are cached for base pages only
+    }
+    unsigned char *mem = &vmem->mainMemory[frame * VMEM_GEO_PAGESIZE];
+
+    for (int i = offset; i < offset + len; i++) {
+        // silent store: page stays clean, if memory contains the value already
+        if (mem[i] == data[i - offset]) {
+            count_adm(&vmem->client->silent_stores);
+            continue;
+        }
+        if (__atomic_load_n(&vmem->access_bits[frame], __ATOMIC_SEQ_CST) & PTF_SHARED) {
+            frame = vmem_unshare_page(page, frame, &e);
+            if ((e != NULL) && e->huge) {
+                e = NULL;
+            }
+            mem = &vmem->mainMemory[frame * VMEM_GEO_PAGESIZE];
+            i--; // the copy is checked again
+            continue;
+        }
+        uint64_t sector = (uint64_t) 1 << (i / VMEM_GEO_SECTORSIZE);
+        if ((e == NULL) || !(e->dirty_sectors & sector)) {
+            set_access_bits(frame, PTF_DIRTY);
+            if (mt_mode) {
+                __atomic_fetch_or(&vmem->dirty_sectors[frame], sector, __ATOMIC_RELAXED);
+            } else {
+                vmem->dirty_sectors[frame] |= sector;
+            }
+            if (e != NULL) {
+                e->dirty_sectors |= sector;
+            }
+        }
+        mem[i] = data[i - offset];
+    }
+    return frame;
+}
+
+
+/**
+ *****************************************************************************************
+ *  @brief      This function is the writer thread of the recorder. It writes the 
+ *              buffers handed over in the order of the ring.
+ *
+ *  @param      arg unused
+ *
+ *  @return     NULL
+ ****************************************************************************************/
+static void *trace_writer(void *arg) {
+    pthread_mutex_lock(&trace_mutex);
+    while (true) {
+        while ((trace_queued == 0) && !trace_stop) {
+            pthread_cond_wait(&trace_cond, &trace_mutex);
+        }
+        if (trace_queued == 0) {
+            break;
+        }
+        struct trace_buf *b = &trace_bufs[(trace_cur - trace_queued + TRACE_NBUFS) % TRACE_NBUFS];
+        pthread_mutex_unlock(&trace_mutex);
+        TEST_AND_EXIT_ERRNO(write(trace_fd, b->data, b->len) != (ssize_t) b->len, "vmem_trace: write failed");
+        pthread_mutex_lock(&trace_mutex);
+        b->len = 0;
+        trace_queued--;
+        pthread_cond_broadcast(&trace_cond);
+    }
+    pthread_mutex_unlock(&trace_mutex);
+    return NULL;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function hands the current buffer over to the writer thread and 
+ *              waits for a free buffer. The caller must hold trace_mutex.
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void trace_handover(void) {
+    trace_queued++;
+    pthread_cond_broadcast(&trace_cond);
+    while (trace_queued == TRACE_NBUFS) {
+        pthread_cond_wait(&trace_cond, &trace_mutex);
+    }
+    trace_cur = (trace_cur + 1) % TRACE_NBUFS;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function records an access, if the recorder is enabled.
+ *
+ *  @param      address The virtual memory address of the first byte
+ *  @param      len Number of bytes
+ *  @param      kind Kind of the event, see trace.h
+ *
  *  @return     void
  ****************************************************************************************/
-static void inc_gcount() {
-    g_count++;
-    if ((g_count % TIME_WINDOW) == 0) {
-        send_message(CMD_TIME_INTER_VAL, g_count);
+static void trace_record(long address, int len, int kind) {
+    if (!trace_on) {
+        return;
+    }
+    struct trace_event ev = { address, len, kind };
+    if (mt_mode) {
+        pthread_mutex_lock(&trace_mutex);
+    }
+    struct trace_buf *b = &trace_bufs[trace_cur];
+    if (TRACE_BUFSIZE - b->len < TRACE_MAXEVENT) {
+        if (!mt_mode) {
+            pthread_mutex_lock(&trace_mutex);
+        }
+        trace_handover();
+        if (!mt_mode) {
+            pthread_mutex_unlock(&trace_mutex);
+        }
+        b = &trace_bufs[trace_cur];
+    }
+    b->len += trace_encode(&b->data[b->len], &ev, &trace_next);
+    trace_hdr.events++;
+    trace_hdr.accesses += trace_accesses(&ev);
+    if (mt_mode) {
+        pthread_mutex_unlock(&trace_mutex);
     }
 }
-static void vmem_put_page_into_mem(int page) {
-	TEST_AND_EXIT_ERRNO(page > VMEM_NPAGES, "Page out of bounds!");
-    // check ob page(adresse) ist im vmem
-    if (!(vmem->pt[page].flags & PTF_PRESENT)) {
-        send_message(CMD_PAGEFAULT, page);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function closes the trace on exit. The last buffer will be written
+ *              and the header gets the number of events.
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void trace_close(void) {
+    if (!trace_on) {
+        return;
     }
+    trace_on = false;
+    pthread_mutex_lock(&trace_mutex);
+    if (trace_bufs[trace_cur].len > 0) {
+        trace_handover();
+    }
+    trace_stop = true;
+    pthread_cond_broadcast(&trace_cond);
+    pthread_mutex_unlock(&trace_mutex);
+    pthread_join(trace_thread, NULL);
+    TEST_AND_EXIT_ERRNO(pwrite(trace_fd, &trace_hdr, sizeof(trace_hdr), 0) != sizeof(trace_hdr), "vmem_trace: write failed");
+    TEST_AND_EXIT_ERRNO(close(trace_fd) == -1, "vmem_trace: close failed");
+}
 
-    // wenn nicht page fault senden
+/**
+ * Accessors for common page sizes. ACCESS_VARIANT defines the byte and value accessors
+ * for a page shift. Instantiated with a constant shift, the split of the address into
+ * page number and offset and the address within the frame are computed by shifts and
+ * masks of immediates. The lookup of the frame by vmem_put_page_into_mem and vmem_pte
+ * works on page numbers and is shared by all variants. vmem_init selects the variant 
+ * of the page size of mmanage once, see select_access. Other page sizes take the 
+ * shift from vmem_geometry.
+ * 
+ * read_value and write_value read and write a value of up to 8 bytes in little endian
+ * byte order. Each page holding a part of the value will be accessed once.
+ */
+struct access_ops {
+    int page_shift;                                              //!< page shift of variant; VOID_IDX: any
+    unsigned char (*read)(long address);                         //!< see vmem_read
+    void (*write)(long address, unsigned char data);             //!< see vmem_write
+    uint64_t (*read_value)(long address, int size);              //!< value of size bytes at address
+    void (*write_value)(long address, int size, uint64_t value); //!< stores value of size bytes at address
+};
 
-    vmem->pt[page].flags |= PTF_REF;
-    vmem->pt[page].flags |= PTF_PRESENT;
-    inc_gcount();
+#define ACCESS_VARIANT(name, SHIFT)                                                       \
+static unsigned char read_##name(long address) {                                          \
+    trace_record(address, 1, 0);                                                          \
+    int frame = vmem_put_page_into_mem(address >> (SHIFT), 1, NULL);                      \
+    TEST_AND_EXIT_ERRNO(frame >= VMEM_NFRAMES, "Frame out of bounds!");                   \
+    unsigned char data = vmem->mainMemory[((long) frame << (SHIFT)) + (address & ((1L << (SHIFT)) - 1))]; \
+    vmem_unpin_page(frame);                                                               \
+    return data;                                                                          \
+}                                                                                         \
+                                                                                          \
+static void write_##name(long address, unsigned char data) {                              \
+    trace_record(address, 1, TRACE_WRITE);                                                \
+    long page = address >> (SHIFT);                                                       \
+    struct tlb_entry *e;                                                                  \
+    int frame = vmem_put_page_into_mem(page, 1, &e);                                      \
+    frame = write_to_frame(page, frame, e, address & ((1L << (SHIFT)) - 1), &data, 1);    \
+    vmem_unpin_page(frame);                                                               \
+}                                                                                         \
+                                                                                          \
+static uint64_t read_value_##name(long address, int size) {                               \
+    unsigned char bytes[sizeof(uint64_t)];                                                \
+    uint64_t value = 0;                                                                   \
+                                                                                          \
+    TEST_AND_EXIT((address < 0) || (address + size > VMEM_VIRTMEMSIZE), (stderr, "vmem_read: address out of bounds\n")); \
+    trace_record(address, size, TRACE_VALUE);                                            \
+    long page = address >> (SHIFT);                                                       \
+    int offset = address & ((1L << (SHIFT)) - 1);                                         \
+    int n = (offset + size <= (1L << (SHIFT))) ? size : (1L << (SHIFT)) - offset;         \
+                                                                                          \
+    int frame = vmem_put_page_into_mem(page, 1, NULL);                                    \
+    memcpy(bytes, &vmem->mainMemory[((long) frame << (SHIFT)) + offset], n);              \
+    vmem_unpin_page(frame);                                                               \
+    if (n < size) {                                                                       \
+        /* value straddles page boundary */                                               \
+        count_adm(&vmem->client->straddles);                                              \
+        frame = vmem_put_page_into_mem(page + 1, 1, NULL);                                \
+        memcpy(&bytes[n], &vmem->mainMemory[(long) frame << (SHIFT)], size - n);          \
+        vmem_unpin_page(frame);                                                           \
+    }                                                                                     \
+    for (int i = size - 1; i >= 0; i--) {                                                 \
+        value = (value << 8) | bytes[i];                                                  \
+    }                                                                                     \
+    return value;                                                                         \
+}                                                                                         \
+                                                                                          \
+static void write_value_##name(long address, int size, uint64_t value) {                  \
+    unsigned char bytes[sizeof(uint64_t)];                                                \
+                                                                                          \
+    TEST_AND_EXIT((address < 0) || (address + size > VMEM_VIRTMEMSIZE), (stderr, "vmem_write: address out of bounds\n")); \
+    trace_record(address, size, TRACE_VALUE | TRACE_WRITE);                               \
+    for (int i = 0; i < size; i++) {                                                      \
+        bytes[i] = value & 0xFF;                                                          \
+        value >>= 8;                                                                      \
+    }                                                                                     \
+    long page = address >> (SHIFT);                                                       \
+    int offset = address & ((1L << (SHIFT)) - 1);                                         \
+    int n = (offset + size <= (1L << (SHIFT))) ? size : (1L << (SHIFT)) - offset;         \
+                                                                                          \
+    struct tlb_entry *e;                                                                  \
+    int frame = vmem_put_page_into_mem(page, 1, &e);                                      \
+    frame = write_to_frame(page, frame, e, offset, bytes, n);                             \
+    vmem_unpin_page(frame);                                                               \
+    if (n < size) {                                                                       \
+        /* value straddles page boundary */                                               \
+        count_adm(&vmem->client->straddles);                                              \
+        frame = vmem_put_page_into_mem(page + 1, 1, &e);                                  \
+        frame = write_to_frame(page + 1, frame, e, 0, &bytes[n], size - n);               \
+        vmem_unpin_page(frame);                                                           \
+    }                                                                                     \
 }
 
+#define ACCESS_OPS(name, shift) { shift, read_##name, write_##name, read_value_##name, write_value_##name }
 
-unsigned char vmem_read(int address) {
+ACCESS_VARIANT(8, 3)
+ACCESS_VARIANT(16, 4)
+ACCESS_VARIANT(32, 5)
+ACCESS_VARIANT(64, 6)
+ACCESS_VARIANT(4096, 12)
+ACCESS_VARIANT(any, VMEM_PAGESHIFT)
+
+static const struct access_ops access_variants[] = {
+    ACCESS_OPS(8, 3), ACCESS_OPS(16, 4), ACCESS_OPS(32, 5), ACCESS_OPS(64, 6), ACCESS_OPS(4096, 12)
+};
+static struct access_ops accessors = ACCESS_OPS(any, VOID_IDX); //!< accessors of the page size, set by select_access
+
+static void select_access(void) {
+    for (int i = 0; i < (int) (sizeof(access_variants) / sizeof(access_variants[0])); i++) {
+        if (access_variants[i].page_shift == VMEM_PAGESHIFT) {
+            accessors = access_variants[i];
+        }
+    }
+}
+
+unsigned char vmem_read(long address) {
 	if (vmem == NULL) {
 		vmem_init();
 	}
+    return accessors.read(address);
+}
 
-	int page = address / VMEM_PAGESIZE;
+void vmem_write(long address, unsigned char data) {
+	if (vmem == NULL) {
+		vmem_init();
+	}
+    accessors.write(address, data);
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function reads a value of up to 8 bytes, see access_ops.
+ *
+ *  @param      address The virtual memory address of the lowest byte.
+ *  @param      size Number of bytes of the value
+ *
+ *  @return     The value in little endian byte order
+ ****************************************************************************************/
+static uint64_t vmem_read_value(long address, int size) {
+	if (vmem == NULL) {
+		vmem_init();
+	}
+    return accessors.read_value(address, size);
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function writes a value of up to 8 bytes, see access_ops.
+ *
+ *  @param      address The virtual memory address of the lowest byte.
+ *  @param      size Number of bytes of the value
+ *  @param      value The value to be stored in little endian byte order
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void vmem_write_value(long address, int size, uint64_t value) {
+	if (vmem == NULL) {
+		vmem_init();
+	}
+    accessors.write_value(address, size, value);
+}
+
+uint16_t vmem_read_u16(long address) {
+    return vmem_read_value(address, sizeof(uint16_t));
+}
+
+uint32_t vmem_read_u32(long address) {
+    return vmem_read_value(address, sizeof(uint32_t));
+}
 
-    vmem_put_page_into_mem(page);
+uint64_t vmem_read_u64(long address) {
+    return vmem_read_value(address, sizeof(uint64_t));
+}
 
-    struct pt_entry* pt = &vmem->pt[page];
+void vmem_write_u16(long address, uint16_t data) {
+    vmem_write_value(address, sizeof(uint16_t), data);
+}
+
+void vmem_write_u32(long address, uint32_t data) {
+    vmem_write_value(address, sizeof(uint32_t), data);
+}
 
-    int frame = pt->frame;
-    TEST_AND_EXIT_ERRNO(frame > VMEM_NFRAMES, "Frame out of bounds!");
+void vmem_write_u64(long address, uint64_t data) {
+    vmem_write_value(address, sizeof(uint64_t), data);
+}
+
+void vmem_tlb_config(int entries, int ways) {
+    TEST_AND_EXIT((entries < 0) || (entries > VMEM_TLB_MAXENTRIES), (stderr, "vmem_tlb_config: number of entries out of range\n"));
+    TEST_AND_EXIT((entries > 0) && ((ways <= 0) || (entries % ways != 0)), (stderr, "vmem_tlb_config: entries must be a multiple of ways\n"));
+	if (vmem == NULL) {
+		vmem_init();
+	}
+    tlb_sets = (entries > 0) ? entries / ways : 0;
+    tlb_ways = ways;
+    tlb_ready = false;
+    tlb_thread_init();
+    vmem->client->tlb.entries = entries;
+    vmem->client->tlb.ways = ways;
+}
 
-	int offset = address % VMEM_PAGESIZE;
-    
-    //printf("vmem read %d %d \n", &vmem->pt[page], vmem->pt[page]);
-    return vmem->mainMemory[frame * VMEM_PAGESIZE + offset];
+void vmem_set_tick_mode(int mode) {
+    TEST_AND_EXIT((mode != VMEM_TICKS_EXACT) && (mode != VMEM_TICKS_BULK), (stderr, "vmem_set_tick_mode: undefined mode\n"));
+    tick_mode = mode;
 }
 
-void vmem_write(int address, unsigned char data) {
+void vmem_read_range(long address, unsigned char *buf, int len) {
 	if (vmem == NULL) {
 		vmem_init();
 	}
+    TEST_AND_EXIT((address < 0) || (len < 0) || (address + len > VMEM_VIRTMEMSIZE), (stderr, "vmem_read_range: range out of bounds\n"));
+    if (len > 0) {
+        trace_record(address, len, (len > 1) ? TRACE_RUN : 0);
+    }
 
-    //printf("vmem read\n");
+    while (len > 0) {
+        long page = address >> VMEM_PAGESHIFT;
+        int offset = address & VMEM_OFFSETMASK;
+        int n = (VMEM_GEO_PAGESIZE - offset < len) ? VMEM_GEO_PAGESIZE - offset : len;
 
-	int page = address / (VMEM_PAGESIZE / sizeof(unsigned char));
-    TEST_AND_EXIT_ERRNO(page > VMEM_NPAGES, "Page out of bounds!");
+        int frame = vmem_put_page_into_mem(page, n, NULL);
+        TEST_AND_EXIT_ERRNO(frame >= VMEM_NFRAMES, "Frame out of bounds!");
+        memcpy(buf, &vmem->mainMemory[frame * VMEM_GEO_PAGESIZE + offset], n);
+        vmem_unpin_page(frame);
 
-    vmem_put_page_into_mem(page);
+        address += n;
+        buf += n;
+        len -= n;
+    }
+}
 
-    struct pt_entry* pt = &vmem->pt[page]; 
+void vmem_write_range(long address, const unsigned char *buf, int len) {
+	if (vmem == NULL) {
+		vmem_init();
+	}
+    TEST_AND_EXIT((address < 0) || (len < 0) || (address + len > VMEM_VIRTMEMSIZE), (stderr, "vmem_write_range: range out of bounds\n"));
+    if (len > 0) {
+        trace_record(address, len, ((len > 1) ? TRACE_RUN : 0) | TRACE_WRITE);
+    }
 
-    int frame = pt->frame;
-    TEST_AND_EXIT_ERRNO(frame > VMEM_NFRAMES, "Frame out of bounds!");
+    while (len > 0) {
+        long page = address >> VMEM_PAGESHIFT;
+        int offset = address & VMEM_OFFSETMASK;
+        int n = (VMEM_GEO_PAGESIZE - offset < len) ? VMEM_GEO_PAGESIZE - offset : len;
 
-    pt->flags |= PTF_DIRTY;
-	int offset = address % (VMEM_PAGESIZE / sizeof(unsigned char));
-    vmem->mainMemory[frame * VMEM_PAGESIZE + offset] = data;
+        struct tlb_entry *e;
+        int frame = vmem_put_page_into_mem(page, n, &e);
+        frame = write_to_frame(page, frame, e, offset, buf, n);
+        vmem_unpin_page(frame);
+
+        address += n;
+        buf += n;
+        len -= n;
+    }
 }
+
+void vmem_copy(long dst, long src, int len) {
+    bool backwards = (dst > src) && (dst < src + len); // overlapping, copy from the end
+
+	if (vmem == NULL) {
+		vmem_init(); // the page size is known after attaching
+	}
+    unsigned char *buf = malloc(VMEM_GEO_PAGESIZE);
+    TEST_AND_EXIT_ERRNO(!buf, "vmem_copy: malloc of buffer failed");
+    while (len > 0) {
+        int n = (len < VMEM_GEO_PAGESIZE) ? len : VMEM_GEO_PAGESIZE;
+        int pos = backwards ? len - n : 0;
+        vmem_read_range(src + pos, buf, n);
+        vmem_write_range(dst + pos, buf, n);
+        if (!backwards) {
+            src += n;
+            dst += n;
+        }
+        len -= n;
+    }
+    free(buf);
+}
+/**
+ *****************************************************************************************
+ *  @brief      This function sends a pin or unpin command for each page of a range.
+ *
+ *  @param      cmd CMD_PIN or CMD_UNPIN
+ *  @param      start The virtual memory address of the first byte.
+ *  @param      len Number of bytes.
+ *
+ *  @return     Number of pages of the range that are pinned afterwards
+ ****************************************************************************************/
+static int pin_range(int cmd, long start, int len) {
+    int pinned = 0;
+
+	if (vmem == NULL) {
+		vmem_init();
+	}
+    TEST_AND_EXIT((start < 0) || (len < 0) || (start + len > VMEM_VIRTMEMSIZE), (stderr, "vmem_pin: range out of bounds\n"));
+    if (len == 0) {
+        return 0;
+    }
+    for (long page = start >> VMEM_PAGESHIFT; page <= (start + len - 1) >> VMEM_PAGESHIFT; page++) {
+        send_message(cmd, page, __atomic_load_n(&g_count, __ATOMIC_RELAXED));
+        if (!mt_mode && (tlb_sets > 0)) {
+            tlb_sync(); // pinning may have fetched the page
+        }
+        struct pt_entry *pte = vmem_pte(vmem, asid, page);
+        pinned += (pte != NULL) && (pte_flags(pte) & PTF_PINNED);
+    }
+    return pinned;
+}
+
+int vmem_pin(long start, int len) {
+    return pin_range(CMD_PIN, start, len);
+}
+
+void vmem_unpin(long start, int len) {
+    pin_range(CMD_UNPIN, start, len);
+}
+
+void vmem_enable_async(void) {
+    vmem_enable_threads(); // pages must be pinned, the memory manager runs concurrently
+    if (!async_mode) {
+        for (int i = 0; i < CO_MAX; i++) {
+            co_wait[i] = ASYNC_WAIT_NONE;
+        }
+        async_mode = true;
+    }
+}
+
+void vmem_run_async(void) {
+    TEST_AND_EXIT(!async_mode, (stderr, "vmem_run_async: asynchronous mode not enabled\n"));
+    co_run(vmem_async_idle);
+}
+
+void vmem_attach(void) {
+	if (vmem == NULL) {
+		vmem_init();
+	}
+}
+
+void vmem_checkpoint(void) {
+	if (vmem == NULL) {
+		vmem_init();
+	}
+    send_message(CMD_CHECKPOINT, 0, __atomic_load_n(&g_count, __ATOMIC_RELAXED));
+}
+
+void vmem_trace(const char *file, int seed, const char *workload) {
+	if (vmem == NULL) {
+		vmem_init();
+	}
+    TEST_AND_EXIT(trace_on, (stderr, "vmem_trace: accesses are recorded already\n"));
+    trace_fd = open(file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    TEST_AND_EXIT_ERRNO(trace_fd == -1, "vmem_trace: cannot create trace");
+    trace_init_header(&trace_hdr, seed, workload);
+    TEST_AND_EXIT_ERRNO(write(trace_fd, &trace_hdr, sizeof(trace_hdr)) != sizeof(trace_hdr), "vmem_trace: write failed");
+    TEST_AND_EXIT(pthread_create(&trace_thread, NULL, trace_writer, NULL) != 0, (stderr, "vmem_trace: pthread_create failed\n"));
+    trace_next = 0;
+    trace_on = true;
+    atexit(trace_close); // runs before vmem_detach
+}
+
+pid_t vmem_fork(void) {
+	if (vmem == NULL) {
+		vmem_init();
+	}
+    TEST_AND_EXIT(!vmem->adm->fork_enabled, (stderr, "vmem_fork: not supported by mmanage (one client, shards, local allocation or huge pages)\n"));
+    int child = reserve_address_space();
+    // mmanage shares the pages of this address space with the child
+    send_message(CMD_FORK, child, __atomic_load_n(&g_count, __ATOMIC_RELAXED));
+    fflush(NULL); // buffered output must not be written twice
+    pid_t pid = fork();
+    TEST_AND_EXIT_ERRNO(pid == -1, "vmem_fork: fork failed");
+    if (pid == 0) {
+        asid = child;
+        vmem->client = &vmem->header->clients[asid];
+        vmem->client->pid = getpid();
+        vmem->client->threaded = mt_mode;
+        vmem->client->tlb.entries = tlb_sets * tlb_ways;
+        vmem->client->tlb.ways = tlb_ways;
+        forkSyncClient(asid);
+        memset(&tlb_stats, 0, sizeof(tlb_stats)); // published by the parent
+        tlb_ready = false;
+        trace_on = false; // the writer thread runs in the parent only
+        if (livestats != NULL) {
+            live = &livestats->clients[asid];
+        }
+    }
+    return pid;
+}
+
+void vmem_enable_threads(void) {
+	if (vmem == NULL) {
+		vmem_init();
+	}
+    if (!mt_mode) {
+        TEST_AND_EXIT(pthread_key_create(&tlb_key, tlb_thread_exit) != 0, (stderr, "vmem_enable_threads: pthread_key_create failed\n"));
+        mt_mode = true;
+        vmem->client->threaded = true;
+    }
+}
+
 // EOF
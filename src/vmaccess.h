@@ -9,6 +9,20 @@
 #ifndef VMACCESS_H
 #define VMACCESS_H
 
+#include <stdint.h>
+#include <sys/types.h>
+
+/**
+ *****************************************************************************************
+ *  @brief      This function sets up the connection to virtual memory and reads its
+ *              geometry (VMEM_GEO_PAGESIZE, VMEM_VIRTMEMSIZE, ...) from shared memory.
+ *              The access functions call it on their first call. An application
+ *              must call it before it uses the geometry itself.
+ *
+ *  @return     void
+ ****************************************************************************************/
+void vmem_attach(void);
+
 /**
  *****************************************************************************************
  *  @brief      This function reads an one byte from virtual memory.
@@ -19,7 +33,7 @@
  * 
  *  @return     The byte read from virtual memory.
  ****************************************************************************************/
-unsigned char vmem_read(int address);
+unsigned char vmem_read(long address);
 
 /**
  *****************************************************************************************
@@ -33,6 +47,230 @@ unsigned char vmem_read(int address);
  * 
  *  @return     void
  ****************************************************************************************/
-void vmem_write(int address, unsigned char data);
+void vmem_write(long address, unsigned char data);
+
+/**
+ *****************************************************************************************
+ *  @brief      These functions read an unsigned value of 2, 4 or 8 bytes stored in little
+ *              endian byte order from virtual memory. If the value fits into one page, 
+ *              it will be read by one access to this page. Otherwise the value straddles
+ *              a page boundary and both pages will be accessed. Such accesses will be 
+ *              counted as straddle events.
+ *
+ *  @param      address The virtual memory address of the lowest byte of the value.
+ * 
+ *  @return     The value read from virtual memory.
+ ****************************************************************************************/
+uint16_t vmem_read_u16(long address);
+uint32_t vmem_read_u32(long address); //!< see vmem_read_u16
+uint64_t vmem_read_u64(long address); //!< see vmem_read_u16
+
+/**
+ *****************************************************************************************
+ *  @brief      These functions write an unsigned value of 2, 4 or 8 bytes in little
+ *              endian byte order to virtual memory. Page accesses are handled like
+ *              vmem_read_u16 does.
+ *
+ *  @param      address The virtual memory address of the lowest byte of the value.
+ *
+ *  @param      data The value that should be written to virtual memory.
+ * 
+ *  @return     void
+ ****************************************************************************************/
+void vmem_write_u16(long address, uint16_t data);
+void vmem_write_u32(long address, uint32_t data); //!< see vmem_write_u16
+void vmem_write_u64(long address, uint64_t data); //!< see vmem_write_u16
+
+#define VMEM_TLB_MAXENTRIES 1024 //!< maximal number of entries of the software TLB
+
+/**
+ *****************************************************************************************
+ *  @brief      This function configures the set associative software TLB of vmaccess.
+ *              The TLB caches translations page -> frame and writes Ref and Dirty 
+ *              bits of a page only at the first reference in a time window. The memory 
+ *              manager invalidates entries via shootdown epochs. 
+ *              By default the TLB is disabled.
+ *
+ *  @param      entries Number of entries; 0 disables the TLB
+ *
+ *  @param      ways Associativity; entries must be a multiple of ways
+ * 
+ *  @return     void
+ ****************************************************************************************/
+void vmem_tlb_config(int entries, int ways);
+
+#define VMEM_TICKS_EXACT 0 //!< range functions increment g_count byte by byte like vmem_read / vmem_write
+#define VMEM_TICKS_BULK  1 //!< range functions advance g_count in steps up to the next time window
+
+/**
+ *****************************************************************************************
+ *  @brief      This function selects how the range functions advance g_count. 
+ *              Both modes count one access per byte and set Ref bits such that the
+ *              memory manager observes the same page table as for single byte 
+ *              accesses. VMEM_TICKS_EXACT walks through every tick, VMEM_TICKS_BULK
+ *              (default) only stops at time windows.
+ *
+ *  @param      mode VMEM_TICKS_EXACT or VMEM_TICKS_BULK
+ * 
+ *  @return     void
+ ****************************************************************************************/
+void vmem_set_tick_mode(int mode);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function reads consecutive bytes from virtual memory. 
+ *              Each page will be translated and put into memory once. 
+ *
+ *  @param      address The virtual memory address of the first byte.
+ *
+ *  @param      buf Buffer that receives the bytes.
+ *
+ *  @param      len Number of bytes to be read.
+ * 
+ *  @return     void
+ ****************************************************************************************/
+void vmem_read_range(long address, unsigned char *buf, int len);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function writes consecutive bytes to virtual memory.
+ *              Each page will be translated and put into memory once. 
+ *
+ *  @param      address The virtual memory address of the first byte.
+ *
+ *  @param      buf Bytes to be written.
+ *
+ *  @param      len Number of bytes to be written.
+ * 
+ *  @return     void
+ ****************************************************************************************/
+void vmem_write_range(long address, const unsigned char *buf, int len);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function copies bytes within virtual memory. It works page wise:
+ *              a page sized chunk of the source will be read, then written to the 
+ *              destination. Overlapping ranges are handled like memmove.
+ *
+ *  @param      dst The virtual memory address of the destination.
+ *
+ *  @param      src The virtual memory address of the source.
+ *
+ *  @param      len Number of bytes to be copied.
+ * 
+ *  @return     void
+ ****************************************************************************************/
+void vmem_copy(long dst, long src, int len);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function pins the pages of an address range. A pinned page will
+ *              be put into memory and the memory manager will not select it for 
+ *              replacement until it has been unpinned. Pins of a page are counted.
+ *              The memory manager refuses pins beyond its cap of pinned frames.
+ *
+ *  @param      start The virtual memory address of the first byte.
+ *
+ *  @param      len Number of bytes.
+ * 
+ *  @return     Number of pages of the range that are pinned
+ ****************************************************************************************/
+int vmem_pin(long start, int len);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function removes one pin of each page of an address range.
+ *
+ *  @param      start The virtual memory address of the first byte.
+ *
+ *  @param      len Number of bytes.
+ * 
+ *  @return     void
+ ****************************************************************************************/
+void vmem_unpin(long start, int len);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function asks the memory manager to write a checkpoint of the 
+ *              whole simulation: page tables, frames, state of the page replacement 
+ *              algorithm, pagefile and the g_count of each client. A memory manager 
+ *              started with the checkpoint restores this state, so the next run may 
+ *              skip its initialisation. Without option -checkpoint the memory manager
+ *              ignores the request. No other thread may access virtual memory meanwhile.
+ * 
+ *  @return     void
+ ****************************************************************************************/
+void vmem_checkpoint(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function starts recording the accesses of this process into an 
+ *              access trace, see trace.h. Each call of an access function adds one 
+ *              event. The events are buffered and written by a background thread;
+ *              the trace will be completed on exit. A clone forked by vmem_fork 
+ *              is not recorded.
+ *
+ *  @param      file Name of the trace file
+ *  @param      seed Seed of the application, stored in the header of the trace
+ *  @param      workload Name of the workload, stored in the header of the trace
+ * 
+ *  @return     void
+ ****************************************************************************************/
+void vmem_trace(const char *file, int seed, const char *workload);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function forks the process together with its address space.
+ *              The memory manager clones the address space into a free one: resident
+ *              frames and pages of the backing store are shared copy-on-write, so 
+ *              the child starts from the current contents of virtual memory and 
+ *              a page will be copied when it is written first by either process.
+ *              The memory manager must serve several clients with global allocation
+ *              and neither shards nor huge pages. No other thread or coroutine may 
+ *              access virtual memory during the call.
+ * 
+ *  @return     like fork: 0 in the child, process id of the child in the parent
+ ****************************************************************************************/
+pid_t vmem_fork(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function switches vmaccess into thread safe mode. It must be 
+ *              called before a second thread accesses virtual memory. 
+ *              In thread safe mode g_count and the flags of the page table will be 
+ *              updated atomically. Concurrent page faults on the same page are 
+ *              coalesced, so only one request will be sent to the memory manager. 
+ *              Each thread uses its own request slot, hence faults of different
+ *              threads may be outstanding at the same time.
+ *              A thread pins a page while accessing its frame, so the memory manager
+ *              will not remove the page in the meantime. 
+ *              At most SYNC_NSLOTS threads may access virtual memory.
+ * 
+ *  @return     void
+ ****************************************************************************************/
+void vmem_enable_threads(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function switches vmaccess into asynchronous mode. The workload 
+ *              runs as coroutines (see coroutine.h) started by vmem_run_async.
+ *              A coroutine that faults posts its request to the memory manager without
+ *              waiting and yields; it will be resumed when the ACK has arrived. 
+ *              Meanwhile other coroutines keep running, so several faults may be
+ *              outstanding. Pages are pinned like in thread safe mode, which will be
+ *              enabled as well.
+ * 
+ *  @return     void
+ ****************************************************************************************/
+void vmem_enable_async(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function runs all coroutines created by co_spawn until they have 
+ *              finished. It must be called in asynchronous mode.
+ * 
+ *  @return     void
+ ****************************************************************************************/
+void vmem_run_async(void);
 
 #endif
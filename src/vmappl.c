@@ -9,9 +9,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/wait.h>
 #include "vmaccess.h"
+#include "coroutine.h"
 #include "my_rand.h"
 #include "vmappl.h"
+#include "workload.h"
+#include "vmem.h"
 
 /* 
  * Signatures of private (static) functions of this module.
@@ -43,6 +49,51 @@
  ****************************************************************************************/
 static void quicksort(int l, int r);
 
+/**
+ *****************************************************************************************
+ *  @brief      Partition step of QuickSort. All elements less than the element at r 
+ *              will be moved to the left of the returned boundary.
+ *
+ *  @param      l address of the left-most array element to be partitioned
+ * 
+ *  @param      r address of the right-most array element to be partitioned
+ *
+ *  @return     final position of the reference element
+ ****************************************************************************************/
+static int partition(int l, int r);
+
+/**
+ *****************************************************************************************
+ *  @brief      Parallel version of QuickSort. The array will be partitioned
+ *              recursively, the left half of each partition will be sorted by a new
+ *              thread. Below the given depth the halfs are sorted by quicksort.
+ *
+ *  @param      l address of the left-most array element to be sorted
+ * 
+ *  @param      r address of the right-most array element to be sorted
+ *
+ *  @param      depth number of partition levels that start new threads
+ *
+ *  @return     void 
+ ****************************************************************************************/
+static void parallel_quicksort(int l, int r, int depth);
+
+/**
+ *****************************************************************************************
+ *  @brief      Coroutine version of QuickSort. Like parallel_quicksort, but the left 
+ *              half of each partition will be sorted by a new coroutine. It must be 
+ *              called by a coroutine in asynchronous mode of vmaccess.
+ *
+ *  @param      l address of the left-most array element to be sorted
+ * 
+ *  @param      r address of the right-most array element to be sorted
+ *
+ *  @param      depth number of partition levels that start new coroutines
+ *
+ *  @return     void 
+ ****************************************************************************************/
+static void coroutine_quicksort(int l, int r, int depth);
+
 /**
  *****************************************************************************************
  *  @brief      Bubble sort 
@@ -55,6 +106,86 @@ static void quicksort(int l, int r);
  ****************************************************************************************/
 static void bubblesort(int l, int r);
 
+/**
+ *****************************************************************************************
+ *  @brief      Bottom up merge sort. Page sized runs are sorted locally, then pairs 
+ *              of runs are merged pass by pass. Each merge streams through two input 
+ *              runs and one output run, so only three pages must be resident. 
+ *              The passes alternate between the array and the scratch area.
+ *
+ *  @param      length length of the array to be sorted
+ *
+ *  @return     void 
+ ****************************************************************************************/
+static void mergesort(int length);
+
+/**
+ *****************************************************************************************
+ *  @brief      External memory block sort. Page sized runs are sorted locally, then 
+ *              up to MERGE_WAYS runs are merged at once. Each merge keeps one page of 
+ *              each input run and the output page resident.
+ *
+ *  @param      length length of the array to be sorted
+ *
+ *  @return     void 
+ ****************************************************************************************/
+static void blocksort(int length);
+
+/**
+ *****************************************************************************************
+ *  @brief      Sample sort. Splitters taken from a sorted sample divide the values into
+ *              buckets of a few pages each. Counting and distribution read the array
+ *              sequentially, the buckets are written sequentially into the scratch area.
+ *              Each bucket is sorted by quicksort, then the buckets are copied back.
+ *
+ *  @param      length length of the array to be sorted
+ *
+ *  @return     void 
+ ****************************************************************************************/
+static void samplesort(int length);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the name of a sort algorithm.
+ *
+ *  @param      algo sort algorithm, see *_SORT defines in vmappl.h 
+ *
+ *  @return     name of sort algorithm
+ ****************************************************************************************/
+static const char *sort_algo_name(int algo);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the sort algorithm of a name used on command line.
+ *
+ *  @param      name name of sort algorithm without leading '-', e.g. quicksort
+ *
+ *  @return     sort algorithm, see *_SORT defines in vmappl.h; 0: undefined
+ ****************************************************************************************/
+static int sort_algo_of(const char *name);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the name of a sort algorithm used on command line.
+ *
+ *  @param      algo sort algorithm, see *_SORT defines in vmappl.h
+ *
+ *  @return     name of sort algorithm without leading '-', e.g. quicksort
+ ****************************************************************************************/
+static const char *sort_algo_option(int algo);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function clones the process and its virtual memory by vmem_fork.
+ *              The clone sorts the array by fork_algo and prints the result, the 
+ *              process waits for the clone and continues.
+ *
+ *  @param      length length of the array to be sorted 
+ *
+ *  @return     void 
+ ****************************************************************************************/
+static void fork_and_sort(int length);
+
 /**
  *****************************************************************************************
  *  @brief      This function sorts the array stored in the virtual memory.
@@ -80,6 +211,29 @@ static void sort(int length);
  ****************************************************************************************/
 static void swap(int addr1, int addr2);
 
+/**
+ *****************************************************************************************
+ *  @brief      This function reads an element of the array stored in virtual memory.
+ *              Depending on elem_size an element is a byte or an int32 value.
+ * 
+ *  @param      idx index of the element 
+ *
+ *  @return     value of the element
+ ****************************************************************************************/
+static int read_elem(int idx);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function writes an element of the array stored in virtual memory.
+ * 
+ *  @param      idx index of the element 
+ *
+ *  @param      val value of the element
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void write_elem(int idx, int val);
+
 /**
  *****************************************************************************************
  *  @brief      This function scans all parameters of the porgram.
@@ -123,6 +277,31 @@ static void print_usage_info_and_exit(char *err_str);
 static char *program_name = NULL;
 static int sort_algo      = QUICK_SORT; // select default sort algorithm
 static int seed           = SEED; // select default init value for random number generator 
+static int elem_size      = ELEM_BYTE; // size of array elements in bytes
+static int base_addr      = 0;    // virtual address of the array
+static int nthreads       = PQS_THREADS; // number of threads of parallel quicksort
+static int ncoroutines    = CQS_COROUTINES; // number of coroutines of coroutine quicksort
+static int scratch_idx    = 0;    // index of the first element of the scratch area behind the array
+static const char *workload_name = NULL;  // workload selected instead of sorting
+static struct workload_params wl_params;  // parameters of the workload; 0: default
+static int pin_start      = 0;    // first address of the range pinned before sorting
+static int pin_len        = 0;    // length of the pinned range; 0: no pinning
+static int fork_algo      = 0;    // sort algorithm of the clone forked after initialisation; 0: no fork
+static bool checkpoint    = false; // request a checkpoint of mmanage after initialisation
+static bool warmstart     = false; // array has been restored by mmanage -restore, initialisation is skipped
+static const char *trace_name = NULL; // accesses are recorded into this trace; NULL: no recording
+static const char *replay_name = NULL; // trace replayed instead of sorting, see workload_replay
+
+/*
+ * Arguments of a thread of parallel quicksort or a coroutine of coroutine quicksort
+ */
+struct pqs_task {
+    int l;      // address of the left-most array element to be sorted
+    int r;      // address of the right-most array element to be sorted
+    int depth;  // remaining partition levels that start new threads or coroutines
+};
+
+static void coroutine_quicksort_entry(void *arg);
 
 /* 
  * functions of the module 
@@ -135,6 +314,20 @@ void scan_params(int argc, char **argv) {
     bool seed_param_found      = false;
     bool param_ok              = false;
     const char *seed_str = "-seed=";
+    const char *tlb_str = "-tlb=";
+    const char *threads_str = "-threads=";
+    const char *coroutines_str = "-coroutines=";
+    const char *workload_str = "-workload=";
+    const char *size_str = "-size=";
+    const char *ops_str = "-ops=";
+    const char *stride_str = "-stride=";
+    const char *pinlevels_str = "-pinlevels=";
+    const char *pin_str = "-pin=";
+    const char *fork_str = "-fork=";
+    const char *trace_str = "-trace=";
+    const char *replay_str = "-replay=";
+    int tlb_entries = 0;
+    int tlb_ways = 0;
 
     // scan all parameters (argv[0] points to program name)
     for (i = 1; i < argc; i++) {
@@ -153,6 +346,117 @@ void scan_params(int argc, char **argv) {
             sort_algo_param_found = true;
             param_ok = true;
         }
+        if (0 == strcasecmp("-pquicksort", argv[i])) {
+            // parallel quicksort selected
+            if (sort_algo_param_found) print_usage_info_and_exit("Two sort algorthm selected.\n");
+            sort_algo = PARALLEL_QUICK_SORT;
+            sort_algo_param_found = true;
+            param_ok = true;
+        }
+        if (0 == strncasecmp(threads_str, argv[i], strlen(threads_str))) {
+            // number of threads of parallel quicksort, must be a power of two
+            if ((1 == sscanf(argv[i] + strlen(threads_str), "%d", &nthreads)) && 
+                (nthreads > 0) && (nthreads <= PQS_MAXTHREADS) && ((nthreads & (nthreads - 1)) == 0)) {
+                param_ok = true;
+            }
+        }
+        if (0 == strcasecmp("-coquicksort", argv[i])) {
+            // coroutine quicksort selected
+            if (sort_algo_param_found) print_usage_info_and_exit("Two sort algorthm selected.\n");
+            sort_algo = COROUTINE_QUICK_SORT;
+            sort_algo_param_found = true;
+            param_ok = true;
+        }
+        if (0 == strncasecmp(coroutines_str, argv[i], strlen(coroutines_str))) {
+            // number of coroutines of coroutine quicksort, must be a power of two
+            if ((1 == sscanf(argv[i] + strlen(coroutines_str), "%d", &ncoroutines)) && 
+                (ncoroutines > 0) && (ncoroutines <= CO_MAX) && ((ncoroutines & (ncoroutines - 1)) == 0)) {
+                param_ok = true;
+            }
+        }
+        if ((0 == strcasecmp("-mergesort", argv[i])) || (0 == strcasecmp("-blocksort", argv[i])) || 
+            (0 == strcasecmp("-samplesort", argv[i]))) {
+            // external memory sort selected
+            if (sort_algo_param_found) print_usage_info_and_exit("Two sort algorthm selected.\n");
+            sort_algo = (0 == strcasecmp("-mergesort", argv[i])) ? MERGE_SORT : 
+                        (0 == strcasecmp("-blocksort", argv[i])) ? BLOCK_SORT : SAMPLE_SORT;
+            sort_algo_param_found = true;
+            param_ok = true;
+        }
+        if (0 == strncasecmp(workload_str, argv[i], strlen(workload_str))) {
+            // benchmark workload instead of sorting
+            workload_name = argv[i] + strlen(workload_str);
+            param_ok = workload_exists(workload_name);
+        }
+        if (0 == strncasecmp(size_str, argv[i], strlen(size_str))) {
+            // problem size of workload
+            param_ok = (1 == sscanf(argv[i] + strlen(size_str), "%d", &wl_params.size)) && (wl_params.size > 0);
+        }
+        if (0 == strncasecmp(ops_str, argv[i], strlen(ops_str))) {
+            // number of operations of workload
+            param_ok = (1 == sscanf(argv[i] + strlen(ops_str), "%d", &wl_params.ops)) && (wl_params.ops > 0);
+        }
+        if (0 == strncasecmp(stride_str, argv[i], strlen(stride_str))) {
+            // stride of workload stride
+            param_ok = (1 == sscanf(argv[i] + strlen(stride_str), "%d", &wl_params.stride)) && (wl_params.stride > 0);
+        }
+        if (0 == strncasecmp(pinlevels_str, argv[i], strlen(pinlevels_str))) {
+            // pinned levels of workload bsearch
+            param_ok = (1 == sscanf(argv[i] + strlen(pinlevels_str), "%d", &wl_params.pin_levels)) && (wl_params.pin_levels >= 0);
+        }
+        if (0 == strncasecmp(pin_str, argv[i], strlen(pin_str))) {
+            // address range to be pinned before sorting
+            param_ok = (2 == sscanf(argv[i] + strlen(pin_str), "%d:%d", &pin_start, &pin_len)) && 
+                       (pin_start >= 0) && (pin_len > 0); // upper bound is checked by vmem_pin
+        }
+        if (0 == strncasecmp(fork_str, argv[i], strlen(fork_str))) {
+            // sort algorithm of the clone
+            fork_algo = sort_algo_of(argv[i] + strlen(fork_str));
+            param_ok = (fork_algo != 0);
+        }
+        if (0 == strncasecmp(trace_str, argv[i], strlen(trace_str))) {
+            // access trace
+            trace_name = argv[i] + strlen(trace_str);
+            param_ok = (*trace_name != '\0');
+        }
+        if (0 == strncasecmp(replay_str, argv[i], strlen(replay_str))) {
+            // access trace replayed instead of sorting
+            replay_name = argv[i] + strlen(replay_str);
+            param_ok = (*replay_name != '\0');
+        }
+        if (0 == strcasecmp("-checkpoint", argv[i])) {
+            // checkpoint of the initialized array
+            checkpoint = true;
+            param_ok = true;
+        }
+        if (0 == strcasecmp("-warmstart", argv[i])) {
+            // initialized array restored from a checkpoint
+            warmstart = true;
+            param_ok = true;
+        }
+        if (0 == strcasecmp("-int32", argv[i])) {
+            // sort int32 values
+            elem_size = ELEM_INT32;
+            param_ok = true;
+        }
+        if (0 == strcasecmp("-unaligned", argv[i])) {
+            // array starts at an odd address, hence elements may straddle pages
+            base_addr = 1;
+            param_ok = true;
+        }
+        if (0 == strncasecmp(tlb_str, argv[i], strlen(tlb_str))) {
+            // software TLB <entries>:<ways>
+            if ((2 == sscanf(argv[i] + strlen(tlb_str), "%d:%d", &tlb_entries, &tlb_ways)) && 
+                (tlb_entries > 0) && (tlb_ways > 0) && (tlb_entries % tlb_ways == 0) && (tlb_entries <= VMEM_TLB_MAXENTRIES)) {
+                vmem_tlb_config(tlb_entries, tlb_ways);
+                param_ok = true;
+            }
+        }
+        if (0 == strcasecmp("-exactticks", argv[i])) {
+            // range accesses increment g_count byte by byte
+            vmem_set_tick_mode(VMEM_TICKS_EXACT);
+            param_ok = true;
+        }
         if ( 0 == strncasecmp(seed_str, argv[i], strlen(seed_str)) ) {
             // seed parameter found 
             if ( 1 == sscanf(argv[i]+strlen(seed_str), "%d", &seed) ) {
@@ -166,33 +470,108 @@ void scan_params(int argc, char **argv) {
 }
 
 int main(int argc, char **argv) {
+    int length = LENGTH;
     // scan parameter 
     //printf("main app\n");
 
     program_name = argv[0];
     scan_params(argc, argv);
-    printf("seed = %d sort algorithm = %s\n", seed, 
-           (sort_algo == QUICK_SORT) ? "Quick Sort" : (sort_algo == BUBBLE_SORT) ? "Bubble Sort" : "undefined");
+    vmem_attach(); // geometry of virtual memory has been set by mmanage
+    if (replay_name != NULL) {
+        struct workload_result result;
+        if (trace_name != NULL) {
+            vmem_trace(trace_name, seed, "replay");
+        }
+        workload_replay(replay_name, &result);
+        printf("seed = %d replay = %s\naccesses = %ld checksum = 0x%08x\n", seed, replay_name, result.accesses, result.checksum);
+        return 0;
+    }
+    if (workload_name != NULL) {
+        struct workload_result result;
+        wl_params.seed = seed;
+        if (trace_name != NULL) {
+            vmem_trace(trace_name, seed, workload_name);
+        }
+        workload_run(workload_name, &wl_params, &result);
+        printf("seed = %d workload = %s size = %d ops = %d", seed, workload_name, wl_params.size, wl_params.ops);
+        if (wl_params.stride > 0) {
+            printf(" stride = %d", wl_params.stride);
+        }
+        if (wl_params.pin_levels > 0) {
+            printf(" pinned levels = %d", wl_params.pin_levels);
+        }
+        printf("\naccesses = %ld checksum = 0x%08x\n", result.accesses, result.checksum);
+        return 0;
+    }
+    printf("seed = %d sort algorithm = %s", seed, sort_algo_name(sort_algo));
+    if (sort_algo == PARALLEL_QUICK_SORT) {
+        printf(" threads = %d", nthreads);
+    }
+    if (sort_algo == COROUTINE_QUICK_SORT) {
+        printf(" coroutines = %d", ncoroutines);
+    }
+    if (fork_algo != 0) {
+        printf(" fork = %s", sort_algo_name(fork_algo));
+    }
+    // the clone sorts the same array, it may need a scratch area
+    int algos[] = { sort_algo, fork_algo };
+    bool external = false;
+    for (int i = 0; i < 2; i++) {
+        external |= (algos[i] == MERGE_SORT) || (algos[i] == BLOCK_SORT) || (algos[i] == SAMPLE_SORT);
+    }
+    if ((elem_size != ELEM_BYTE) || (base_addr != 0) || external) {
+        // the array must fit into virtual memory
+        if (base_addr + length * elem_size > VMEM_VIRTMEMSIZE) {
+            length = (VMEM_VIRTMEMSIZE - base_addr) / elem_size;
+        }
+        // external memory sorts need a scratch area of the same size, starting at a page boundary 
+        while (external && (length > 0)) {
+            int scratch_bytes = (length * elem_size + VMEM_GEO_PAGESIZE - 1) / VMEM_GEO_PAGESIZE * VMEM_GEO_PAGESIZE;
+            scratch_idx = scratch_bytes / elem_size;
+            if (base_addr + scratch_bytes + length * elem_size <= VMEM_VIRTMEMSIZE) {
+                break;
+            }
+            length--;
+        }
+        printf(" element size = %d base address = %d length = %d", elem_size, base_addr, length);
+    }
+    if (pin_len > 0) {
+        printf(" pinned pages = %d", vmem_pin(pin_start, pin_len));
+    }
+    printf("\n");
     fflush(stdout); 
 
     /* Fill memory with pseudo-random data */
-    if (LENGTH <= 0) {
+    if (length <= 0) {
         fprintf(stderr, "LENGTH (array size) out of range");
         exit(EXIT_FAILURE); 
     }
-    init_data(LENGTH);
+    if (trace_name != NULL) {
+        vmem_trace(trace_name, seed, sort_algo_option(sort_algo));
+    }
+    if (!warmstart) {
+        init_data(length);
+    }
+    if (checkpoint) {
+        vmem_checkpoint();
+    }
 
     /* Display unsorted */
     printf("\nUnsorted:\n");
-    display_data(LENGTH);
+    display_data(length);
+
+    /* Sort a clone of the initialized array */
+    if (fork_algo != 0) {
+        fork_and_sort(length);
+    }
 
     /* Sort */
     printf("\nSorting:\n");
-    sort(LENGTH);
+    sort(length);
 
     /* Display sorted */
     printf("\nSorted:\n");
-    display_data(LENGTH);
+    display_data(length);
     printf("\n");
 
     return 0;
@@ -200,25 +579,51 @@ int main(int argc, char **argv) {
 
 void init_data(int length) {
     int i;
-    unsigned char val;
+    unsigned char val[length];
 
     /* Init random generator */
     my_srand(seed);
 
+    if (elem_size == ELEM_INT32) {
+        for(i = 0; i < length; i++) {
+            write_elem(i, my_rand());
+        }   /* end for */
+        return;
+    }
     for(i = 0; i < length; i++) {
-        val = my_rand() % RNDMOD;
-        vmem_write(i, val);
+        val[i] = my_rand() % RNDMOD;
     }   /* end for */
+    vmem_write_range(base_addr, val, length);
 }
 
 void display_data(int length) {
     int i;
+    unsigned char val[length];
+
+    if (elem_size == ELEM_BYTE) {
+        vmem_read_range(base_addr, val, length);
+    }
     for(i = 0; i < length; i++) {
-        printf("%10d", vmem_read(i));
+        printf("%10d", (elem_size == ELEM_BYTE) ? val[i] : read_elem(i));
         printf("%c", ((i + 1) % NDISPLAYCOLS) ? ' ' : '\n');
     }   /* end for */
 }
 
+int read_elem(int idx) {
+    if (elem_size == ELEM_INT32) {
+        return (int32_t) vmem_read_u32(base_addr + idx * ELEM_INT32);
+    }
+    return vmem_read(base_addr + idx);
+}
+
+void write_elem(int idx, int val) {
+    if (elem_size == ELEM_INT32) {
+        vmem_write_u32(base_addr + idx * ELEM_INT32, (uint32_t) val);
+    } else {
+        vmem_write(base_addr + idx, val);
+    }
+}
+
 void sort(int length) {
     /* Quicksort */
     switch (sort_algo) {
@@ -228,6 +633,34 @@ void sort(int length) {
        case BUBBLE_SORT :
            bubblesort(0, length - 1);
            break;
+       case MERGE_SORT :
+           mergesort(length);
+           break;
+       case BLOCK_SORT :
+           blocksort(length);
+           break;
+       case SAMPLE_SORT :
+           samplesort(length);
+           break;
+       case PARALLEL_QUICK_SORT : {
+           int depth = 0;
+           while ((1 << depth) < nthreads) {
+               depth++;
+           }
+           vmem_enable_threads();
+           parallel_quicksort(0, length - 1, depth);
+           break;
+       }
+       case COROUTINE_QUICK_SORT : {
+           struct pqs_task task = { 0, length - 1, 0 };
+           while ((1 << task.depth) < ncoroutines) {
+               task.depth++;
+           }
+           vmem_enable_async();
+           co_spawn(coroutine_quicksort_entry, &task);
+           vmem_run_async();
+           break;
+       }
        default:
            fprintf(stderr, "Undefined sort algorithm in function sort");
            exit(EXIT_FAILURE); 
@@ -238,40 +671,321 @@ static void bubblesort(int l, int r) {
     int i, j;
     for (i = l; i < r; i ++) {
         for (j = i + 1; j <= r; j ++) {
-            if (vmem_read(j) < vmem_read(i)) {
+            if (read_elem(j) < read_elem(i)) {
                swap(i,j);
             }
         }
     }
 }
 
+int partition(int l, int r) {
+    int i = l;
+    int j = r - 1;
+    while(1) {      /* Put all elements < [r] to the left */
+        while(read_elem(i) < read_elem(r)) {
+            i++;
+        }
+        while((read_elem(j) >= read_elem(r)) && (j > l)) {
+            j--;
+        }
+        if(i >= j) {
+            break;
+        }   /* end if */
+        swap(i, j);
+    }       /* end while */
+    swap(i, r);     /* Put reference elemet to the boundary */
+    return i;
+}
+
 void quicksort(int l, int r) {
     if(l < r) {
-        int i = l;
-        int j = r - 1;
-        while(1) {      /* Put all elements < [r] to the left */
-            while(vmem_read(i) < vmem_read(r)) {
-                i++;
-            }
-            while((vmem_read(j) >= vmem_read(r)) && (j > l)) {
-                j--;
-            }
-            if(i >= j) {
-                break;
-            }   /* end if */
-            swap(i, j);
-        }       /* end while */
-        swap(i, r);     /* Put reference elemet to the boundary */
+        int i = partition(l, r);
         /* Recursively sort the left and right half */
         quicksort(l, i - 1);
         quicksort(i + 1, r);
     }   /* end if */
 }
 
+static void *parallel_quicksort_thread(void *arg) {
+    struct pqs_task *task = arg;
+    parallel_quicksort(task->l, task->r, task->depth);
+    return NULL;
+}
+
+void parallel_quicksort(int l, int r, int depth) {
+    if (depth == 0) {
+        quicksort(l, r);
+    } else if (l < r) {
+        pthread_t thread;
+        int i = partition(l, r);
+        struct pqs_task left = { l, i - 1, depth - 1 };
+        /* The left half is sorted by a new thread, the right half by this thread */
+        if (pthread_create(&thread, NULL, parallel_quicksort_thread, &left) != 0) {
+            fprintf(stderr, "pthread_create failed in function parallel_quicksort");
+            exit(EXIT_FAILURE); 
+        }
+        parallel_quicksort(i + 1, r, depth - 1);
+        pthread_join(thread, NULL);
+    }
+}
+
+static void coroutine_quicksort_entry(void *arg) {
+    struct pqs_task *task = arg;
+    coroutine_quicksort(task->l, task->r, task->depth);
+}
+
+void coroutine_quicksort(int l, int r, int depth) {
+    if (depth == 0) {
+        quicksort(l, r);
+    } else if (l < r) {
+        int i = partition(l, r);
+        struct pqs_task left = { l, i - 1, depth - 1 };
+        /* The left half is sorted by a new coroutine, the right half by this coroutine */
+        int id = co_spawn(coroutine_quicksort_entry, &left);
+        coroutine_quicksort(i + 1, r, depth - 1);
+        co_join(id);
+    }
+}
+
+/*
+ * Helper functions of the external memory sorts
+ */
+
+static int compare_int(const void *a, const void *b) {
+    int x = *(const int *) a;
+    int y = *(const int *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function sorts runs of the array locally: a run will be read, 
+ *              sorted in local memory and written back.
+ *
+ *  @param      length length of the array
+ *
+ *  @param      run number of elements of a run
+ *
+ *  @return     void 
+ ****************************************************************************************/
+static void sort_runs(int length, int run) {
+    int buf[run];
+    for (int l = 0; l < length; l += run) {
+        int n = (length - l < run) ? length - l : run;
+        for (int i = 0; i < n; i++) {
+            buf[i] = read_elem(l + i);
+        }
+        qsort(buf, n, sizeof(int), compare_int);
+        for (int i = 0; i < n; i++) {
+            write_elem(l + i, buf[i]);
+        }
+    }
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function merges up to MERGE_WAYS adjacent sorted runs. The head of 
+ *              each run is kept in local memory, so each element will be read once.
+ *
+ *  @param      src index of the first element of the first run
+ *
+ *  @param      dst index of the first element of the merged run
+ *
+ *  @param      n total number of elements of all runs
+ *
+ *  @param      run number of elements of each run; the last one may be shorter
+ *
+ *  @return     void 
+ ****************************************************************************************/
+static void merge_runs(int src, int dst, int n, int run) {
+    int pos[MERGE_WAYS];   // next element of each run
+    int end[MERGE_WAYS];   // end of each run
+    int head[MERGE_WAYS];  // value of the next element of each run
+    int k = 0;
+
+    for (int l = 0; l < n; l += run) {
+        pos[k] = src + l;
+        end[k] = src + ((l + run < n) ? l + run : n);
+        head[k] = read_elem(pos[k]);
+        k++;
+    }
+    for (int out = dst; out < dst + n; out++) {
+        int min = VOID_IDX;
+        for (int i = 0; i < k; i++) {
+            if ((pos[i] < end[i]) && ((min == VOID_IDX) || (head[i] < head[min]))) {
+                min = i;
+            }
+        }
+        write_elem(out, head[min]);
+        if (++pos[min] < end[min]) {
+            head[min] = read_elem(pos[min]);
+        }
+    }
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function merges sorted runs pass by pass, alternating between the
+ *              array and the scratch area. The result will be copied back to the array.
+ *
+ *  @param      length length of the array
+ *
+ *  @param      run number of elements of the initial runs
+ *
+ *  @param      ways number of runs merged at once, at most MERGE_WAYS
+ *
+ *  @return     void 
+ ****************************************************************************************/
+static void merge_passes(int length, int run, int ways) {
+    int src = 0;
+    int dst = scratch_idx;
+
+    for (; run < length; run *= ways) {
+        for (int l = 0; l < length; l += run * ways) {
+            int n = (length - l < run * ways) ? length - l : run * ways;
+            merge_runs(src + l, dst + l, n, run);
+        }
+        int tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    if (src != 0) {
+        for (int i = 0; i < length; i++) {
+            write_elem(i, read_elem(src + i));
+        }
+    }
+}
+
+void mergesort(int length) {
+    int run = (VMEM_GEO_PAGESIZE / elem_size > 0) ? VMEM_GEO_PAGESIZE / elem_size : 1;
+    sort_runs(length, run);
+    merge_passes(length, run, 2);
+}
+
+void blocksort(int length) {
+    int run = (VMEM_GEO_PAGESIZE / elem_size > 0) ? VMEM_GEO_PAGESIZE / elem_size : 1;
+    // one page per input run and one output page must fit into main memory
+    int ways = (VMEM_NFRAMES - 1 < MERGE_WAYS) ? VMEM_NFRAMES - 1 : MERGE_WAYS;
+    sort_runs(length, run);
+    merge_passes(length, run, (ways >= 2) ? ways : 2);
+}
+
+void samplesort(int length) {
+    int epp = (VMEM_GEO_PAGESIZE / elem_size > 0) ? VMEM_GEO_PAGESIZE / elem_size : 1;
+    // a bucket should fill about half of main memory, each bucket is written by its own stream
+    int target = epp * ((VMEM_NFRAMES / 2 > 1) ? VMEM_NFRAMES / 2 : 1);
+    int nbuckets = (length + target - 1) / target;
+    if (nbuckets > MERGE_WAYS) nbuckets = MERGE_WAYS;
+    if (nbuckets < 1) nbuckets = 1;
+    int nsample = nbuckets * SAMPLE_OVERSAMPLING;
+    int sample[nsample];
+    int splitter[nbuckets];   // splitter[b]: smallest value of bucket b + 1
+    int count[nbuckets];
+    int next[nbuckets];
+
+    // sorted sample taken with fixed stride
+    for (int i = 0; i < nsample; i++) {
+        sample[i] = read_elem((int) ((long) i * length / nsample));
+    }
+    qsort(sample, nsample, sizeof(int), compare_int);
+    for (int b = 0; b < nbuckets - 1; b++) {
+        splitter[b] = sample[(b + 1) * SAMPLE_OVERSAMPLING];
+    }
+
+    // count bucket sizes
+    for (int b = 0; b < nbuckets; b++) {
+        count[b] = 0;
+    }
+    for (int i = 0; i < length; i++) {
+        int v = read_elem(i);
+        int b = 0;
+        while ((b < nbuckets - 1) && (v >= splitter[b])) b++;
+        count[b]++;
+    }
+    for (int b = 0, start = scratch_idx; b < nbuckets; start += count[b], b++) {
+        next[b] = start;
+    }
+
+    // distribute into scratch area
+    for (int i = 0; i < length; i++) {
+        int v = read_elem(i);
+        int b = 0;
+        while ((b < nbuckets - 1) && (v >= splitter[b])) b++;
+        write_elem(next[b]++, v);
+    }
+
+    // sort buckets and copy them back
+    for (int b = 0, start = scratch_idx; b < nbuckets; start += count[b], b++) {
+        quicksort(start, start + count[b] - 1);
+    }
+    for (int i = 0; i < length; i++) {
+        write_elem(i, read_elem(scratch_idx + i));
+    }
+}
+
+/*
+ * Names of the sort algorithms used on command line
+ */
+static const struct { const char *name; int algo; } sort_algo_names[] = {
+    { "quicksort", QUICK_SORT }, { "bubblesort", BUBBLE_SORT }, { "pquicksort", PARALLEL_QUICK_SORT },
+    { "coquicksort", COROUTINE_QUICK_SORT }, { "mergesort", MERGE_SORT }, { "blocksort", BLOCK_SORT },
+    { "samplesort", SAMPLE_SORT },
+};
+#define NSORT_ALGO_NAMES ((int) (sizeof(sort_algo_names) / sizeof(sort_algo_names[0])))
+
+int sort_algo_of(const char *name) {
+    for (int i = 0; i < NSORT_ALGO_NAMES; i++) {
+        if (0 == strcasecmp(sort_algo_names[i].name, name)) {
+            return sort_algo_names[i].algo;
+        }
+    }
+    return 0;
+}
+
+const char *sort_algo_option(int algo) {
+    for (int i = 0; i < NSORT_ALGO_NAMES; i++) {
+        if (sort_algo_names[i].algo == algo) {
+            return sort_algo_names[i].name;
+        }
+    }
+    return "undefined";
+}
+
+void fork_and_sort(int length) {
+    int status = 0;
+    pid_t pid = vmem_fork();
+    if (pid == 0) {
+        sort_algo = fork_algo;
+        printf("\nSorting clone:\n");
+        sort(length);
+        printf("\nSorted clone:\n");
+        display_data(length);
+        printf("\n");
+        exit(EXIT_SUCCESS);
+    }
+    if ((waitpid(pid, &status, 0) == -1) || !WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS)) {
+        fprintf(stderr, "Clone forked by vmem_fork failed\n");
+        exit(EXIT_FAILURE); 
+    }
+}
+
+const char *sort_algo_name(int algo) {
+    switch (algo) {
+       case QUICK_SORT :           return "Quick Sort";
+       case BUBBLE_SORT :          return "Bubble Sort";
+       case PARALLEL_QUICK_SORT :  return "Parallel Quick Sort";
+       case COROUTINE_QUICK_SORT : return "Coroutine Quick Sort";
+       case MERGE_SORT :           return "Merge Sort";
+       case BLOCK_SORT :           return "Block Sort";
+       case SAMPLE_SORT :          return "Sample Sort";
+       default:                    return "undefined";
+    }
+}
+
 void swap(int addr1, int addr2) {
-    unsigned char tmp = vmem_read(addr1);
-    vmem_write(addr1, vmem_read(addr2));
-    vmem_write(addr2, tmp);
+    int tmp = read_elem(addr1);
+    write_elem(addr1, read_elem(addr2));
+    write_elem(addr2, tmp);
 }
 
 void print_usage_info_and_exit(char *err_str) {
@@ -279,8 +993,32 @@ void print_usage_info_and_exit(char *err_str) {
     fprintf(stderr, "Usage : %s [OPTIONS]\n", program_name);
     fprintf(stderr, " -quicksort : Use quicksort algorithm\n");
     fprintf(stderr, " -bubblesort : Use bubblesort algorithm\n");
+    fprintf(stderr, " -pquicksort : Use parallel quicksort algorithm\n");
+    fprintf(stderr, " -threads=<n> : Number of threads of parallel quicksort, a power of two (default %d)\n", PQS_THREADS);
+    fprintf(stderr, " -coquicksort : Use quicksort with coroutines and asynchronous page faults\n");
+    fprintf(stderr, " -coroutines=<n> : Number of coroutines of coroutine quicksort, a power of two (default %d)\n", CQS_COROUTINES);
     fprintf(stderr, " -seed=<int value> : Init randon number generator for generating the numbers\n");
     fprintf(stderr, "                     of the array to be sorted with <int value>\n");
+    fprintf(stderr, " -mergesort : Use merge sort of page sized runs\n");
+    fprintf(stderr, " -blocksort : Use k-way merge sort of page sized runs\n");
+    fprintf(stderr, " -samplesort : Use sample sort with sequential bucket distribution\n");
+    fprintf(stderr, " -workload=<name> : Run a benchmark workload instead of sorting:\n");
+    workload_print_list(stderr);
+    fprintf(stderr, " -size=<n> : Problem size of the workload\n");
+    fprintf(stderr, " -ops=<n> : Number of operations of the workload\n");
+    fprintf(stderr, " -stride=<bytes> : Stride of workload stride (default page size + 1)\n");
+    fprintf(stderr, " -pinlevels=<n> : Pin the pages of the upper n levels of workload bsearch\n");
+    fprintf(stderr, " -pin=<start>:<len> : Pin an address range before sorting\n");
+    fprintf(stderr, " -fork=<sort> : After initialisation a clone sharing the virtual memory copy-on-write\n");
+    fprintf(stderr, "                sorts by <sort>, e.g. mergesort. mmanage must serve two clients\n");
+    fprintf(stderr, " -trace=<file> : Record the accesses to virtual memory into an access trace\n");
+    fprintf(stderr, " -replay=<file> : Replay an access trace instead of sorting, e.g. a trace converted by vmimport\n");
+    fprintf(stderr, " -checkpoint : After initialisation mmanage writes a checkpoint, see mmanage -checkpoint\n");
+    fprintf(stderr, " -warmstart : Skip initialisation, the array has been restored by mmanage -restore\n");
+    fprintf(stderr, " -int32 : Sort an array of int32 values instead of bytes\n");
+    fprintf(stderr, " -unaligned : Array starts at address 1, elements may straddle page boundaries\n");
+    fprintf(stderr, " -tlb=<entries>:<ways> : Enable software TLB of vmaccess\n");
+    fprintf(stderr, " -exactticks : Range accesses advance the access counter byte by byte\n");
     fflush(stderr);
     exit(EXIT_FAILURE);
 }
@@ -22,7 +22,22 @@
 #define INIT_TYPE_UP   1   // init array with increasing numbers
 #define INIT_TYPE_DOWN 2   // init array with decreasing numbers
 
+#define ELEM_BYTE      1   // array of byte values
+#define ELEM_INT32     4   // array of int32 values
+
 #define QUICK_SORT     10  // use quick sort 
 #define BUBBLE_SORT    11  // use bubble  sort 
+#define PARALLEL_QUICK_SORT 12  // use parallel quick sort
+#define COROUTINE_QUICK_SORT 13 // use quick sort with coroutines
+#define MERGE_SORT     14  // use merge sort of page sized runs
+#define BLOCK_SORT     15  // use k-way merge sort of page sized runs
+#define SAMPLE_SORT    16  // use sample sort
+
+#define MERGE_WAYS     16  // maximal number of runs merged at once / buckets of sample sort
+#define SAMPLE_OVERSAMPLING 4 // sample elements per bucket of sample sort
+
+#define PQS_THREADS    4   // default number of threads of parallel quick sort
+#define PQS_MAXTHREADS 16  // maximal number of threads, one request slot of syncdataexchange per thread
+#define CQS_COROUTINES 8   // default number of coroutines of coroutine quick sort
 
 #endif
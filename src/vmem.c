@@ -0,0 +1,323 @@
+/**
+ * @file vmem.c
+ * @date Oct 2026
+ * @brief This module computes the geometry of virtual memory and the layout
+ * of shared memory. It is used by mmanage, that creates shared memory, and by
+ * vmaccess, that reads the geometry from the header of shared memory.
+ * It creates and attaches shared memory with the selected backing.
+ */
+
+#define _GNU_SOURCE // memfd_create
+#include <string.h>
+#include <limits.h>
+#include <strings.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "error.h"
+#include "vmem.h"
+
+struct vmem_geometry vmem_geometry; //!< geometry of this process
+static pthread_mutex_t pt_alloc_mutex = PTHREAD_MUTEX_INITIALIZER; //!< serializes allocation of nodes by the threads of mmanage
+
+static const char *backing_names[] = { "sysv", "posix", "memfd", "hugetlb" }; //!< indexed by VMEM_SHM_*
+static int shm_backing = VMEM_SHM_SYSV; //!< backing of shared memory of this process
+static int shm_id = -1;                 //!< System V id or file descriptor of shared memory
+static void *shm_start = NULL;          //!< start of shared memory
+static size_t shm_len = 0;              //!< mapped size of POSIX shared memory and memfd
+
+/**
+ * Locator of the memfd of mmanage, stored in the POSIX object VMEM_SHM_LOCATOR
+ */
+struct memfd_locator {
+    int pid;               //!< process id of mmanage
+    int fd;                //!< file descriptor of memfd in mmanage
+};
+
+/**
+ *****************************************************************************************
+ *  @brief      This function rounds a size up to the next multiple of a cache line, so
+ *              every region of shared memory starts on its own cache line.
+ *
+ *  @param      size size in bytes
+ *
+ *  @return     rounded size
+ ****************************************************************************************/
+static size_t align_line(size_t size) {
+    return (size + VMEM_CACHELINE - 1) & ~(size_t) (VMEM_CACHELINE - 1);
+}
+
+bool vmem_set_geometry(int pagesize, long virtmemsize, int physmemsize, int nclients, int hugepages) {
+    struct vmem_geometry g;
+
+    if ((pagesize <= 0) || (pagesize & (pagesize - 1)) ||
+        (virtmemsize <= 0) || (virtmemsize % pagesize) ||
+        (physmemsize <= 0) || (physmemsize % pagesize) || (virtmemsize / pagesize > VMEM_MAX_NPAGES) ||
+        (nclients <= 0) || (nclients > VMEM_MAX_CLIENTS) ||
+        (hugepages < 0) || (hugepages & (hugepages - 1)) || (hugepages == 1) || (hugepages > VMEM_MAX_HUGEPAGES) ||
+        (hugepages > physmemsize / pagesize) || (physmemsize / pagesize > VMEM_MAX_NFRAMES)) {
+        return false;
+    }
+    g.pagesize = pagesize;
+    g.virtmemsize = virtmemsize;
+    g.physmemsize = physmemsize;
+    g.npages = virtmemsize / pagesize;
+    g.nframes = physmemsize / pagesize;
+    g.nclients = nclients;
+    g.hugepages = hugepages;
+    g.page_shift = __builtin_ctz(pagesize);
+    g.offset_mask = pagesize - 1;
+    g.sectorsize = (pagesize / 64 > VMEM_MIN_SECTORSIZE) ? pagesize / 64 : VMEM_MIN_SECTORSIZE;
+    g.nsectors = (pagesize + g.sectorsize - 1) / g.sectorsize;
+    g.pt_leaves = (g.npages + PT_NODE_ENTRIES - 1) / PT_NODE_ENTRIES;
+    g.pt_roots = (g.pt_leaves + PT_NODE_ENTRIES - 1) / PT_NODE_ENTRIES;
+    vmem_geometry = g;
+    return true;
+}
+
+bool vmem_parse_size(const char *str, long *size) {
+    char suffix = '\0';
+    int shift = 0;
+    int n = sscanf(str, "%ld%c", size, &suffix);
+    if ((n == 2) && ((suffix == 'K') || (suffix == 'k'))) {
+        shift = 10;
+    } else if ((n == 2) && ((suffix == 'M') || (suffix == 'm'))) {
+        shift = 20;
+    } else if ((n == 2) && ((suffix == 'G') || (suffix == 'g'))) {
+        shift = 30;
+    } else if (n != 1) {
+        return false;
+    }
+    if ((*size <= 0) || (*size > (LONG_MAX >> shift))) {
+        return false; // the size would overflow
+    }
+    *size <<= shift;
+    return true;
+}
+
+size_t vmem_shm_size(bool with_pools) {
+    size_t nframes = vmem_geometry.nframes;
+    size_t nroots = (size_t) vmem_geometry.nclients * vmem_geometry.pt_roots;
+    size_t size = align_line(sizeof(struct vmem_header)) +
+                  align_line(nroots * sizeof(int)) +
+                  align_line(nframes * sizeof(uint8_t)) +
+                  align_line(nframes * sizeof(uint64_t)) +
+                  align_line(nframes * sizeof(int)) +
+                  align_line(nframes * vmem_geometry.pagesize);
+    if (with_pools) {
+        size += nroots * PT_NODE_ENTRIES * sizeof(int) +
+                (size_t) vmem_geometry.nclients * vmem_geometry.pt_leaves * PT_NODE_ENTRIES * sizeof(struct pt_entry);
+    }
+    return size;
+}
+
+void vmem_map(struct vmem_struct *vmem, void *shm) {
+    size_t nframes = vmem_geometry.nframes;
+    size_t nroots = (size_t) vmem_geometry.nclients * vmem_geometry.pt_roots;
+    unsigned char *p = shm;
+
+    vmem->header = shm;
+    vmem->adm = &vmem->header->adm;
+    vmem->client = NULL;
+    p += align_line(sizeof(struct vmem_header));
+    vmem->pt_root = (int *) p;
+    p += align_line(nroots * sizeof(int));
+    // regions of the frames written by vmaccess
+    vmem->access_bits = p;
+    p += align_line(nframes * sizeof(uint8_t));
+    vmem->dirty_sectors = (uint64_t *) p;
+    p += align_line(nframes * sizeof(uint64_t));
+    vmem->busy = (int *) p;
+    p += align_line(nframes * sizeof(int));
+    vmem->mainMemory = p;
+    p += align_line(nframes * vmem_geometry.pagesize);
+    // the pools follow, pages of shared memory are backed when a node is used
+    vmem->pt_mid = (int *) p;
+    p += nroots * PT_NODE_ENTRIES * sizeof(int);
+    vmem->pt_leaf = (struct pt_entry *) p;
+}
+
+struct pt_entry *vmem_pte_alloc(struct vmem_struct *vmem, int asid, long page) {
+    TEST_AND_EXIT((page < 0) || (page >= vmem_geometry.npages), (stderr, "vmem_pte_alloc: page out of range\n"));
+    TEST_AND_EXIT((asid < 0) || (asid >= vmem_geometry.nclients), (stderr, "vmem_pte_alloc: asid out of range\n"));
+    int *root = &vmem->pt_root[(long) asid * vmem_geometry.pt_roots + (page >> (2 * PT_LEVEL_BITS))];
+    pthread_mutex_lock(&pt_alloc_mutex);
+    if (*root == 0) {
+        int mid = vmem->adm->pt_mids++;
+        memset(&vmem->pt_mid[(long) mid * PT_NODE_ENTRIES], 0, PT_NODE_ENTRIES * sizeof(int));
+        __atomic_store_n(root, mid + 1, __ATOMIC_RELEASE);
+    }
+    int *entry = &vmem->pt_mid[(long) (*root - 1) * PT_NODE_ENTRIES + ((page >> PT_LEVEL_BITS) & (PT_NODE_ENTRIES - 1))];
+    if (*entry == 0) {
+        int leaf = vmem->adm->pt_leaves++;
+        // a cleared entry has no flags and no frame
+        memset(&vmem->pt_leaf[(long) leaf * PT_NODE_ENTRIES], 0, PT_NODE_ENTRIES * sizeof(struct pt_entry));
+        __atomic_store_n(entry, leaf + 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&pt_alloc_mutex);
+    return vmem_pte(vmem, asid, page);
+}
+
+int vmem_shm_backing(const char *name) {
+    for (int i = 0; i < (int) (sizeof(backing_names) / sizeof(backing_names[0])); i++) {
+        if (0 == strcasecmp(name, backing_names[i])) {
+            return i;
+        }
+    }
+    return VOID_IDX;
+}
+
+const char *vmem_shm_backing_name(int backing) {
+    return backing_names[backing];
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function removes the segments of all backings but one. They may
+ *              have been left by an old run.
+ *
+ *  @param      backing VMEM_SHM_* backing to be kept
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void remove_stale_segments(int backing) {
+    if ((backing != VMEM_SHM_SYSV) && (backing != VMEM_SHM_HUGETLB)) {
+        key_t shm_key = ftok(SHMKEY, SHMPROCID);
+        int id = (shm_key == -1) ? -1 : shmget(shm_key, 0, 0664);
+        if (id != -1) {
+            shmctl(id, IPC_RMID, NULL);
+        }
+    }
+    if (backing != VMEM_SHM_POSIX) {
+        shm_unlink(VMEM_SHM_NAME);
+    }
+    if (backing != VMEM_SHM_MEMFD) {
+        shm_unlink(VMEM_SHM_LOCATOR);
+    }
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function maps a file of shared memory.
+ *
+ *  @param      fd file descriptor
+ *  @param      size size of file
+ *
+ *  @return     start of shared memory
+ ****************************************************************************************/
+static void *map_file(int fd, size_t size) {
+    void *shm = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_NORESERVE, fd, 0);
+    TEST_AND_EXIT_ERRNO(shm == MAP_FAILED, "Error mapping shared memory");
+    shm_len = size;
+    return shm;
+}
+
+void *vmem_shm_create(int backing) {
+    size_t size = SHMSIZE;
+
+    remove_stale_segments(backing);
+    shm_backing = backing;
+    if ((backing == VMEM_SHM_SYSV) || (backing == VMEM_SHM_HUGETLB)) {
+        key_t shm_key = ftok(SHMKEY, SHMPROCID);
+        TEST_AND_EXIT_ERRNO(shm_key == -1, "ftok failed!");
+        int shm_flags = 0664 | IPC_CREAT;
+        if (backing == VMEM_SHM_HUGETLB) {
+            // huge pages are reserved on creation, so a missing huge page fails here and not on access
+            shm_flags |= SHM_HUGETLB;
+            size = (size + VMEM_HUGETLB_SIZE - 1) & ~(size_t) (VMEM_HUGETLB_SIZE - 1);
+        } else {
+#ifdef SHM_NORESERVE
+            shm_flags |= SHM_NORESERVE; // the node pools of the page table are reserved, but used sparsely
+#endif
+        }
+        shm_id = shmget(shm_key, size, shm_flags);
+        if (shm_id == -1) {
+            fprintf(stderr, "Shared memory from old run might still exists\n");
+            fprintf(stderr, "   Use ipcs -ma for checking shared memory ressources\n");
+            fprintf(stderr, "   Use ipcrm for deleting shared memory ressources\n");
+            if (backing == VMEM_SHM_HUGETLB) {
+                fprintf(stderr, "   Huge pages of the kernel must be reserved via /proc/sys/vm/nr_hugepages\n");
+            }
+        }
+        TEST_AND_EXIT_ERRNO(shm_id == -1, "shmget failed!");
+        shm_start = shmat(shm_id, NULL, 0);
+        TEST_AND_EXIT_ERRNO(shm_start == (void *) -1, "Error attaching shared memory");
+    } else if (backing == VMEM_SHM_POSIX) {
+        shm_id = shm_open(VMEM_SHM_NAME, O_RDWR | O_CREAT | O_TRUNC, 0664);
+        TEST_AND_EXIT_ERRNO(shm_id == -1, "shm_open failed!");
+        TEST_AND_EXIT_ERRNO(ftruncate(shm_id, size) == -1, "ftruncate of shared memory failed");
+        shm_start = map_file(shm_id, size);
+    } else {
+        struct memfd_locator loc;
+        shm_id = memfd_create("BS_A3_vmem", 0);
+        TEST_AND_EXIT_ERRNO(shm_id == -1, "memfd_create failed!");
+        TEST_AND_EXIT_ERRNO(ftruncate(shm_id, size) == -1, "ftruncate of shared memory failed");
+        shm_start = map_file(shm_id, size);
+        // publish the memfd for vmaccess
+        loc.pid = getpid();
+        loc.fd = shm_id;
+        int fd = shm_open(VMEM_SHM_LOCATOR, O_RDWR | O_CREAT | O_TRUNC, 0664);
+        TEST_AND_EXIT_ERRNO(fd == -1, "shm_open of memfd locator failed!");
+        TEST_AND_EXIT_ERRNO(write(fd, &loc, sizeof(loc)) != sizeof(loc), "write of memfd locator failed");
+        close(fd);
+    }
+    return shm_start;
+}
+
+void *vmem_shm_attach(void) {
+    struct stat st;
+    struct memfd_locator loc;
+    char path[64];
+
+    /* System V shared memory or huge pages: don't set the IPC_CREAT flag */
+    key_t shm_key = ftok(SHMKEY, SHMPROCID);
+    TEST_AND_EXIT_ERRNO(shm_key == -1, "ftok failed!");
+    shm_id = shmget(shm_key, 0, 0664);
+    if (shm_id != -1) {
+        shm_start = shmat(shm_id, NULL, 0);
+        TEST_AND_EXIT_ERRNO(shm_start == (void *) -1, "Error attaching shared memory");
+        return shm_start;
+    }
+    /* POSIX shared memory object */
+    shm_backing = VMEM_SHM_POSIX;
+    shm_id = shm_open(VMEM_SHM_NAME, O_RDWR, 0);
+    if (shm_id == -1) {
+        /* memfd of mmanage */
+        int fd = shm_open(VMEM_SHM_LOCATOR, O_RDONLY, 0);
+        if (fd != -1) {
+            TEST_AND_EXIT_ERRNO(read(fd, &loc, sizeof(loc)) != sizeof(loc), "read of memfd locator failed");
+            close(fd);
+            snprintf(path, sizeof(path), "/proc/%d/fd/%d", loc.pid, loc.fd);
+            shm_backing = VMEM_SHM_MEMFD;
+            shm_id = open(path, O_RDWR);
+        }
+    }
+    if (shm_id == -1) {
+        fprintf(stderr, "Shared memory of mmanage not found, mmanage must be started first\n");
+    }
+    TEST_AND_EXIT_ERRNO(shm_id == -1, "Attaching shared memory failed!");
+    TEST_AND_EXIT_ERRNO(fstat(shm_id, &st) == -1, "fstat of shared memory failed");
+    shm_start = map_file(shm_id, st.st_size);
+    return shm_start;
+}
+
+void vmem_shm_destroy(void) {
+    if ((shm_backing == VMEM_SHM_SYSV) || (shm_backing == VMEM_SHM_HUGETLB)) {
+        TEST_AND_EXIT_ERRNO(-1 == shmctl(shm_id, IPC_RMID, NULL), "shmctl failed"); // Mark vmem for deletion 
+        TEST_AND_EXIT_ERRNO(-1 == shmdt(shm_start), "shmdt failed"); // detach shared memory
+        return;
+    }
+    TEST_AND_EXIT_ERRNO(-1 == munmap(shm_start, shm_len), "munmap failed");
+    close(shm_id);
+    TEST_AND_EXIT_ERRNO(-1 == shm_unlink((shm_backing == VMEM_SHM_POSIX) ? VMEM_SHM_NAME : VMEM_SHM_LOCATOR), "shm_unlink failed");
+}
+
+int vmem_shm_id(void) {
+    return shm_id;
+}
+
+// EOF
@@ -15,50 +15,423 @@
 #ifndef VMEM_H
 #define VMEM_H
 
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
 #define SHMKEY          "./src/vmem.h" //!< First paremater for shared memory generation via ftok function
 #define SHMPROCID       1234           //!< Second paremater for shared memory generation via ftok function
 
 /**
- * Constant VMEM_PAGESIZE will be sete via compiler -D option. 
+ * Backing of shared memory, selected by mmanage via -shm. vmaccess finds the 
+ * segment by trying System V, the POSIX object and the locator of the memfd.
+ */
+#define VMEM_SHM_SYSV     0   //!< System V shared memory (default)
+#define VMEM_SHM_POSIX    1   //!< POSIX shared memory object VMEM_SHM_NAME
+#define VMEM_SHM_MEMFD    2   //!< anonymous file of mmanage, opened by vmaccess via /proc
+#define VMEM_SHM_HUGETLB  3   //!< System V shared memory backed by huge pages of the kernel
+#define VMEM_SHM_NAME       "/BS_A3_vmem"       //!< name of POSIX shared memory object
+#define VMEM_SHM_LOCATOR    "/BS_A3_vmem_memfd" //!< name of POSIX shared memory object holding pid and fd of the memfd
+#define VMEM_HUGETLB_SIZE   (2L << 20)          //!< size of a huge page of the kernel; a System V huge page segment is a multiple of it
+
+#define VMEM_CACHELINE  64    //!< size of a cache line; regions written by different processes start on their own line
+
+/**
+ * The geometry of virtual memory is set by mmanage via command line parameters
+ * (-pagesize, -virtmem, -physmem) and stored in the header of shared memory.
+ * vmaccess reads it, when it attaches to shared memory.
+ * Constant VMEM_PAGESIZE set via compiler -D option is the default page size 
+ * VMEM_DEFAULT_PAGESIZE. The option is undefined afterwards, the page size of
+ * the running system is VMEM_GEO_PAGESIZE.
  * Default value : 8
- * value range : 8 16 32 64 
  */
-#ifndef VMEM_PAGESIZE
-#define VMEM_PAGESIZE 8
+enum {
+#ifdef VMEM_PAGESIZE
+	VMEM_DEFAULT_PAGESIZE = VMEM_PAGESIZE   //!< Default page size, keeps the value of the -D option
+#else
+	VMEM_DEFAULT_PAGESIZE = 8               //!< Default page size
 #endif
+};
+#undef VMEM_PAGESIZE
+
+#ifndef VMEM_DEFAULT_VIRTMEMSIZE
+#define VMEM_DEFAULT_VIRTMEMSIZE 1024L  //!< Default size of virtual address space of the process
+#endif
+#ifndef VMEM_DEFAULT_PHYSMEMSIZE
+#define VMEM_DEFAULT_PHYSMEMSIZE  128   //!< Default size of physical memory
+#endif
+
+/**
+ * Several vmappl processes (clients) may attach to mmanage. Each client has its own
+ * address space of VMEM_VIRTMEMSIZE bytes with its own page table, identified by
+ * the address space id (ASID) 0 .. VMEM_NCLIENTS - 1. All clients share the frames.
+ */
+#define VMEM_MAX_CLIENTS  8   //!< Maximal number of address spaces
+
+/**
+ * Length of a time interval in accesses. vmaccess informs the memory manager, whenever
+ * g_count reaches a multiple of it. The trace driven simulator replays the same intervals.
+ */
+#define VMEM_TIME_WINDOW  20
+
+/**
+ * Granularity of the dirty sector bitmap of a page. A page is divided into at most 
+ * 64 sectors. Constant VMEM_SECTORSIZE set via compiler -D option is the minimal 
+ * sector size VMEM_MIN_SECTORSIZE. The option is undefined afterwards, the sector
+ * size of the running system is VMEM_GEO_SECTORSIZE.
+ * Default value : 4 bytes, but at least VMEM_GEO_PAGESIZE / 64
+ */
+enum {
+#ifdef VMEM_SECTORSIZE
+	VMEM_MIN_SECTORSIZE = VMEM_SECTORSIZE   //!< Minimal sector size, keeps the value of the -D option
+#else
+	VMEM_MIN_SECTORSIZE = 4                 //!< Minimal sector size
+#endif
+};
+#undef VMEM_SECTORSIZE
+
+/**
+ * The page table is a radix tree of three levels: the root directory refers to mid
+ * nodes, a mid node to leaf nodes, a leaf node holds the page table entries of 
+ * PT_NODE_ENTRIES pages. Mid and leaf nodes are taken from pools in shared memory,
+ * when a page of their range is fetched for the first time. So memory is used by the
+ * touched parts of virtual memory only. Virtual addresses are 64 bit (long).
+ */
+#define PT_LEVEL_BITS    9                       //!< index bits of a mid or leaf node
+#define PT_NODE_ENTRIES  (1 << PT_LEVEL_BITS)    //!< entries of a mid or leaf node
+#define VMEM_MAX_NPAGES  (1L << 32)              //!< maximal number of pages
+
+/**
+ * Geometry of virtual memory. The derived values are computed by vmem_set_geometry.
+ */
+struct vmem_geometry {
+	int pagesize;          //!< Page size, a power of two
+	long virtmemsize;      //!< Size of virtual address space of the process
+	int physmemsize;       //!< Size of physical memory
+	long npages;           //!< Total number of pages
+	int nframes;           //!< Total number of (page) frames
+	int pt_roots;          //!< entries of the root directory of the page table of an address space
+	int pt_leaves;         //!< leaf nodes required to map an address space
+	int nclients;          //!< Number of address spaces
+	int hugepages;         //!< Base pages per huge page; 0: huge pages disabled
+	int page_shift;        //!< log2(pagesize): address >> page_shift is the page number
+	int offset_mask;       //!< pagesize - 1: address & offset_mask is the offset within the page
+	int sectorsize;        //!< Size of a sector of the dirty sector bitmap
+	int nsectors;          //!< Number of sectors per page
+};
 
-/* Sizes */
-#define VMEM_VIRTMEMSIZE 1024   				//!< Size of virtual address space of the process
-#define VMEM_PHYSMEMSIZE  128   				//!< Size of physical memory
-#define VMEM_NPAGES     (VMEM_VIRTMEMSIZE / VMEM_PAGESIZE)	//!< Total number of pages 
-#define VMEM_NFRAMES (VMEM_PHYSMEMSIZE / VMEM_PAGESIZE)		//!< Total number of (page) frames 
+extern struct vmem_geometry vmem_geometry; //!< Geometry of this process, see vmem_set_geometry
+
+/*
+ * Geometry of the running system. The page size and the sector size have names of 
+ * their own, VMEM_PAGESIZE and VMEM_SECTORSIZE are compile time options only.
+ */
+#define VMEM_GEO_PAGESIZE   (vmem_geometry.pagesize)
+#define VMEM_VIRTMEMSIZE    (vmem_geometry.virtmemsize)
+#define VMEM_PHYSMEMSIZE    (vmem_geometry.physmemsize)
+#define VMEM_NPAGES         (vmem_geometry.npages)
+#define VMEM_NFRAMES        (vmem_geometry.nframes)
+#define VMEM_PAGESHIFT      (vmem_geometry.page_shift)
+#define VMEM_OFFSETMASK     (vmem_geometry.offset_mask)
+#define VMEM_GEO_SECTORSIZE (vmem_geometry.sectorsize)
+#define VMEM_NSECTORS       (vmem_geometry.nsectors)
+
+#define VMEM_NCLIENTS    (vmem_geometry.nclients)
+#define VMEM_HUGEPAGES   (vmem_geometry.hugepages)
+#define VMEM_NBACKING_PAGES ((long) VMEM_NCLIENTS * VMEM_NPAGES) //!< Pages of backing store: the address spaces one after another
 
 /**
- * page table flags used by this simulation
+ * Huge pages: mmanage may promote an aligned run of VMEM_HUGEPAGES base pages of 
+ * an address space into a huge frame, i.e. an aligned run of as many frames. Each 
+ * page table entry of the run keeps its frame and gets PTF_HUGE, so vmaccess may 
+ * cache the whole run by one TLB entry. Ref and Dirty bits stay per base page.
+ */
+#define VMEM_MAX_HUGEPAGES 64  //!< Maximal number of base pages per huge page
+
+/**
+ * page table flags used by this simulation. PTF_DIRTY and PTF_REF are written by
+ * vmaccess; they are kept per frame in vmem_struct.access_bits, so vmaccess never
+ * writes the page table.
  */
 #define PTF_PRESENT     1	// 0001
 #define PTF_DIRTY       2 	// 0010	//!< store: need to write 
 #define PTF_REF         4   // 0100 
+#define PTF_PINNED      8   // 1000 //!< page is exempt from replacement, see vmem_pin
+#define PTF_HUGE        16  //!< page is part of a huge page: frame of page = frame of first page of the run + offset in run
+#define PTF_SHARED      32  //!< frame is shared by merged or forked pages, kept in access_bits only: a store needs CMD_COW first
 
 #define VOID_IDX -1       //!< Constant for invalid page or frame reference 
 
 /**
- * Page table entry
+ * Page table entry, packed into 32 bits: bits 0 .. PTE_FLAG_BITS - 1 hold the PTF_* 
+ * flags written by mmanage, the upper bits frame + 1 (0: no frame). An entry is 
+ * read and written as a whole, see pte_flags, pte_frame and pte_set.
+ * The frame of an entry without PTF_PRESENT may name the address space whose 
+ * backing store holds the page instead, see vmem_fork.
  */
 struct pt_entry {
-	int flags;             //!< See definition of PTF_* flags 
-	int frame;             //!< Frame idx; frame == VOID_IDX: unvalid reference  
+	uint32_t word;         //!< flags and frame
+};
+
+#define PTE_FLAG_BITS     5                                      //!< bits of the flags of a page table entry
+#define PTE_FLAG_MASK     ((1u << PTE_FLAG_BITS) - 1)            //!< flags of a page table entry
+#define VMEM_MAX_NFRAMES  ((int) ((1u << (32 - PTE_FLAG_BITS)) - 1)) //!< maximal number of frames of a page table entry
+
+/**
+ *****************************************************************************************
+ *  @brief      These functions read and write a page table entry atomically.
+ *
+ *  @param      pte Page table entry
+ *
+ *  @return     PTF_* flags of entry, frame of entry (VOID_IDX: none)
+ ****************************************************************************************/
+static inline int pte_flags(const struct pt_entry *pte) {
+	return __atomic_load_n(&pte->word, __ATOMIC_SEQ_CST) & PTE_FLAG_MASK;
+}
+
+static inline int pte_frame(const struct pt_entry *pte) {
+	return (int) (__atomic_load_n(&pte->word, __ATOMIC_SEQ_CST) >> PTE_FLAG_BITS) - 1;
+}
+
+static inline void pte_set(struct pt_entry *pte, int frame, int flags) {
+	__atomic_store_n(&pte->word, ((uint32_t) (frame + 1) << PTE_FLAG_BITS) | (uint32_t) flags, __ATOMIC_SEQ_CST);
+}
+
+static inline void pte_set_flags(struct pt_entry *pte, int flags) {
+	__atomic_fetch_or(&pte->word, (uint32_t) flags, __ATOMIC_SEQ_CST);
+}
+
+static inline void pte_clear_flags(struct pt_entry *pte, int flags) {
+	__atomic_fetch_and(&pte->word, ~(uint32_t) flags, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Statistics of the software TLB of vmaccess
+ */
+struct vmem_tlb_stats {
+	int entries;           //!< number of entries; 0: TLB disabled
+	int ways;              //!< associativity
+	long hits;             //!< translations found in TLB
+	long misses;           //!< translations looked up in page table
+	long shootdowns;       //!< evict epochs handled
+	long walks;            //!< translations looked up in page table (TLB misses or TLB disabled)
+	long huge_hits;        //!< translations found in a TLB entry of a huge page
+};
+
+/**
+ * Administrative data shared by mmanage and vmaccess. It is written by mmanage only.
+ */
+struct vmem_adm {
+	int pt_mids;           //!< mid nodes of the page table taken from the pool, written by mmanage
+	int pt_leaves;         //!< leaf nodes of the page table taken from the pool, written by mmanage
+	unsigned long tlb_evict_epoch; //!< incremented by mmanage, when a page has been removed
+	unsigned long tlb_ref_epoch;   //!< incremented by mmanage, when Ref bits have been reset
+	int fork_enabled;      //!< mmanage supports vmem_fork, written by mmanage
+} __attribute__((aligned(VMEM_CACHELINE)));
+
+/**
+ * States of a client entry
+ */
+#define VMEM_CLIENT_FREE      0   //!< address space not used yet
+#define VMEM_CLIENT_ATTACHED  1   //!< client is running
+#define VMEM_CLIENT_DETACHED  2   //!< client has finished; the address space will not be used again
+
+/**
+ * Data of a client. A vmappl process claims the first free entry, when it attaches 
+ * to shared memory; the index of the entry is its ASID. The statistics are written 
+ * by vmaccess. Each entry starts on its own cache line.
+ */
+struct vmem_client {
+	int state;             //!< See VMEM_CLIENT_* states
+	int pid;               //!< process id of client
+	struct vmem_tlb_stats tlb;     //!< TLB statistics, written by vmaccess on exit
+
+	long silent_stores;    //!< number of stores skipped by vmaccess, because memory contained the value already
+	long straddles;        //!< number of multi byte accesses that straddle a page boundary
+
+	int threaded;          //!< vmaccess runs in thread safe mode
+	long coalesced_faults; //!< page faults of a thread that waited for the request of another thread
+	long g_count;          //!< g_count of a restored checkpoint, taken over by vmaccess on attach
+} __attribute__((aligned(VMEM_CACHELINE)));
+
+/**
+ * Header of shared memory. The header is followed by the root directories of the 
+ * page tables, the access bits, dirty sector bitmaps and busy counters of the frames,
+ * main memory and the node pools of the page tables, see vmem_map. Each region 
+ * starts on a cache line: the page table is written by mmanage only, the regions
+ * of the frames mostly by vmaccess.
+ */
+struct vmem_header {
+	struct vmem_geometry geometry;                 //!< geometry set by mmanage
+	struct vmem_adm adm;                           //!< administrative data
+	struct vmem_client clients[VMEM_MAX_CLIENTS];  //!< clients indexed by ASID
 };
 
 // physischer speicher
 /**
- * The data structure stored in shared memory
+ * View of the data structure stored in shared memory. The pointers refer to the 
+ * shared memory of the process, they are set by vmem_map.
  */
 struct vmem_struct {
-	struct pt_entry pt[VMEM_NPAGES];               //!< page table 
-	unsigned char mainMemory[VMEM_NFRAMES * VMEM_PAGESIZE];  //!< main memory used by virtual memory simulation 
+	struct vmem_header *header;                    //!< start of shared memory
+	struct vmem_adm *adm;                          //!< administrative data
+	struct vmem_client *client;                    //!< entry of the client; set by vmaccess only
+	int *pt_root;                                  //!< root directories of the address spaces: index + 1 of mid node; 0: none
+	uint8_t *access_bits;                          //!< per frame: PTF_REF and PTF_DIRTY of the page stored in the frame, set by vmaccess; PTF_SHARED, set by mmanage
+	uint64_t *dirty_sectors;                       //!< per frame: bit i set: sector i of page has been modified since page was fetched
+	int *busy;                                     //!< per frame: number of threads accessing the frame; mmanage waits for 0 before removing its page
+	unsigned char *mainMemory;                     //!< main memory used by virtual memory simulation, VMEM_NFRAMES * VMEM_GEO_PAGESIZE bytes, aligned to a cache line
+	int *pt_mid;                                   //!< pool of mid nodes: index + 1 of leaf node; 0: none
+	struct pt_entry *pt_leaf;                      //!< pool of leaf nodes
 };
 
-#define SHMSIZE (sizeof(struct vmem_struct)) //!< size of virtual memory 
+/**
+ *****************************************************************************************
+ *  @brief      This function looks up the page table entry of a page. It is defined
+ *              here, because it is on the path of every access.
+ *
+ *  @param      vmem View of shared memory
+ *  @param      asid Address space of page
+ *  @param      page Number of page
+ *
+ *  @return     page table entry; NULL, if no leaf node has been allocated for the page,
+ *              i.e. the page has never been present.
+ ****************************************************************************************/
+static inline struct pt_entry *vmem_pte(const struct vmem_struct *vmem, int asid, long page) {
+	int mid = __atomic_load_n(&vmem->pt_root[(long) asid * vmem_geometry.pt_roots + (page >> (2 * PT_LEVEL_BITS))], __ATOMIC_ACQUIRE);
+	if (mid == 0) {
+		return NULL;
+	}
+	int leaf = __atomic_load_n(&vmem->pt_mid[(long) (mid - 1) * PT_NODE_ENTRIES + ((page >> PT_LEVEL_BITS) & (PT_NODE_ENTRIES - 1))], __ATOMIC_ACQUIRE);
+	if (leaf == 0) {
+		return NULL;
+	}
+	return &vmem->pt_leaf[(long) (leaf - 1) * PT_NODE_ENTRIES + (page & (PT_NODE_ENTRIES - 1))];
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function looks up the page table entry of a page and allocates 
+ *              the nodes of the page table on the path to it. It must be called by 
+ *              mmanage only, the nodes are published after they have been initialized.
+ *
+ *  @param      vmem View of shared memory
+ *  @param      asid Address space of page
+ *  @param      page Number of page
+ *
+ *  @return     page table entry
+ ****************************************************************************************/
+struct pt_entry *vmem_pte_alloc(struct vmem_struct *vmem, int asid, long page);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function checks a geometry and sets vmem_geometry.
+ *
+ *  @param      pagesize Page size, a power of two
+ *  @param      virtmemsize Size of virtual memory, a multiple of pagesize
+ *  @param      physmemsize Size of physical memory, a multiple of pagesize
+ *  @param      nclients Number of address spaces, at most VMEM_MAX_CLIENTS
+ *  @param      hugepages Base pages per huge page, a power of two of at most 
+ *              VMEM_MAX_HUGEPAGES and the number of frames; 0: no huge pages
+ *
+ *  @return     false, if the geometry is invalid. vmem_geometry is unchanged then.
+ ****************************************************************************************/
+bool vmem_set_geometry(int pagesize, long virtmemsize, int physmemsize, int nclients, int hugepages);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function parses a size with optional suffix K, M or G (powers of 1024).
+ *
+ *  @param      str string to be parsed
+ *  @param      size parsed size
+ *
+ *  @return     false, if str is not a valid size
+ ****************************************************************************************/
+bool vmem_parse_size(const char *str, long *size);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function computes the size of shared memory for vmem_geometry.
+ *
+ *  @param      with_pools false: size of the part preceding the node pools of the 
+ *              page table. This part must be cleared by mmanage, nodes will be cleared
+ *              on allocation.
+ *
+ *  @return     size of shared memory in bytes
+ ****************************************************************************************/
+size_t vmem_shm_size(bool with_pools);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function sets the pointers of a view to shared memory according 
+ *              to vmem_geometry.
+ *
+ *  @param      vmem View to be set
+ *  @param      shm Start of shared memory
+ *
+ *  @return     void
+ ****************************************************************************************/
+void vmem_map(struct vmem_struct *vmem, void *shm);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function converts the name of a backing of shared memory.
+ *
+ *  @param      name sysv, posix, memfd or hugetlb
+ *
+ *  @return     VMEM_SHM_* backing; VOID_IDX, if name is undefined
+ ****************************************************************************************/
+int vmem_shm_backing(const char *name);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the name of a backing of shared memory.
+ *
+ *  @param      backing VMEM_SHM_* backing
+ *
+ *  @return     name
+ ****************************************************************************************/
+const char *vmem_shm_backing_name(int backing);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function creates and attaches shared memory of SHMSIZE bytes.
+ *              Segments of other backings left by an old run will be removed, so
+ *              vmaccess finds the new segment only. Called by mmanage.
+ *
+ *  @param      backing VMEM_SHM_* backing
+ *
+ *  @return     start of shared memory
+ ****************************************************************************************/
+void *vmem_shm_create(int backing);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function attaches shared memory created by mmanage. Called by 
+ *              vmaccess.
+ *
+ *  @return     start of shared memory
+ ****************************************************************************************/
+void *vmem_shm_attach(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function detaches and removes shared memory created by 
+ *              vmem_shm_create.
+ *
+ *  @return     void
+ ****************************************************************************************/
+void vmem_shm_destroy(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the id of shared memory: the System V id or the
+ *              file descriptor.
+ *
+ *  @return     id
+ ****************************************************************************************/
+int vmem_shm_id(void);
+
+#define SHMSIZE (vmem_shm_size(true)) //!< size of virtual memory 
 
 #endif /* VMEM_H */
@@ -0,0 +1,468 @@
+/**
+ * @file vmimport.c
+ * @date Oct 2026
+ *
+ * @brief Importer of memory traces of real applications
+ *
+ * vmimport converts a memory trace into an access trace of the format of
+ * trace.h, that may be replayed by vmappl -replay=<trace> or simulated by
+ * vmsim. Two input formats are read:
+ *
+ * lackey:  output of valgrind --tool=lackey --trace-mem=yes, e.g.
+ *          "I  04016a4d,3", " L 7ff000398,8", " S 04222cac,4", " M 0421e0a0,4"
+ *          Instruction fetches (I) are dropped unless -instr is given, a
+ *          modify (M) is a load followed by a store. Other lines are skipped.
+ * csv:     "<op>,<address>[,<size>]" with op R, W, L, S, M or I and the address
+ *          in decimal or 0x hex notation; size defaults to 1. Empty lines, lines
+ *          starting with # and a header line are skipped.
+ *
+ * The input is read line by line, so its size is not limited. The addresses
+ * of an application are spread over a 64 bit address space. They are folded
+ * into the virtual memory of the simulation in granules of -granule bytes:
+ * compact folding assigns slots in order of first touch, keeping the working
+ * set of the application, mod folding takes the granule number modulo the
+ * number of slots. The memory used is bounded by the number of slots. When
+ * compact folding runs out of slots, further granules are folded mod.
+ *
+ * An access of more than 8 bytes is split into 8 byte values, an access of
+ * other sizes into values of 4, 2 and 1 bytes, as vmaccess reads and writes
+ * values of these sizes only. An access crossing a granule is split as well.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <limits.h>
+
+#include "error.h"
+#include "vmem.h"
+#include "trace.h"
+
+#define IMPORT_BUFSIZE   (1 << 20)   //!< size of the stdio buffer of the trace
+#define IMPORT_GRANULE   4096        //!< default granule of folding: the page size of the application
+#define IMPORT_MAXVALUE  8           //!< largest value read or written by vmaccess
+
+#define FORMAT_LACKEY    0           //!< valgrind lackey
+#define FORMAT_CSV       1           //!< comma separated values
+
+/**
+ * Folding of application addresses into virtual memory
+ */
+struct fold {
+    bool compact;               //!< slots in order of first touch; otherwise granule modulo nslots
+    long granule;               //!< size of a granule, a power of two
+    int shift;                  //!< log2 of granule
+    long nslots;                //!< number of granules of virtual memory
+    long used;                  //!< slots assigned by compact folding
+    long overflow;              //!< granules folded mod, because all slots were assigned
+    unsigned long *keys;        //!< hash table: granule + 1 of the application; 0: entry unused
+    long *slots;                //!< hash table: slot of granule
+    unsigned long mask;         //!< number of entries of hash table - 1
+};
+
+/**
+ * Counters of the conversion
+ */
+struct import_stats {
+    long lines;                 //!< lines read
+    long skipped;               //!< lines that are no access
+    long instr;                 //!< instruction fetches dropped
+    long loads;                 //!< loads converted
+    long stores;                //!< stores converted
+};
+
+/*
+ * Signatures of private / static functions
+ */
+
+/**
+ *****************************************************************************************
+ *  @brief      This function scans all parameters of the program.
+ *              The corresponding global variables will be set.
+ *
+ *  @param      argc number of parameters
+ *  @param      argv parameters
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void scan_params(int argc, char **argv);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function initializes the folding into vmem_geometry.
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void init_fold(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the slot of a granule of the application.
+ *
+ *  @param      granule Number of the granule
+ *
+ *  @return     slot
+ ****************************************************************************************/
+static long fold_granule(unsigned long granule);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function parses a line of the input.
+ *
+ *  @param      line Line
+ *  @param      op Operation: one of I, L, S, M, upper case
+ *  @param      address Address of the application
+ *  @param      size Number of bytes
+ *
+ *  @return     false, if the line is no access
+ ****************************************************************************************/
+static bool parse_lackey(const char *line, char *op, unsigned long *address, long *size);
+static bool parse_csv(const char *line, char *op, unsigned long *address, long *size);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function converts an access of the application into events.
+ *
+ *  @param      address Address of the application
+ *  @param      size Number of bytes
+ *  @param      write true for a store
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void convert_access(unsigned long address, long size, bool write);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function appends an event to the trace.
+ *
+ *  @param      address Address in virtual memory
+ *  @param      len Number of bytes, at most IMPORT_MAXVALUE
+ *  @param      write true for a store
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void put_event(long address, int len, bool write);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function prints an error message and the usage information of
+ *              this program.
+ *
+ *  @param      err_str pointer to the error string that should be printed.
+ *  @param      programName pointer to the name of the program
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void print_usage_info_and_exit(char *err_str, char *programName);
+
+/*
+ * variables of the importer
+ */
+
+static int format = FORMAT_LACKEY;             //!< input format set via -format
+static bool keep_instr = false;                //!< convert instruction fetches to loads, set via -instr
+static int pagesize = VMEM_DEFAULT_PAGESIZE;   //!< geometry of the trace set via -pagesize, -virtmem and -physmem
+static long virtmemsize = VMEM_DEFAULT_VIRTMEMSIZE;
+static int physmemsize = VMEM_DEFAULT_PHYSMEMSIZE;
+static int seed = 0;                           //!< seed of the trace header
+static const char *name = NULL;                //!< workload of the trace header; NULL: name of format
+static const char *input_file = NULL;          //!< memory trace; "-": stdin
+static const char *trace_file = NULL;          //!< access trace to be created
+
+static struct fold fold = { .compact = true, .granule = IMPORT_GRANULE };
+static struct import_stats stats;
+static FILE *out = NULL;                       //!< access trace
+static struct trace_header hdr;                //!< header, completed when all events have been written
+static long next = 0;                          //!< end of the previous event
+
+int main(int argc, char **argv) {
+    scan_params(argc, argv);
+    init_fold();
+
+    FILE *in = stdin;
+    if (strcmp(input_file, "-") != 0) {
+        in = fopen(input_file, "r");
+        TEST_AND_EXIT_ERRNO(!in, "Error opening memory trace");
+    }
+    out = fopen(trace_file, "w");
+    TEST_AND_EXIT_ERRNO(!out, "Error creating trace");
+    setvbuf(out, NULL, _IOFBF, IMPORT_BUFSIZE);
+    trace_init_header(&hdr, seed, name ? name : (format == FORMAT_CSV ? "csv" : "lackey"));
+    TEST_AND_EXIT_ERRNO(fwrite(&hdr, sizeof(hdr), 1, out) != 1, "Error writing trace");
+
+    char *line = NULL;
+    size_t linecap = 0;
+    while (getline(&line, &linecap, in) != -1) {
+        char op = '\0';
+        unsigned long address = 0;
+        long size = 0;
+        stats.lines++;
+        bool ok = (format == FORMAT_CSV) ? parse_csv(line, &op, &address, &size)
+                                         : parse_lackey(line, &op, &address, &size);
+        if (!ok) {
+            stats.skipped++;
+            continue;
+        }
+        switch (op) {
+            case 'I':
+                if (!keep_instr) {
+                    stats.instr++;
+                    break;
+                }
+                // fall through: fetch is a load
+            case 'L':
+                convert_access(address, size, false);
+                stats.loads++;
+                break;
+            case 'M':
+                convert_access(address, size, false);
+                stats.loads++;
+                // fall through: modify stores after the load
+            case 'S':
+                convert_access(address, size, true);
+                stats.stores++;
+                break;
+        }
+    }
+    TEST_AND_EXIT_ERRNO(ferror(in), "Error reading memory trace");
+    free(line);
+    if (in != stdin) {
+        fclose(in);
+    }
+
+    // the header is completed like the header of a recorded trace
+    TEST_AND_EXIT_ERRNO(fseek(out, 0, SEEK_SET) == -1, "Error writing trace header");
+    TEST_AND_EXIT_ERRNO(fwrite(&hdr, sizeof(hdr), 1, out) != 1, "Error writing trace header");
+    TEST_AND_EXIT_ERRNO(fclose(out) != 0, "Error writing trace");
+
+    printf("Lines            %10ld, skipped %10ld, instruction fetches dropped %10ld\n",
+           stats.lines, stats.skipped, stats.instr);
+    printf("Loads            %10ld, stores %10ld\n", stats.loads, stats.stores);
+    printf("Events           %10ld, accesses %10ld\n", hdr.events, hdr.accesses);
+    printf("Folding          %10s, granule %10ld, slots %10ld, used %10ld, overflow %10ld\n",
+           fold.compact ? "compact" : "mod", fold.granule, fold.nslots, fold.compact ? fold.used : fold.nslots,
+           fold.overflow);
+    return 0;
+}
+
+void scan_params(int argc, char **argv) {
+    bool param_ok = false;
+    char *programName = argv[0];
+    const char *format_str = "-format=";
+    const char *fold_str = "-fold=";
+    const char *granule_str = "-granule=";
+    const char *pagesize_str = "-pagesize=";
+    const char *virtmem_str = "-virtmem=";
+    const char *physmem_str = "-physmem=";
+    const char *seed_str = "-seed=";
+    const char *name_str = "-name=";
+
+    // scan all parameters (argv[0] points to program name)
+    for (int i = 1; i < argc; i++) {
+        param_ok = false;
+        if (0 == strncasecmp(format_str, argv[i], strlen(format_str))) {
+            // input format
+            const char *f = argv[i] + strlen(format_str);
+            param_ok = true;
+            if (0 == strcasecmp(f, "lackey")) {
+                format = FORMAT_LACKEY;
+            } else if (0 == strcasecmp(f, "csv")) {
+                format = FORMAT_CSV;
+            } else {
+                param_ok = false;
+            }
+        }
+        if (0 == strncasecmp(fold_str, argv[i], strlen(fold_str))) {
+            // folding of addresses
+            const char *f = argv[i] + strlen(fold_str);
+            param_ok = (0 == strcasecmp(f, "compact")) || (0 == strcasecmp(f, "mod"));
+            fold.compact = (0 == strcasecmp(f, "compact"));
+        }
+        if (0 == strncasecmp(granule_str, argv[i], strlen(granule_str))) {
+            // granule of folding, checked by init_fold
+            param_ok = vmem_parse_size(argv[i] + strlen(granule_str), &fold.granule);
+        }
+        if (0 == strcasecmp("-instr", argv[i])) {
+            // instruction fetches are loads
+            keep_instr = true;
+            param_ok = true;
+        }
+        if (0 == strncasecmp(pagesize_str, argv[i], strlen(pagesize_str))) {
+            // page size, checked by vmem_set_geometry
+            param_ok = (1 == sscanf(argv[i] + strlen(pagesize_str), "%d", &pagesize));
+        }
+        if (0 == strncasecmp(virtmem_str, argv[i], strlen(virtmem_str))) {
+            // size of virtual memory
+            param_ok = vmem_parse_size(argv[i] + strlen(virtmem_str), &virtmemsize);
+        }
+        if (0 == strncasecmp(physmem_str, argv[i], strlen(physmem_str))) {
+            // size of physical memory
+            long size = 0;
+            param_ok = vmem_parse_size(argv[i] + strlen(physmem_str), &size) && (size <= INT_MAX);
+            physmemsize = size;
+        }
+        if (0 == strncasecmp(seed_str, argv[i], strlen(seed_str))) {
+            // seed of the trace header
+            param_ok = (1 == sscanf(argv[i] + strlen(seed_str), "%d", &seed));
+        }
+        if (0 == strncasecmp(name_str, argv[i], strlen(name_str))) {
+            // workload of the trace header
+            name = argv[i] + strlen(name_str);
+            param_ok = *name != '\0';
+        }
+        if ((argv[i][0] != '-') || (0 == strcmp(argv[i], "-"))) {
+            if (input_file == NULL) {
+                input_file = argv[i];
+                param_ok = true;
+            } else if (trace_file == NULL) {
+                trace_file = argv[i];
+                param_ok = true;
+            }
+        }
+        if (!param_ok) print_usage_info_and_exit("Undefined parameter.\n", programName); // undefined parameter found
+    }
+    if ((input_file == NULL) || (trace_file == NULL)) {
+        print_usage_info_and_exit("Memory trace or trace missing.\n", programName);
+    }
+    if (!vmem_set_geometry(pagesize, virtmemsize, physmemsize, 1, 0)) {
+        print_usage_info_and_exit("Invalid geometry of virtual memory.\n", programName);
+    }
+    if (fold.granule & (fold.granule - 1)) {
+        print_usage_info_and_exit("Granule is not a power of two.\n", programName);
+    }
+}
+
+void init_fold(void) {
+    if (fold.granule > VMEM_VIRTMEMSIZE) {
+        fold.granule = VMEM_VIRTMEMSIZE & -VMEM_VIRTMEMSIZE; // largest power of two dividing virtual memory
+    }
+    if (fold.granule < IMPORT_MAXVALUE) {
+        fold.granule = IMPORT_MAXVALUE;
+    }
+    fold.shift = __builtin_ctzl(fold.granule);
+    fold.nslots = VMEM_VIRTMEMSIZE / fold.granule;
+    if (!fold.compact) {
+        return;
+    }
+    // load factor of at most 1/2
+    unsigned long entries = 2;
+    while (entries < 2 * (unsigned long) fold.nslots) {
+        entries <<= 1;
+    }
+    fold.mask = entries - 1;
+    fold.keys = calloc(entries, sizeof(unsigned long));
+    fold.slots = malloc(entries * sizeof(long));
+    TEST_AND_EXIT_ERRNO(!fold.keys || !fold.slots, "Error allocating folding");
+}
+
+long fold_granule(unsigned long granule) {
+    if (!fold.compact) {
+        return granule % fold.nslots;
+    }
+    unsigned long i = (granule * 0x9E3779B97F4A7C15ul) & fold.mask;
+    while (fold.keys[i] != 0) {
+        if (fold.keys[i] == granule + 1) {
+            return fold.slots[i];
+        }
+        i = (i + 1) & fold.mask;
+    }
+    if (fold.used == fold.nslots) {
+        fold.overflow++;
+        return granule % fold.nslots; // not entered, so the table stays bounded
+    }
+    fold.keys[i] = granule + 1;
+    fold.slots[i] = fold.used++;
+    return fold.slots[i];
+}
+
+bool parse_lackey(const char *line, char *op, unsigned long *address, long *size) {
+    // instruction fetches start in column 0, data accesses in column 1
+    if ((sscanf(line, " %c %lx,%ld", op, address, size) != 3) || (*size <= 0)) {
+        return false;
+    }
+    return (*op == 'I') || (*op == 'L') || (*op == 'S') || (*op == 'M');
+}
+
+bool parse_csv(const char *line, char *op, unsigned long *address, long *size) {
+    char *end = NULL;
+    while (isspace((unsigned char) *line)) {
+        line++;
+    }
+    *op = toupper((unsigned char) *line);
+    if ((*op == 'R') || (*op == 'W')) {
+        *op = (*op == 'R') ? 'L' : 'S';
+    } else if ((*op != 'I') && (*op != 'L') && (*op != 'S') && (*op != 'M')) {
+        return false; // comment or header
+    }
+    line++;
+    while (isspace((unsigned char) *line)) {
+        line++;
+    }
+    if (*line++ != ',') {
+        return false;
+    }
+    *address = strtoul(line, &end, 0);
+    if (end == line) {
+        return false;
+    }
+    *size = 1;
+    line = end;
+    while (isspace((unsigned char) *line)) {
+        line++;
+    }
+    if (*line == ',') {
+        *size = strtol(line + 1, &end, 0);
+        if ((end == line + 1) || (*size <= 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void convert_access(unsigned long address, long size, bool write) {
+    while (size > 0) {
+        // largest value fitting into size and the rest of the granule
+        long rest = fold.granule - (long) (address & (fold.granule - 1));
+        int len = IMPORT_MAXVALUE;
+        while ((len > size) || (len > rest)) {
+            len >>= 1;
+        }
+        long slot = fold_granule(address >> fold.shift);
+        put_event((slot << fold.shift) | (long) (address & (fold.granule - 1)), len, write);
+        address += len;
+        size -= len;
+    }
+}
+
+void put_event(long address, int len, bool write) {
+    unsigned char buf[TRACE_MAXEVENT];
+    struct trace_event ev;
+    ev.address = address;
+    ev.len = len;
+    ev.kind = (write ? TRACE_WRITE : 0) | (len > 1 ? TRACE_VALUE : 0);
+    size_t n = trace_encode(buf, &ev, &next);
+    TEST_AND_EXIT_ERRNO(fwrite(buf, n, 1, out) != 1, "Error writing trace");
+    hdr.events++;
+    hdr.accesses += trace_accesses(&ev);
+}
+
+void print_usage_info_and_exit(char *err_str, char *programName) {
+    fprintf(stderr, "Wrong parameter: %s\n", err_str);
+    fprintf(stderr, "Usage : %s [OPTIONS] <memory trace> <trace>\n", programName);
+    fprintf(stderr, " <memory trace>          : Input file; - reads stdin.\n");
+    fprintf(stderr, " <trace>                 : Access trace to be created, see vmappl -replay and vmsim.\n");
+    fprintf(stderr, " -format=[lackey,csv]    : valgrind --tool=lackey --trace-mem=yes or <op>,<address>[,<size>] (default lackey).\n");
+    fprintf(stderr, " -instr                  : Convert instruction fetches to loads instead of dropping them.\n");
+    fprintf(stderr, " -fold=[compact,mod]     : Granules in order of first touch or granule modulo number of slots (default compact).\n");
+    fprintf(stderr, " -granule=<bytes>        : Granule of folding, a power of two (default %d).\n", IMPORT_GRANULE);
+    fprintf(stderr, " -pagesize=<bytes>       : Page size of the trace header (default %d).\n", VMEM_DEFAULT_PAGESIZE);
+    fprintf(stderr, " -virtmem=<bytes>        : Size of virtual memory, suffix K, M or G (default %ld).\n", VMEM_DEFAULT_VIRTMEMSIZE);
+    fprintf(stderr, " -physmem=<bytes>        : Size of physical memory of the trace header, suffix K, M or G (default %d).\n", VMEM_DEFAULT_PHYSMEMSIZE);
+    fprintf(stderr, " -seed=<n>               : Seed of the trace header (default 0).\n");
+    fprintf(stderr, " -name=<name>            : Workload of the trace header (default name of format).\n");
+    exit(EXIT_FAILURE);
+}
+
+// EOF
@@ -0,0 +1,206 @@
+/**
+ * @file vmmon.c
+ * @date Oct 2026
+ *
+ * @brief Monitor of a running simulation of TI BSP A3 virtual memory
+ *
+ * vmmon attaches the live statistics of mmanage -stats read-only and prints
+ * the rates of the counters every interval, like vmstat. The simulation is
+ * not affected: mmanage and vmaccess update the counters anyway, vmmon only
+ * reads them. vmmon terminates, when mmanage has terminated.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "error.h"
+#include "livestats.h"
+
+#define VMMON_HEADER_LINES 20   //!< the column header is repeated after this number of lines
+
+/**
+ * Counters of all clients and of mmanage at a point of time
+ */
+struct snapshot {
+    double time_s;              //!< CLOCK_MONOTONIC
+    long faults;
+    long writebacks;
+    long bytes_read;
+    long bytes_written;
+    long selections;
+    long scanned;
+    long ticks;
+    long ipc_round_trips;
+    long ipc_wait_ns;
+    int resident_frames;
+    int dirty_frames;
+};
+
+/*
+ * Signatures of private / static functions
+ */
+
+/**
+ *****************************************************************************************
+ *  @brief      This function scans all parameters of the program.
+ *              The corresponding global variables will be set.
+ *
+ *  @param      argc number of parameters
+ *  @param      argv parameters
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void scan_params(int argc, char **argv);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function reads the counters of the live statistics.
+ *
+ *  @param      snap Counters read
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void take_snapshot(struct snapshot *snap);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function prints the rates of the counters between two snapshots
+ *              and the gauges of the later one.
+ *
+ *  @param      prev Earlier snapshot
+ *  @param      cur Later snapshot
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void print_rates(const struct snapshot *prev, const struct snapshot *cur);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function prints an error message and the usage information of
+ *              this program.
+ *
+ *  @param      err_str pointer to the error string that should be printed.
+ *  @param      programName pointer to the name of the program
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void print_usage_info_and_exit(char *err_str, char *programName);
+
+/*
+ * variables of the monitor
+ */
+
+static int interval_ms = 1000;                 //!< interval set via -interval
+static int count = 0;                          //!< number of lines set via -count; 0: until mmanage terminates
+static const struct livestats *ls = NULL;      //!< live statistics, read-only
+
+int main(int argc, char **argv) {
+    struct snapshot prev;
+    struct snapshot cur;
+
+    scan_params(argc, argv);
+    ls = livestats_attach(false);
+    TEST_AND_EXIT(ls == NULL, (stderr, "Live statistics not found, mmanage must be started with -stats\n"));
+    printf("mmanage pid %d, %s, page size %d, %d frames, %d clients\n",
+           ls->pid, pagerep_name(ls->algo), ls->pagesize, ls->nframes, ls->nclients);
+
+    take_snapshot(&prev);
+    for (int lines = 0; (count == 0) || (lines < count); lines++) {
+        usleep(interval_ms * 1000L);
+        take_snapshot(&cur);
+        if (lines % VMMON_HEADER_LINES == 0) {
+            printf("%10s %10s %8s %10s %10s %9s %8s %6s %8s %8s\n", "faults/s", "ticks/s", "wb/s",
+                   "rd KB/s", "wr KB/s", "ipc/s", "rtt us", "scan", "resident", "dirty");
+        }
+        print_rates(&prev, &cur);
+        fflush(stdout);
+        prev = cur;
+        if ((kill(ls->pid, 0) == -1) && (errno == ESRCH)) {
+            printf("mmanage has terminated\n");
+            break;
+        }
+    }
+    return 0;
+}
+
+void scan_params(int argc, char **argv) {
+    bool param_ok = false;
+    char *programName = argv[0];
+    const char *interval_str = "-interval=";
+    const char *count_str = "-count=";
+
+    // scan all parameters (argv[0] points to program name)
+    for (int i = 1; i < argc; i++) {
+        param_ok = false;
+        if (0 == strncasecmp(interval_str, argv[i], strlen(interval_str))) {
+            // interval of the lines in ms
+            param_ok = (1 == sscanf(argv[i] + strlen(interval_str), "%d", &interval_ms)) && (interval_ms > 0);
+        }
+        if (0 == strncasecmp(count_str, argv[i], strlen(count_str))) {
+            // number of lines
+            param_ok = (1 == sscanf(argv[i] + strlen(count_str), "%d", &count)) && (count > 0);
+        }
+        if (!param_ok) print_usage_info_and_exit("Undefined parameter.\n", programName); // undefined parameter found
+    }
+}
+
+void take_snapshot(struct snapshot *snap) {
+    struct timespec now;
+    const struct livestats_server *s = &ls->server;
+
+    memset(snap, 0, sizeof(*snap));
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    snap->time_s = now.tv_sec + now.tv_nsec / 1e9;
+    snap->faults = __atomic_load_n(&s->faults, __ATOMIC_RELAXED);
+    snap->writebacks = __atomic_load_n(&s->writebacks, __ATOMIC_RELAXED);
+    snap->bytes_read = __atomic_load_n(&s->bytes_read, __ATOMIC_RELAXED);
+    snap->bytes_written = __atomic_load_n(&s->bytes_written, __ATOMIC_RELAXED);
+    for (int i = 0; i < PAGEREP_NALGOS; i++) {
+        snap->selections += __atomic_load_n(&s->selections[i], __ATOMIC_RELAXED);
+        snap->scanned += __atomic_load_n(&s->scanned[i], __ATOMIC_RELAXED);
+    }
+    snap->resident_frames = __atomic_load_n(&s->resident_frames, __ATOMIC_RELAXED);
+    snap->dirty_frames = __atomic_load_n(&s->dirty_frames, __ATOMIC_RELAXED);
+    for (int i = 0; i < VMEM_MAX_CLIENTS; i++) {
+        const struct livestats_client *c = &ls->clients[i];
+        snap->ticks += __atomic_load_n(&c->ticks, __ATOMIC_RELAXED);
+        snap->ipc_round_trips += __atomic_load_n(&c->ipc_round_trips, __ATOMIC_RELAXED);
+        snap->ipc_wait_ns += __atomic_load_n(&c->ipc_wait_ns, __ATOMIC_RELAXED);
+    }
+}
+
+void print_rates(const struct snapshot *prev, const struct snapshot *cur) {
+    double dt = cur->time_s - prev->time_s;
+    long ipc = cur->ipc_round_trips - prev->ipc_round_trips;
+    long selections = cur->selections - prev->selections;
+
+    printf("%10.0f %10.0f %8.0f %10.1f %10.1f %9.0f %8.1f %6.1f %8d %8d\n",
+           (cur->faults - prev->faults) / dt,
+           (cur->ticks - prev->ticks) / dt,
+           (cur->writebacks - prev->writebacks) / dt,
+           (cur->bytes_read - prev->bytes_read) / dt / 1024.0,
+           (cur->bytes_written - prev->bytes_written) / dt / 1024.0,
+           ipc / dt,
+           ipc ? (cur->ipc_wait_ns - prev->ipc_wait_ns) / 1e3 / ipc : 0.0,
+           selections ? (double) (cur->scanned - prev->scanned) / selections : 0.0,
+           cur->resident_frames, cur->dirty_frames);
+}
+
+void print_usage_info_and_exit(char *err_str, char *programName) {
+    fprintf(stderr, "Wrong parameter: %s\n", err_str);
+    fprintf(stderr, "Usage : %s [OPTIONS]\n", programName);
+    fprintf(stderr, " -interval=<ms> : Interval of the lines (default 1000).\n");
+    fprintf(stderr, " -count=<n>     : Number of lines (default: until mmanage terminates).\n");
+    fprintf(stderr, "Columns: page faults, accesses (ticks of g_count), writebacks and pagefile\n");
+    fprintf(stderr, "transfers per second, requests to mmanage per second and their average round\n");
+    fprintf(stderr, "trip time, average frames inspected per victim selection, resident and dirty frames.\n");
+    exit(EXIT_FAILURE);
+}
+
+// EOF
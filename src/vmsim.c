@@ -0,0 +1,664 @@
+/**
+ * @file vmsim.c
+ * @date Oct 2026
+ *
+ * @brief Trace driven simulator of TI BSP A3 virtual memory
+ *
+ * vmsim replays an access trace recorded by vmappl -trace=<file> for a matrix
+ * of page replacement algorithms, page sizes and sizes of physical memory.
+ * The configurations are simulated without shared memory and IPC, but by the
+ * page replacement algorithms of mmanage (module pagerep) and its cost model.
+ * Time advances as in vmaccess, hence a configuration of the recording run
+ * produces the logfile of mmanage.
+ *
+ * The configurations are independent. They are distributed over worker
+ * threads, each thread decodes the mapped trace itself. The results are
+ * printed in the format of the summary of run_all.sh.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "error.h"
+#include "vmem.h"
+#include "trace.h"
+#include "pagerep.h"
+#include "pagefile.h"
+#include "logger.h"
+
+#define VMSIM_MAX_LIST 16   //!< maximal number of values of a list option
+
+/**
+ * Configuration of a simulation run and its state
+ */
+struct sim {
+    int algo;                   //!< page replacement algorithm
+    int pagesize;               //!< page size, a power of two
+    int page_shift;             //!< log2 of pagesize
+    int physmemsize;            //!< size of physical memory, a multiple of pagesize
+    int nframes;                //!< number of frames
+    long npages;                //!< number of pages of the address space
+    int ***page_frame;          //!< frame of each page, a radix tree, see page_slot
+    long *frame_page;           //!< page of each frame; VOID_IDX: frame is unused
+    unsigned char *access_bits; //!< PTF_REF and PTF_DIRTY of each frame
+    unsigned char *age;         //!< age counter of each frame
+    int nused;                  //!< frames used; frames are taken in ascending order
+    struct pagerep rep;         //!< page replacement
+    struct pagefile_cost cost;  //!< cost model of the modeled pagefile
+    long g_count;               //!< number of accesses replayed
+    long last_g_count;          //!< g_count of the last message mmanage would have received
+    long fault_g_count;         //!< g_count of the last page fault
+    long pf_count;              //!< number of page faults
+    long writebacks;            //!< number of dirty pages written back
+    double fault_time_ns;       //!< modeled time of all page faults
+    FILE *log;                  //!< logfile; NULL: no logfile
+};
+
+/*
+ * Signatures of private / static functions
+ */
+
+/**
+ *****************************************************************************************
+ *  @brief      This function scans all parameters of the program.
+ *              The corresponding global variables will be set.
+ *
+ *  @param      argc number of parameters
+ *  @param      argv parameters
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void scan_params(int argc, char **argv);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function parses a comma separated list of sizes with optional
+ *              suffix K, M or G, see vmem_parse_size.
+ *
+ *  @param      str string to be parsed
+ *  @param      values parsed numbers
+ *
+ *  @return     number of values; 0, if str is not a valid list
+ ****************************************************************************************/
+static int parse_list(const char *str, int *values);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function parses a comma separated list of page replacement
+ *              algorithms, e.g. fifo,aging.
+ *
+ *  @param      str string to be parsed
+ *
+ *  @return     false, if str is not a valid list
+ ****************************************************************************************/
+static bool parse_algos(const char *str);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function maps the trace read-only and checks its header.
+ *
+ *  @param      file Name of the trace
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void map_trace(const char *file);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function creates the configurations: each algorithm for each
+ *              page size and each size of physical memory.
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void init_sims(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function is the main function of a worker thread. It simulates
+ *              configurations until each configuration has been taken by a worker.
+ *
+ *  @param      arg not used
+ *
+ *  @return     NULL
+ ****************************************************************************************/
+static void *worker(void *arg);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function replays the trace for a configuration.
+ *
+ *  @param      s Configuration
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void simulate(struct sim *s);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the frame of a page in the map of a configuration.
+ *              Like the page table, the map is a radix tree with PT_LEVEL_BITS index
+ *              bits per level. Mid and leaf nodes are allocated on the first fault of
+ *              one of their pages, so the map uses memory in proportion to the pages
+ *              touched by the trace, not to the address space.
+ *
+ *  @param      s Configuration
+ *  @param      page Page
+ *  @param      create true: allocate the nodes on the path to the page, if required
+ *
+ *  @return     frame of page, VOID_IDX: page is not present; NULL, if create is false
+ *              and no leaf node has been allocated for the page
+ ****************************************************************************************/
+static int *page_slot(struct sim *s, long page, bool create);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function replays consecutive accesses to one page like
+ *              vmem_put_page_into_mem: A missing page is fetched first. The Ref bit
+ *              is set for each time window the accesses fall into.
+ *
+ *  @param      s Configuration
+ *  @param      page Page accessed
+ *  @param      naccess Number of accesses
+ *  @param      write Accesses store data
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void access_page(struct sim *s, long page, long naccess, bool write);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function advances g_count. Each multiple of VMEM_TIME_WINDOW
+ *              reached ends a time interval of page replacement.
+ *
+ *  @param      s Configuration
+ *  @param      ticks Number of accesses
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void advance_gcount(struct sim *s, long ticks);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function handles a page fault like allocate_page of mmanage.
+ *              A dirty page that is replaced will be written back to the modeled
+ *              pagefile.
+ *
+ *  @param      s Configuration
+ *  @param      page Page that will be fetched
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void page_fault(struct sim *s, long page);
+
+/**
+ *****************************************************************************************
+ *  @brief      Callbacks of the page replacement. Each frame in use stores a page
+ *              that may be replaced, there are neither pinned nor shared pages.
+ *
+ *  @param      pr Page replacement of a configuration
+ *  @param      frame Frame
+ *
+ *  @return     see struct pagerep_ops
+ ****************************************************************************************/
+static bool sim_holds_page(const struct pagerep *pr, int frame);
+static bool sim_test_clear_ref(const struct pagerep *pr, int frame);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function prints the result of each configuration: ordered by
+ *              page size, algorithm and size of physical memory.
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void print_results(void);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function prints an error message and the usage information of
+ *              this program.
+ *
+ *  @param      err_str pointer to the error string that should be printed.
+ *  @param      programName pointer to the name of the program
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void print_usage_info_and_exit(char *err_str, char *programName);
+
+/*
+ * variables of the simulator
+ */
+
+static const unsigned char *trace = NULL;   //!< mapped trace
+static size_t trace_size = 0;               //!< size of the trace in bytes
+static const struct trace_header *hdr = NULL; //!< header of the mapped trace
+static const char *trace_file = NULL;       //!< name of the trace
+
+static int algos[PAGEREP_NALGOS] = { PAGEREP_FIFO, PAGEREP_CLOCK, PAGEREP_AGING }; //!< algorithms set via -algos
+static int nalgos = PAGEREP_NALGOS;
+static int pagesizes[VMSIM_MAX_LIST] = { 8, 16, 32, 64 }; //!< page sizes set via -pagesizes
+static int npagesizes = 4;
+static int physmemsizes[VMSIM_MAX_LIST];     //!< sizes of physical memory set via -physmem
+static int nphysmemsizes = 0;                //!< 0: size of the recording run
+
+static double mem_ns = 100.0;                //!< modeled latency of a memory access hitting main memory
+static double fault_ns = 2000.0;             //!< modeled trap overhead of a page fault
+static int nthreads = 0;                     //!< number of worker threads; 0: one per CPU
+static const char *logdir = NULL;            //!< directory of the logfiles; NULL: no logfiles
+static const char *workload = NULL;          //!< search_algo of the results; NULL: workload of the trace
+
+static struct sim *sims = NULL;              //!< configurations
+static int nsims = 0;                        //!< number of configurations
+static int next_sim = 0;                     //!< next configuration to be taken by a worker
+
+static const struct pagerep_ops sim_ops = { sim_holds_page, sim_holds_page, sim_test_clear_ref };
+
+int main(int argc, char **argv) {
+    scan_params(argc, argv);
+    map_trace(trace_file);
+    if (workload == NULL) {
+        workload = hdr->workload;
+    }
+    init_sims();
+
+    if (nthreads <= 0) {
+        nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (nthreads > nsims) {
+        nthreads = nsims;
+    }
+    pthread_t threads[nthreads];
+    for (int i = 0; i < nthreads; i++) {
+        TEST_AND_EXIT(pthread_create(&threads[i], NULL, worker, NULL) != 0, (stderr, "pthread_create failed\n"));
+    }
+    for (int i = 0; i < nthreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    print_results();
+    return 0;
+}
+
+void scan_params(int argc, char **argv) {
+    bool param_ok = false;
+    char *programName = argv[0];
+    const char *algos_str = "-algos=";
+    const char *pagesizes_str = "-pagesizes=";
+    const char *physmem_str = "-physmem=";
+    const char *storage_str = "-storage=";
+    const char *memns_str = "-memns=";
+    const char *faultns_str = "-faultns=";
+    const char *threads_str = "-threads=";
+    const char *logdir_str = "-logdir=";
+    const char *name_str = "-name=";
+
+    // scan all parameters (argv[0] points to program name)
+    for (int i = 1; i < argc; i++) {
+        param_ok = false;
+        if (0 == strncasecmp(algos_str, argv[i], strlen(algos_str))) {
+            // page replacement algorithms
+            param_ok = parse_algos(argv[i] + strlen(algos_str));
+        }
+        if (0 == strncasecmp(pagesizes_str, argv[i], strlen(pagesizes_str))) {
+            // page sizes, checked by init_sims
+            npagesizes = parse_list(argv[i] + strlen(pagesizes_str), pagesizes);
+            param_ok = npagesizes > 0;
+        }
+        if (0 == strncasecmp(physmem_str, argv[i], strlen(physmem_str))) {
+            // sizes of physical memory, checked by init_sims
+            nphysmemsizes = parse_list(argv[i] + strlen(physmem_str), physmemsizes);
+            param_ok = nphysmemsizes > 0;
+        }
+        if (0 == strncasecmp(storage_str, argv[i], strlen(storage_str))) {
+            // storage device of cost model
+            param_ok = set_pagefile_storage(argv[i] + strlen(storage_str));
+        }
+        if (0 == strncasecmp(memns_str, argv[i], strlen(memns_str))) {
+            // memory latency of cost model
+            param_ok = (1 == sscanf(argv[i] + strlen(memns_str), "%lf", &mem_ns)) && (mem_ns >= 0.0);
+        }
+        if (0 == strncasecmp(faultns_str, argv[i], strlen(faultns_str))) {
+            // trap overhead of cost model
+            param_ok = (1 == sscanf(argv[i] + strlen(faultns_str), "%lf", &fault_ns)) && (fault_ns >= 0.0);
+        }
+        if (0 == strncasecmp(threads_str, argv[i], strlen(threads_str))) {
+            // number of worker threads
+            param_ok = (1 == sscanf(argv[i] + strlen(threads_str), "%d", &nthreads)) && (nthreads > 0);
+        }
+        if (0 == strncasecmp(logdir_str, argv[i], strlen(logdir_str))) {
+            // logfile of each configuration
+            logdir = argv[i] + strlen(logdir_str);
+            param_ok = *logdir != '\0';
+        }
+        if (0 == strncasecmp(name_str, argv[i], strlen(name_str))) {
+            // search_algo of the results
+            workload = argv[i] + strlen(name_str);
+            param_ok = *workload != '\0';
+        }
+        if ((argv[i][0] != '-') && (trace_file == NULL)) {
+            trace_file = argv[i];
+            param_ok = true;
+        }
+        if (!param_ok) print_usage_info_and_exit("Undefined parameter.\n", programName); // undefined parameter found
+    }
+    if (trace_file == NULL) {
+        print_usage_info_and_exit("Trace missing.\n", programName);
+    }
+}
+
+int parse_list(const char *str, int *values) {
+    char list[256];
+    char *save = NULL;
+    int n = 0;
+    if (strlen(str) >= sizeof(list)) {
+        return 0;
+    }
+    strcpy(list, str);
+    for (char *item = strtok_r(list, ",", &save); item != NULL; item = strtok_r(NULL, ",", &save)) {
+        long size = 0;
+        if ((n == VMSIM_MAX_LIST) || !vmem_parse_size(item, &size) || (size > INT_MAX)) {
+            return 0;
+        }
+        values[n++] = size;
+    }
+    return n;
+}
+
+bool parse_algos(const char *str) {
+    char list[64];
+    char *save = NULL;
+    if (strlen(str) >= sizeof(list)) {
+        return false;
+    }
+    strcpy(list, str);
+    nalgos = 0;
+    for (char *name = strtok_r(list, ",", &save); name != NULL; name = strtok_r(NULL, ",", &save)) {
+        int algo = pagerep_algo_of(name);
+        if ((algo < 0) || (nalgos == PAGEREP_NALGOS)) {
+            return false;
+        }
+        algos[nalgos++] = algo;
+    }
+    return nalgos > 0;
+}
+
+void map_trace(const char *file) {
+    struct stat st;
+    int fd = open(file, O_RDONLY);
+    TEST_AND_EXIT_ERRNO(fd == -1, "Error opening trace");
+    TEST_AND_EXIT_ERRNO(fstat(fd, &st) == -1, "Error reading trace");
+    TEST_AND_EXIT(st.st_size < (off_t) sizeof(struct trace_header), (stderr, "%s: not a trace\n", file));
+    trace_size = st.st_size;
+    trace = mmap(NULL, trace_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    TEST_AND_EXIT_ERRNO(trace == MAP_FAILED, "Error mapping trace");
+    close(fd);
+    madvise((void *) trace, trace_size, MADV_SEQUENTIAL);
+
+    hdr = (const struct trace_header *) trace;
+    TEST_AND_EXIT(!trace_check_header(hdr), (stderr, "%s: not a trace of version %d\n", file, TRACE_VERSION));
+    TEST_AND_EXIT(hdr->nclients != 1, (stderr, "%s: traces of several address spaces are not supported\n", file));
+    TEST_AND_EXIT(hdr->virtmemsize <= 0, (stderr, "%s: invalid size of virtual memory\n", file));
+}
+
+void init_sims(void) {
+    if (nphysmemsizes == 0) {
+        physmemsizes[0] = hdr->physmemsize;
+        nphysmemsizes = 1;
+    }
+    nsims = npagesizes * nalgos * nphysmemsizes;
+    sims = calloc(nsims, sizeof(struct sim));
+    TEST_AND_EXIT_ERRNO(!sims, "Error allocating configurations");
+
+    struct sim *s = sims;
+    for (int p = 0; p < npagesizes; p++) {
+        int pagesize = pagesizes[p];
+        if (pagesize & (pagesize - 1)) {
+            print_usage_info_and_exit("Page size is not a power of two.\n", "vmsim");
+        }
+        for (int a = 0; a < nalgos; a++) {
+            for (int m = 0; m < nphysmemsizes; m++, s++) {
+                if (physmemsizes[m] % pagesize) {
+                    print_usage_info_and_exit("Size of physical memory is not a multiple of the page size.\n", "vmsim");
+                }
+                s->algo = algos[a];
+                s->pagesize = pagesize;
+                s->page_shift = __builtin_ctz(pagesize);
+                s->physmemsize = physmemsizes[m];
+                s->nframes = physmemsizes[m] / pagesize;
+                s->npages = (hdr->virtmemsize + pagesize - 1) / pagesize;
+                s->cost.next_offset = -1;
+            }
+        }
+    }
+}
+
+void *worker(void *arg) {
+    int i;
+    while ((i = __atomic_fetch_add(&next_sim, 1, __ATOMIC_RELAXED)) < nsims) {
+        simulate(&sims[i]);
+    }
+    return NULL;
+}
+
+void simulate(struct sim *s) {
+    long nroots = (s->npages >> (2 * PT_LEVEL_BITS)) + 1;
+    s->page_frame = calloc(nroots, sizeof(int **));
+    s->frame_page = malloc(s->nframes * sizeof(long));
+    s->access_bits = calloc(s->nframes, 1);
+    s->age = calloc(s->nframes, 1);
+    TEST_AND_EXIT_ERRNO(!s->page_frame || !s->frame_page || !s->access_bits || !s->age, "Error allocating configuration");
+    for (int i = 0; i < s->nframes; i++) {
+        s->frame_page[i] = VOID_IDX;
+    }
+    pagerep_init(&s->rep, s->algo, 0, s->nframes, s->age, &sim_ops, s);
+
+    if (logdir != NULL) {
+        char name[PATH_MAX];
+        if (nphysmemsizes > 1) {
+            snprintf(name, sizeof(name), "%s/logfile_%d_%s_%s_%d_%d.txt", logdir, hdr->seed, workload,
+                     pagerep_name(s->algo), s->pagesize, s->physmemsize);
+        } else {
+            snprintf(name, sizeof(name), "%s/logfile_%d_%s_%s_%d.txt", logdir, hdr->seed, workload,
+                     pagerep_name(s->algo), s->pagesize);
+        }
+        s->log = fopen(name, "w");
+        TEST_AND_EXIT_ERRNO(!s->log, "Error creating logfile");
+    }
+
+    // each worker decodes the trace itself
+    const unsigned char *pos = trace + sizeof(struct trace_header);
+    const unsigned char *end = trace + trace_size;
+    long next = 0;
+    while (pos < end) {
+        struct trace_event ev;
+        size_t n = trace_decode(pos, end - pos, &ev, &next);
+        TEST_AND_EXIT(n == 0, (stderr, "%s: trace truncated\n", trace_file));
+        pos += n;
+        TEST_AND_EXIT((ev.address < 0) || (ev.len <= 0) || (ev.address + ev.len > hdr->virtmemsize),
+                      (stderr, "%s: access out of bounds\n", trace_file));
+
+        bool write = ev.kind & TRACE_WRITE;
+        long first = ev.address >> s->page_shift;
+        long last = (ev.address + ev.len - 1) >> s->page_shift;
+        if (!(ev.kind & TRACE_RUN)) {
+            // a value takes one access for each page it occupies
+            for (long page = first; page <= last; page++) {
+                access_page(s, page, 1, write);
+            }
+            continue;
+        }
+        long address = ev.address;
+        long len = ev.len;
+        while (len > 0) {
+            long chunk = s->pagesize - (address & (s->pagesize - 1));
+            if (chunk > len) {
+                chunk = len;
+            }
+            access_page(s, address >> s->page_shift, chunk, write);
+            address += chunk;
+            len -= chunk;
+        }
+    }
+
+    if (s->log != NULL) {
+        fclose(s->log);
+    }
+    for (long r = 0; r < nroots; r++) {
+        for (int m = 0; (s->page_frame[r] != NULL) && (m < PT_NODE_ENTRIES); m++) {
+            free(s->page_frame[r][m]);
+        }
+        free(s->page_frame[r]);
+    }
+    free(s->page_frame);
+    free(s->frame_page);
+    free(s->access_bits);
+    free(s->age);
+}
+
+int *page_slot(struct sim *s, long page, bool create) {
+    int ***mid = &s->page_frame[page >> (2 * PT_LEVEL_BITS)];
+    if (*mid == NULL) {
+        if (!create) {
+            return NULL;
+        }
+        *mid = calloc(PT_NODE_ENTRIES, sizeof(int *));
+        TEST_AND_EXIT_ERRNO(!*mid, "Error allocating page map");
+    }
+    int **leaf = &(*mid)[(page >> PT_LEVEL_BITS) & (PT_NODE_ENTRIES - 1)];
+    if (*leaf == NULL) {
+        if (!create) {
+            return NULL;
+        }
+        *leaf = malloc(PT_NODE_ENTRIES * sizeof(int));
+        TEST_AND_EXIT_ERRNO(!*leaf, "Error allocating page map");
+        for (int i = 0; i < PT_NODE_ENTRIES; i++) {
+            (*leaf)[i] = VOID_IDX;
+        }
+    }
+    return &(*leaf)[page & (PT_NODE_ENTRIES - 1)];
+}
+
+void access_page(struct sim *s, long page, long naccess, bool write) {
+    int *slot = page_slot(s, page, true);
+    if (*slot == VOID_IDX) {
+        page_fault(s, page);
+    }
+    int frame = *slot;
+    while (naccess > 0) {
+        // ticks up to and including the next time window
+        long ticks = VMEM_TIME_WINDOW - s->g_count % VMEM_TIME_WINDOW;
+        if (ticks > naccess) {
+            ticks = naccess;
+        }
+        s->access_bits[frame] |= PTF_REF;
+        advance_gcount(s, ticks);
+        naccess -= ticks;
+    }
+    if (write) {
+        // a trace holds no data, hence silent stores dirty the page as well
+        s->access_bits[frame] |= PTF_DIRTY;
+    }
+}
+
+void advance_gcount(struct sim *s, long ticks) {
+    long now = s->g_count += ticks;
+    for (long w = ((now - ticks) / VMEM_TIME_WINDOW + 1) * VMEM_TIME_WINDOW; w <= now; w += VMEM_TIME_WINDOW) {
+        s->last_g_count = w;
+        pagerep_interval(&s->rep);
+    }
+}
+
+void page_fault(struct sim *s, long page) {
+    const struct storage_cost *dev = get_pagefile_storage();
+    double io_time_ns = s->cost.stats.io_time_ns;
+    long removed_page = VOID_IDX;
+    int frame = VOID_IDX;
+
+    s->pf_count++;
+    if (s->nused < s->nframes) {
+        frame = s->nused++;
+    } else {
+        frame = pagerep_select(&s->rep);
+        removed_page = s->frame_page[frame];
+        if (s->access_bits[frame] & PTF_DIRTY) {
+            account_pagefile_io(&s->cost, dev, removed_page * s->pagesize, s->pagesize, true);
+            s->writebacks++;
+        }
+        *page_slot(s, removed_page, false) = VOID_IDX;
+        s->access_bits[frame] = 0;
+    }
+    account_pagefile_io(&s->cost, dev, page * s->pagesize, s->pagesize, false);
+    s->age[frame] = PAGEREP_AGE_FETCHED;
+    s->frame_page[frame] = page;
+    *page_slot(s, page, true) = frame;
+
+    // the request of vmaccess carries the g_count before the access
+    s->last_g_count = s->g_count;
+    s->fault_g_count = s->g_count;
+    s->fault_time_ns += fault_ns + s->cost.stats.io_time_ns - io_time_ns;
+
+    if (s->log != NULL) {
+        struct logevent le;
+        le.req_pageno = page;
+        le.replaced_page = removed_page;
+        le.alloc_frame = frame;
+        le.pf_count = s->pf_count;
+        le.g_count = s->g_count;
+        logger_write(s->log, le);
+    }
+}
+
+bool sim_holds_page(const struct pagerep *pr, int frame) {
+    const struct sim *s = pr->owner;
+    return s->frame_page[frame] != VOID_IDX;
+}
+
+bool sim_test_clear_ref(const struct pagerep *pr, int frame) {
+    const struct sim *s = pr->owner;
+    if (!(s->access_bits[frame] & PTF_REF)) {
+        return false;
+    }
+    s->access_bits[frame] &= ~PTF_REF;
+    return true;
+}
+
+void print_results(void) {
+    for (int i = 0; i < nsims; i++) {
+        const struct sim *s = &sims[i];
+        // every access hits main memory, faulting accesses after the page has been fetched
+        double runtime_ns = s->last_g_count * mem_ns + s->fault_time_ns;
+        printf("seed = %6i page_rep_algo = %7s search_algo = %12s pagesize = %4i pagefaults %7ld global_count %7ld "
+               "eat_ns %10.2f runtime_ms %12.3f",
+               hdr->seed, pagerep_name(s->algo), workload, s->pagesize, s->pf_count, s->fault_g_count,
+               s->last_g_count ? runtime_ns / s->last_g_count : 0.0, runtime_ns / 1e6);
+        if (nphysmemsizes > 1) {
+            printf(" physmem %8d writebacks %7ld", s->physmemsize, s->writebacks);
+        }
+        printf("\n");
+    }
+}
+
+void print_usage_info_and_exit(char *err_str, char *programName) {
+    fprintf(stderr, "Wrong parameter: %s\n", err_str);
+    fprintf(stderr, "Usage : %s [OPTIONS] <trace>\n", programName);
+    fprintf(stderr, " <trace>                 : Trace recorded by vmappl -trace=<file>.\n");
+    fprintf(stderr, " -algos=<algo>,...       : Page replacement algorithms: fifo, clock, aging (default all).\n");
+    fprintf(stderr, " -pagesizes=<bytes>,...  : Page sizes, powers of two, suffix K (default 8,16,32,64).\n");
+    fprintf(stderr, " -physmem=<bytes>,...    : Sizes of physical memory, multiples of each page size, suffix K, M or G (default size of the recording run).\n");
+    fprintf(stderr, " -storage=<device>       : Storage device of cost model: hdd, ssd or nvme (default ssd).\n");
+    fprintf(stderr, " -memns=<ns>             : Latency of a memory access of cost model (default 100).\n");
+    fprintf(stderr, " -faultns=<ns>           : Trap overhead of a page fault of cost model (default 2000).\n");
+    fprintf(stderr, " -threads=<n>            : Number of worker threads (default one per CPU).\n");
+    fprintf(stderr, " -logdir=<dir>           : Write the logfile of each configuration into dir.\n");
+    fprintf(stderr, " -name=<name>            : search_algo of the results (default workload of the trace).\n");
+    exit(EXIT_FAILURE);
+}
+
+// EOF
@@ -0,0 +1,487 @@
+/**
+ * @file workload.c
+ * @date Oct 2026
+ * @brief This is the implementation of the benchmark workloads of vmappl.
+ * The data of each workload is stored in virtual memory starting at address 0,
+ * local memory holds at most bookkeeping like random permutations.
+ * Random numbers are taken from my_rand, so a run is reproducible for a seed.
+ */
+
+#include <string.h>
+#include <strings.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "error.h"
+#include "my_rand.h"
+#include "trace.h"
+#include "vmaccess.h"
+#include "vmem.h"
+#include "workload.h"
+
+#define REPLAY_RUN_BUFSIZE 4096 //!< runs of a replayed trace are accessed in chunks of this size
+
+/**
+ * Description of a workload
+ */
+struct workload {
+    const char *name;                              //!< name used on command line
+    void (*run)(const struct workload_params *);   //!< the workload
+    int size;                                      //!< default size
+    int ops;                                       //!< default number of operations
+    int elem_size;                                 //!< bytes of virtual memory per size unit
+    const char *description;                       //!< printed by workload_print_list
+};
+
+static long accesses = 0;       //!< virtual memory accesses of current run
+static uint32_t checksum = 0;   //!< checksum of current run
+
+/*
+ * Access functions counting the accesses
+ */
+
+static unsigned char rd8(int addr) {
+    accesses++;
+    return vmem_read(addr);
+}
+
+static void wr8(int addr, unsigned char val) {
+    accesses++;
+    vmem_write(addr, val);
+}
+
+static uint16_t rd16(int addr) {
+    accesses++;
+    return vmem_read_u16(addr);
+}
+
+static void wr16(int addr, uint16_t val) {
+    accesses++;
+    vmem_write_u16(addr, val);
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function adds a value to the checksum (FNV-1a over 32 bit values).
+ *
+ *  @param      val value
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void add_checksum(uint32_t val) {
+    checksum = (checksum ^ val) * 16777619u;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns a random number in [0, n). The low order bits of
+ *              my_rand are weak, hence they are dropped.
+ *
+ *  @param      n upper bound
+ *
+ *  @return     random number
+ ****************************************************************************************/
+static int rand_below(int n) {
+    return (my_rand() >> 8) % n;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function fills an array with a random permutation of 0 .. n - 1.
+ *
+ *  @param      perm array of n elements
+ *  @param      n number of elements
+ *  @param      cycle true: the permutation forms a single cycle (Sattolo's algorithm)
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void random_permutation(int *perm, int n, bool cycle) {
+    for (int i = 0; i < n; i++) {
+        perm[i] = i;
+    }
+    for (int i = n - 1; i > 0; i--) {
+        int j = cycle ? rand_below(i) : rand_below(i + 1);
+        int tmp = perm[i];
+        perm[i] = perm[j];
+        perm[j] = tmp;
+    }
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function fills the matrices A and B of size n x n with random bytes.
+ *              The matrices are stored row by row: A at 0, B at n * n, C at 2 * n * n.
+ *
+ *  @param      n dimension
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void matrix_init(int n) {
+    for (int i = 0; i < 2 * n * n; i++) {
+        wr8(i, rand_below(256));
+    }
+}
+
+static void matrix_checksum(int n) {
+    for (int i = 0; i < n * n; i++) {
+        add_checksum(rd8(2 * n * n + i));
+    }
+}
+
+/**
+ * C = A * B modulo 256, element by element. B is read column wise.
+ */
+static void run_matmul(const struct workload_params *p) {
+    int n = p->size;
+    matrix_init(n);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            unsigned char sum = 0;
+            for (int k = 0; k < n; k++) {
+                sum += rd8(i * n + k) * rd8(n * n + k * n + j);
+            }
+            wr8(2 * n * n + i * n + j, sum);
+        }
+    }
+    matrix_checksum(n);
+}
+
+/**
+ * C = A * B modulo 256 with tiles. Three tiles fit into main memory.
+ */
+static void run_matmul_blocked(const struct workload_params *p) {
+    int n = p->size;
+    int bs = (VMEM_NFRAMES / 3 > 1) ? VMEM_NFRAMES / 3 : 1;
+    if (bs > n) {
+        bs = n;
+    }
+    matrix_init(n);
+    for (int i = 0; i < n * n; i++) {
+        wr8(2 * n * n + i, 0);
+    }
+    for (int ii = 0; ii < n; ii += bs) {
+        for (int kk = 0; kk < n; kk += bs) {
+            for (int jj = 0; jj < n; jj += bs) {
+                for (int i = ii; (i < ii + bs) && (i < n); i++) {
+                    for (int k = kk; (k < kk + bs) && (k < n); k++) {
+                        unsigned char a = rd8(i * n + k);
+                        for (int j = jj; (j < jj + bs) && (j < n); j++) {
+                            int c = 2 * n * n + i * n + j;
+                            wr8(c, rd8(c) + a * rd8(n * n + k * n + j));
+                        }
+                    }
+                }
+            }
+        }
+    }
+    matrix_checksum(n);
+}
+
+/**
+ * Binary search of random keys in a sorted array of 16 bit values.
+ */
+static void run_bsearch(const struct workload_params *p) {
+    int n = p->size;
+    int val = 0;
+    for (int i = 0; i < n; i++) {
+        val += 1 + rand_below(4);
+        wr16(2 * i, val);
+    }
+    // pin the pages of the midpoints of the upper levels of the implicit search tree
+    for (int level = 0; level < p->pin_levels; level++) {
+        int nodes = 1 << level;
+        for (int node = 0; node < nodes; node++) {
+            int l = 0;
+            int r = n - 1;
+            for (int d = level - 1; (d >= 0) && (l <= r); d--) {
+                int m = (l + r) / 2;
+                if (node & (1 << d)) l = m + 1; else r = m - 1;
+            }
+            if (l <= r) {
+                vmem_pin(2 * ((l + r) / 2), 2);
+            }
+        }
+    }
+    for (int op = 0; op < p->ops; op++) {
+        int key = rand_below(val + 1);
+        int l = 0;
+        int r = n - 1;
+        int found = -1;
+        while (l <= r) {
+            int m = (l + r) / 2;
+            int v = rd16(2 * m);
+            if (v == key) {
+                found = m;
+                break;
+            } else if (v < key) {
+                l = m + 1;
+            } else {
+                r = m - 1;
+            }
+        }
+        add_checksum(found);
+    }
+}
+
+static int hash_slot(int key, int n) {
+    return (int) (((uint32_t) key * 2654435761u) % (uint32_t) n);
+}
+
+/**
+ * Hash table of 16 bit keys with linear probing. The table is filled to 3/4,
+ * half of the lookups hit.
+ */
+static void run_hash(const struct workload_params *p) {
+    int n = p->size;
+    int nkeys = n * 3 / 4;
+    int keys[nkeys];
+
+    for (int i = 0; i < n; i++) {
+        wr16(2 * i, 0); // 0: empty slot
+    }
+    for (int i = 0; i < nkeys; i++) {
+        keys[i] = 1 + rand_below(0xFFFF);
+        int s = hash_slot(keys[i], n);
+        while (true) {
+            int v = rd16(2 * s);
+            if ((v == 0) || (v == keys[i])) {
+                break;
+            }
+            s = (s + 1) % n;
+        }
+        wr16(2 * s, keys[i]);
+    }
+    for (int op = 0; op < p->ops; op++) {
+        int key = (op % 2) ? keys[rand_below(nkeys)] : 1 + rand_below(0xFFFF);
+        int s = hash_slot(key, n);
+        int probes = 1;
+        int v = 0;
+        while (((v = rd16(2 * s)) != 0) && (v != key)) {
+            s = (s + 1) % n;
+            probes++;
+        }
+        add_checksum((v == key) ? s : -probes);
+    }
+}
+
+/**
+ * Random access with Zipf distributed popularity (exponent 1). The popular bytes
+ * are spread over the region by a random permutation. Every fourth access writes.
+ */
+static void run_zipf(const struct workload_params *p) {
+    int n = p->size;
+    int perm[n];
+    double cdf[n];
+    double sum = 0.0;
+
+    random_permutation(perm, n, false);
+    for (int i = 0; i < n; i++) {
+        sum += 1.0 / (i + 1);
+        cdf[i] = sum;
+    }
+    for (int i = 0; i < n; i++) {
+        wr8(i, i);
+    }
+    for (int op = 0; op < p->ops; op++) {
+        double u = (double) rand_below(1 << 22) / (1 << 22) * sum;
+        int l = 0;
+        int r = n - 1;
+        while (l < r) {
+            int m = (l + r) / 2;
+            if (cdf[m] < u) l = m + 1; else r = m;
+        }
+        int addr = perm[l];
+        unsigned char v = rd8(addr);
+        add_checksum(v);
+        if (op % 4 == 3) {
+            wr8(addr, v + 1);
+        }
+    }
+}
+
+/**
+ * Strided scan: the region is read with a fixed stride; each pass starts one byte
+ * after the start of the previous pass.
+ */
+static void run_stride(const struct workload_params *p) {
+    int n = p->size;
+    int stride = (p->stride > 0) ? p->stride : VMEM_GEO_PAGESIZE + 1;
+    int off = 0;
+    int pos = 0;
+
+    for (int i = 0; i < n; i++) {
+        wr8(i, rand_below(256));
+    }
+    for (int op = 0; op < p->ops; op++) {
+        add_checksum(rd8(pos));
+        pos += stride;
+        if (pos >= n) {
+            off = (off + 1) % stride;
+            pos = off % n;
+        }
+    }
+}
+
+/**
+ * Pointer chasing: nodes of 4 bytes (next index, value) form one random cycle.
+ */
+static void run_chase(const struct workload_params *p) {
+    int n = p->size;
+    int perm[n];
+    int node = 0;
+
+    random_permutation(perm, n, true);
+    for (int i = 0; i < n; i++) {
+        wr16(4 * i, perm[i]);
+        wr16(4 * i + 2, rand_below(0x10000));
+    }
+    for (int op = 0; op < p->ops; op++) {
+        add_checksum(rd16(4 * node + 2));
+        node = rd16(4 * node);
+    }
+}
+
+static const struct workload workloads[] = {
+    { "matmul",         run_matmul,         16,     0,     3, "naive matrix multiply of size x size byte matrices" },
+    { "matmul_blocked", run_matmul_blocked, 16,     0,     3, "tiled matrix multiply of size x size byte matrices" },
+    { "bsearch",        run_bsearch,        256,    2000,  2, "binary search in a sorted array of size 16 bit values" },
+    { "hash",           run_hash,           256,    2000,  2, "linear probing in a hash table of size 16 bit slots" },
+    { "zipf",           run_zipf,           1024,   20000, 1, "Zipf distributed access to size bytes" },
+    { "stride",         run_stride,         1024,   20000, 1, "strided scan of size bytes" },
+    { "chase",          run_chase,          256,    10000, 4, "pointer chasing through a list of size nodes" },
+};
+#define NWORKLOADS ((int) (sizeof(workloads) / sizeof(workloads[0])))
+
+static const struct workload *find_workload(const char *name) {
+    for (int i = 0; i < NWORKLOADS; i++) {
+        if (0 == strcasecmp(workloads[i].name, name)) {
+            return &workloads[i];
+        }
+    }
+    return NULL;
+}
+
+bool workload_exists(const char *name) {
+    return find_workload(name) != NULL;
+}
+
+bool workload_run(const char *name, struct workload_params *params, struct workload_result *result) {
+    const struct workload *w = find_workload(name);
+    if (w == NULL) {
+        return false;
+    }
+    if (params->size <= 0) {
+        params->size = w->size;
+    }
+    if (params->ops <= 0) {
+        params->ops = w->ops;
+    }
+    // memory used: size units, size x size units for the matrices
+    long bytes = (long) params->size * w->elem_size;
+    if ((w->run == run_matmul) || (w->run == run_matmul_blocked)) {
+        bytes *= params->size;
+    }
+    TEST_AND_EXIT((params->size < 2) || (bytes > VMEM_VIRTMEMSIZE),
+                  (stderr, "workload %s: size %d does not fit into %ld bytes of virtual memory\n",
+                   name, params->size, VMEM_VIRTMEMSIZE));
+
+    accesses = 0;
+    checksum = 2166136261u;
+    my_srand(params->seed);
+    w->run(params);
+    result->accesses = accesses;
+    result->checksum = checksum;
+    return true;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function replays an event of an access trace.
+ *
+ *  @param      ev Event
+ *  @param      stamp Value stored by writes, changed on each write
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void replay_event(const struct trace_event *ev, uint64_t *stamp) {
+    static unsigned char buf[REPLAY_RUN_BUFSIZE];
+    bool write = ev->kind & TRACE_WRITE;
+    if (ev->kind & TRACE_RUN) {
+        for (long done = 0; done < ev->len; done += REPLAY_RUN_BUFSIZE) {
+            int len = (ev->len - done < REPLAY_RUN_BUFSIZE) ? ev->len - done : REPLAY_RUN_BUFSIZE;
+            if (write) {
+                memset(buf, (unsigned char) ++*stamp, len);
+                vmem_write_range(ev->address + done, buf, len);
+            } else {
+                vmem_read_range(ev->address + done, buf, len);
+                add_checksum(buf[0]);
+            }
+        }
+        return;
+    }
+    TEST_AND_EXIT((ev->len != 1) && (ev->len != 2) && (ev->len != 4) && (ev->len != 8),
+                  (stderr, "replay: value of %ld bytes\n", ev->len));
+    if (!write) {
+        uint64_t val = (ev->len == 1) ? vmem_read(ev->address) :
+                       (ev->len == 2) ? vmem_read_u16(ev->address) :
+                       (ev->len == 4) ? vmem_read_u32(ev->address) : vmem_read_u64(ev->address);
+        add_checksum(val);
+        return;
+    }
+    ++*stamp;
+    switch (ev->len) {
+        case 1:  vmem_write(ev->address, *stamp);     break;
+        case 2:  vmem_write_u16(ev->address, *stamp); break;
+        case 4:  vmem_write_u32(ev->address, *stamp); break;
+        default: vmem_write_u64(ev->address, *stamp); break;
+    }
+}
+
+void workload_replay(const char *file, struct workload_result *result) {
+    struct stat st;
+    int fd = open(file, O_RDONLY);
+    TEST_AND_EXIT_ERRNO(fd == -1, "Error opening trace");
+    TEST_AND_EXIT_ERRNO(fstat(fd, &st) == -1, "Error reading trace");
+    TEST_AND_EXIT(st.st_size < (off_t) sizeof(struct trace_header), (stderr, "%s: not a trace\n", file));
+    const unsigned char *trace = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    TEST_AND_EXIT_ERRNO(trace == MAP_FAILED, "Error mapping trace");
+    close(fd);
+    madvise((void *) trace, st.st_size, MADV_SEQUENTIAL);
+
+    const struct trace_header *hdr = (const struct trace_header *) trace;
+    TEST_AND_EXIT(!trace_check_header(hdr), (stderr, "%s: not a trace of version %d\n", file, TRACE_VERSION));
+    TEST_AND_EXIT(hdr->virtmemsize > VMEM_VIRTMEMSIZE,
+                  (stderr, "%s: trace of %ld bytes does not fit into %ld bytes of virtual memory\n",
+                   file, hdr->virtmemsize, VMEM_VIRTMEMSIZE));
+
+    const unsigned char *pos = trace + sizeof(struct trace_header);
+    const unsigned char *end = trace + st.st_size;
+    long next = 0;
+    uint64_t stamp = 0;
+    accesses = 0;
+    checksum = 2166136261u;
+    while (pos < end) {
+        struct trace_event ev;
+        size_t n = trace_decode(pos, end - pos, &ev, &next);
+        TEST_AND_EXIT(n == 0, (stderr, "%s: trace truncated\n", file));
+        pos += n;
+        replay_event(&ev, &stamp);
+        accesses += trace_accesses(&ev);
+    }
+    munmap((void *) trace, st.st_size);
+    result->accesses = accesses;
+    result->checksum = checksum;
+}
+
+void workload_print_list(FILE *out) {
+    for (int i = 0; i < NWORKLOADS; i++) {
+        fprintf(out, "     %-15s : %s (default size %d", workloads[i].name, workloads[i].description, workloads[i].size);
+        if (workloads[i].ops > 0) {
+            fprintf(out, ", ops %d", workloads[i].ops);
+        }
+        fprintf(out, ")\n");
+    }
+}
+
+// EOF
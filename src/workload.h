@@ -0,0 +1,88 @@
+/**
+ * @file workload.h
+ * @date Oct 2026
+ * @brief Header file of the benchmark workloads of vmappl. Besides sorting,
+ *        vmappl may run one of these access patterns on virtual memory:
+ *        naive and blocked matrix multiply, binary search, hash table probing,
+ *        Zipf distributed random access, strided scan and pointer chasing.
+ *        Besides, it may replay an access trace.
+ *        All workloads access virtual memory via vmaccess.
+ */
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Parameters of a workload. A value of 0 selects the default of the workload.
+ */
+struct workload_params {
+    int size;       //!< problem size, e.g. matrix dimension or number of elements
+    int ops;        //!< number of operations, e.g. lookups or steps
+    int stride;     //!< stride of the strided scan in bytes
+    int seed;       //!< init value of the random number generator
+    int pin_levels; //!< binary search: number of upper levels of the search tree that will be pinned
+};
+
+/**
+ * Result of a workload
+ */
+struct workload_result {
+    long accesses;      //!< number of virtual memory accesses
+    uint32_t checksum;  //!< checksum of the values computed or read
+};
+
+/**
+ *****************************************************************************************
+ *  @brief      This function runs a workload. Parameters equal to 0 will be replaced
+ *              by the defaults of the workload.
+ *
+ *  @param      name Name of the workload
+ *
+ *  @param      params Parameters of the workload
+ *
+ *  @param      result Access count and checksum of the run
+ *
+ *  @return     false, if the workload is undefined
+ ****************************************************************************************/
+bool workload_run(const char *name, struct workload_params *params, struct workload_result *result);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function replays an access trace, e.g. of a real application
+ *              converted by vmimport. Each event is replayed by the vmaccess function
+ *              that records it, so the accesses equal the accesses of the trace.
+ *              Stores write varying values, so none of them is silent.
+ *
+ *  @param      file Name of the access trace
+ *
+ *  @param      result Access count and checksum of the values read
+ *
+ *  @return     void
+ ****************************************************************************************/
+void workload_replay(const char *file, struct workload_result *result);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function checks, whether a workload is defined.
+ *
+ *  @param      name Name of the workload
+ *
+ *  @return     true, if the workload is defined
+ ****************************************************************************************/
+bool workload_exists(const char *name);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function prints the names and descriptions of all workloads.
+ *
+ *  @param      out Stream the list is printed to.
+ *
+ *  @return     void
+ ****************************************************************************************/
+void workload_print_list(FILE *out);
+
+#endif /* WORKLOAD_H */
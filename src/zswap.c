@@ -0,0 +1,456 @@
+ /**
+  * @file zswap.c
+  * @date Oct 2026
+  * @brief This is the compressed swap pool. Pages are compressed with a
+  * delta + run length codec, that suits byte data like sorted runs or
+  * regions of equal values. The compressed pages are stored in a size
+  * class slab allocator.
+  * The pool keeps its copy of a page on load. So the pool copy or - if
+  * there is none - the pagefile always contains the backing copy of a page.
+  */
+
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "vmem.h"
+#include "pagefile.h"
+#include "zswap.h"
+
+#define ZSWAP_NCLASSES  16                  //!< Number of size classes of the slab allocator
+#define ZSWAP_SLABSIZE  4096                //!< Bytes allocated for a new slab, at least one slot
+#define ZSWAP_CLASSSTEP ((VMEM_GEO_PAGESIZE + ZSWAP_NCLASSES - 1) / ZSWAP_NCLASSES) //!< Size difference of two size classes
+#define ZSWAP_MAXCODE   (VMEM_GEO_PAGESIZE + VMEM_GEO_PAGESIZE / 128 + 1) //!< Worst case size of a compressed page
+
+#define RLE_MINRUN      3                   //!< Shortest run that will be encoded as repeat
+#define RLE_MAXRUN      (127 + RLE_MINRUN)  //!< Longest run of one repeat code
+#define RLE_MAXLIT      128                 //!< Longest literal sequence of one literal code
+
+/**
+ * A page stored in the pool
+ */
+struct zswap_entry {
+    unsigned char *slot;     //!< Slot of the slab allocator that holds the data; NULL: page not in pool
+    struct zswap_slab *slab; //!< Slab of slot
+    int cls;                 //!< Size class of slot
+    int len;                 //!< Length of compressed data
+    long prev;               //!< Previous page in LRU list (VOID_IDX: none)
+    long next;               //!< Next page in LRU list (VOID_IDX: none)
+};
+
+/**
+ * Slab of the slab allocator. The free slots of a slab are kept on a stack of slot 
+ * numbers. A slab will be released, as soon as all of its slots are free.
+ */
+struct zswap_slab {
+    unsigned char *mem;              //!< slots of the slab
+    unsigned short *free_slots;      //!< stack of free slot numbers, a slab has at most ZSWAP_SLABSIZE slots
+    int nfree;                       //!< number of free slots on stack
+    int nslots;                      //!< number of slots
+    struct zswap_slab *prev;         //!< previous slab of the class with free slots
+    struct zswap_slab *next;         //!< next slab of the class with free slots
+};
+
+/**
+ * Size class of the slab allocator
+ */
+struct zswap_class {
+    struct zswap_slab *partial; //!< slabs with free slots; NULL: a new slab is required
+};
+
+/**
+ * Table of the pool entries indexed by page number. Like the page table, it is a 
+ * radix tree: the root refers to mid nodes, a mid node to chunks of entries. Mid
+ * nodes and chunks are allocated on the first store of one of their pages, so the
+ * table uses memory in proportion to the pages stored.
+ */
+#define ZSWAP_CHUNK_PAGES 1024                     //!< entries per chunk of the entry table
+#define ZSWAP_MID_CHUNKS  1024                     //!< chunks per mid node
+#define ZSWAP_MID_PAGES   ((long) ZSWAP_CHUNK_PAGES * ZSWAP_MID_CHUNKS) //!< pages per mid node
+
+static struct zswap_entry ***entries = NULL;     //!< root of the entry table: mid nodes; NULL: mid node unused
+static struct zswap_class classes[ZSWAP_NCLASSES];
+static unsigned char *delta_buf = NULL;  //!< deltas of compress_page, VMEM_GEO_PAGESIZE bytes
+static unsigned char *code_buf = NULL;   //!< compressed page of zswap_store, ZSWAP_MAXCODE bytes
+static unsigned char *page_buf = NULL;   //!< page written back by writeback_lru, VMEM_GEO_PAGESIZE bytes
+
+static size_t budget = 0;      //!< memory budget of the pool, limits slab_bytes
+static size_t used = 0;        //!< bytes of all occupied slots
+static size_t slab_bytes = 0;  //!< bytes of all slabs
+static long lru_head = VOID_IDX; //!< least recently stored page
+static long lru_tail = VOID_IDX; //!< most recently stored page
+static int nentries = 0;       //!< number of pages in pool
+
+/* statistics */
+static long loads = 0;         //!< number of calls of zswap_load, zswap_peek is not counted
+static long hits = 0;          //!< number of loads served from the pool
+static long stores = 0;        //!< number of pages stored in the pool
+static long incompressible = 0; //!< number of pages stored uncompressed
+static long writebacks = 0;    //!< number of pages written back to pagefile
+static long bytes_in = 0;      //!< uncompressed bytes of stored pages
+static long bytes_out = 0;     //!< compressed bytes of stored pages
+
+/**
+ *****************************************************************************************
+ *  @brief      This function compresses a page. The bytes will be delta encoded first.
+ *              The deltas will be run length encoded: A code byte c < 128 is followed
+ *              by c + 1 literals, a code byte c >= 128 is followed by one byte that
+ *              repeats c - 128 + RLE_MINRUN times.
+ *
+ *  @param      src page to be compressed
+ *  @param      dst buffer of at least ZSWAP_MAXCODE bytes
+ *
+ *  @return     length of compressed data
+ ****************************************************************************************/
+static int compress_page(const unsigned char *src, unsigned char *dst) {
+    unsigned char *delta = delta_buf;
+    unsigned char prev = 0;
+    int i = 0;
+    int len = 0;
+
+    for (i = 0; i < VMEM_GEO_PAGESIZE; i++) {
+        delta[i] = src[i] - prev;
+        prev = src[i];
+    }
+
+    i = 0;
+    while (i < VMEM_GEO_PAGESIZE) {
+        int run = 1;
+        while ((i + run < VMEM_GEO_PAGESIZE) && (run < RLE_MAXRUN) && (delta[i + run] == delta[i])) {
+            run++;
+        }
+        if (run >= RLE_MINRUN) {
+            dst[len++] = 128 + run - RLE_MINRUN;
+            dst[len++] = delta[i];
+            i += run;
+        } else {
+            // collect literals until the next run starts
+            int start = i;
+            int nlit = 0;
+            while ((i < VMEM_GEO_PAGESIZE) && (nlit < RLE_MAXLIT)) {
+                if ((i + 2 < VMEM_GEO_PAGESIZE) && (delta[i] == delta[i + 1]) && (delta[i] == delta[i + 2])) {
+                    break;
+                }
+                i++;
+                nlit++;
+            }
+            dst[len++] = nlit - 1;
+            memcpy(&dst[len], &delta[start], nlit);
+            len += nlit;
+        }
+    }
+    return len;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function decompresses a page compressed by compress_page.
+ *
+ *  @param      src compressed data
+ *  @param      len length of compressed data
+ *  @param      dst frame that will store the page
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void decompress_page(const unsigned char *src, int len, unsigned char *dst) {
+    unsigned char prev = 0;
+    int pos = 0;
+    int i = 0;
+
+    while (i < len) {
+        int code = src[i++];
+        if (code < 128) {
+            for (int n = 0; n <= code; n++) {
+                prev += src[i++];
+                dst[pos++] = prev;
+            }
+        } else {
+            for (int n = 0; n < code - 128 + RLE_MINRUN; n++) {
+                prev += src[i];
+                dst[pos++] = prev;
+            }
+            i++;
+        }
+    }
+    TEST_AND_EXIT(pos != VMEM_GEO_PAGESIZE, (stderr, "zswap: corrupted page in pool\n"));
+}
+
+static int class_size(int cls) {
+    return (cls + 1) * ZSWAP_CLASSSTEP;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function computes the size of a new slab of a size class. A slab
+ *              holds at least one slot. A small budget shrinks the slabs, so that 
+ *              slabs of all classes fit into the budget at the same time.
+ *
+ *  @param      cls size class
+ *
+ *  @return     bytes of a slab
+ ****************************************************************************************/
+static int slab_size(int cls) {
+    int size = class_size(cls);
+    int slabsize = (budget / ZSWAP_NCLASSES < ZSWAP_SLABSIZE) ? (int) (budget / ZSWAP_NCLASSES) : ZSWAP_SLABSIZE;
+    return (size > slabsize) ? size : slabsize / size * size; // a slot of a large page fills a slab
+}
+
+static void partial_unlink(int cls, struct zswap_slab *s) {
+    if (s->prev != NULL) s->prev->next = s->next; else classes[cls].partial = s->next;
+    if (s->next != NULL) s->next->prev = s->prev;
+    s->prev = s->next = NULL;
+}
+
+static void partial_push(int cls, struct zswap_slab *s) {
+    s->prev = NULL;
+    s->next = classes[cls].partial;
+    if (s->next != NULL) s->next->prev = s;
+    classes[cls].partial = s;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function allocates a slot of a size class. If no slab of the class
+ *              has a free slot, a new slab will be allocated. The caller must make 
+ *              sure, that the new slab fits into the budget.
+ *
+ *  @param      cls size class
+ *  @param      slab slab of the slot
+ *
+ *  @return     slot
+ ****************************************************************************************/
+static unsigned char *slab_alloc(int cls, struct zswap_slab **slab) {
+    struct zswap_slab *s = classes[cls].partial;
+    int size = class_size(cls);
+
+    if (s == NULL) {
+        // carve a new slab into slots of this class
+        int slabsize = slab_size(cls);
+        s = malloc(sizeof(struct zswap_slab));
+        TEST_AND_EXIT_ERRNO(!s, "zswap: malloc of slab failed");
+        s->nslots = slabsize / size;
+        s->mem = malloc(slabsize);
+        s->free_slots = malloc(s->nslots * sizeof(unsigned short));
+        TEST_AND_EXIT_ERRNO(!s->mem || !s->free_slots, "zswap: malloc of slab failed");
+        for (s->nfree = 0; s->nfree < s->nslots; s->nfree++) {
+            s->free_slots[s->nfree] = s->nslots - 1 - s->nfree;
+        }
+        partial_push(cls, s);
+        slab_bytes += slabsize;
+    }
+    int i = s->free_slots[--s->nfree];
+    if (s->nfree == 0) {
+        partial_unlink(cls, s);
+    }
+    used += size;
+    *slab = s;
+    return &s->mem[i * size];
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function frees a slot. A slab without occupied slots will be 
+ *              released.
+ *
+ *  @param      cls size class
+ *  @param      s slab of the slot
+ *  @param      slot slot to be freed
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void slab_free(int cls, struct zswap_slab *s, unsigned char *slot) {
+    int size = class_size(cls);
+    TEST_AND_EXIT(s->nfree >= s->nslots, (stderr, "zswap: free list overflow\n"));
+    if (s->nfree == 0) {
+        partial_push(cls, s);
+    }
+    s->free_slots[s->nfree++] = (slot - s->mem) / size;
+    used -= size;
+    if (s->nfree == s->nslots) {
+        partial_unlink(cls, s);
+        slab_bytes -= (size_t) s->nslots * size;
+        free(s->mem);
+        free(s->free_slots);
+        free(s);
+    }
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function returns the pool entry of a page. The mid node and the
+ *              chunk of the entry will be allocated on the first store of one of 
+ *              their pages.
+ *
+ *  @param      pageNo Number of page
+ *  @param      create true: allocate the mid node and the chunk of the entry, if required
+ *
+ *  @return     entry; NULL, if create is false and the chunk has not been allocated
+ ****************************************************************************************/
+static struct zswap_entry *entry(long pageNo, bool create) {
+    struct zswap_entry ***mid = &entries[pageNo / ZSWAP_MID_PAGES];
+    if (*mid == NULL) {
+        if (!create) {
+            return NULL;
+        }
+        *mid = calloc(ZSWAP_MID_CHUNKS, sizeof(struct zswap_entry *));
+        TEST_AND_EXIT_ERRNO(!*mid, "zswap: calloc of entry table failed");
+    }
+    struct zswap_entry **chunk = &(*mid)[(pageNo / ZSWAP_CHUNK_PAGES) % ZSWAP_MID_CHUNKS];
+    if (*chunk == NULL) {
+        if (!create) {
+            return NULL;
+        }
+        *chunk = malloc(ZSWAP_CHUNK_PAGES * sizeof(struct zswap_entry));
+        TEST_AND_EXIT_ERRNO(!*chunk, "zswap: malloc of entries failed");
+        for (int i = 0; i < ZSWAP_CHUNK_PAGES; i++) {
+            (*chunk)[i].slot = NULL;
+            (*chunk)[i].prev = (*chunk)[i].next = VOID_IDX;
+        }
+    }
+    return &(*chunk)[pageNo % ZSWAP_CHUNK_PAGES];
+}
+
+static void lru_unlink(long pageNo) {
+    struct zswap_entry *e = entry(pageNo, false);
+    if (e->prev != VOID_IDX) entry(e->prev, false)->next = e->next; else lru_head = e->next;
+    if (e->next != VOID_IDX) entry(e->next, false)->prev = e->prev; else lru_tail = e->prev;
+    e->prev = e->next = VOID_IDX;
+}
+
+static void lru_append(long pageNo) {
+    struct zswap_entry *e = entry(pageNo, false);
+    e->prev = lru_tail;
+    e->next = VOID_IDX;
+    if (lru_tail != VOID_IDX) entry(lru_tail, false)->next = pageNo; else lru_head = pageNo;
+    lru_tail = pageNo;
+}
+
+static void read_entry(long pageNo, unsigned char *frame_start) {
+    struct zswap_entry *e = entry(pageNo, false);
+    if (e->len == VMEM_GEO_PAGESIZE) {
+        memcpy(frame_start, e->slot, VMEM_GEO_PAGESIZE); // stored uncompressed
+    } else {
+        decompress_page(e->slot, e->len, frame_start);
+    }
+}
+
+static void drop_entry(long pageNo) {
+    struct zswap_entry *e = entry(pageNo, false);
+    lru_unlink(pageNo);
+    slab_free(e->cls, e->slab, e->slot);
+    e->slot = NULL;
+    e->slab = NULL;
+    nentries--;
+}
+
+/**
+ *****************************************************************************************
+ *  @brief      This function writes the least recently stored page of the pool
+ *              back to the pagefile and removes it from the pool.
+ *
+ *  @return     void
+ ****************************************************************************************/
+static void writeback_lru(void) {
+    long pageNo = lru_head;
+
+    TEST_AND_EXIT(pageNo == VOID_IDX, (stderr, "zswap: writeback of empty pool\n"));
+    read_entry(pageNo, page_buf);
+    store_page_to_pagefile(pageNo, page_buf);
+    drop_entry(pageNo);
+    writebacks++;
+}
+
+void zswap_init(size_t pool_budget) {
+    budget = pool_budget;
+    entries = calloc((VMEM_NBACKING_PAGES + ZSWAP_MID_PAGES - 1) / ZSWAP_MID_PAGES, sizeof(struct zswap_entry **));
+    TEST_AND_EXIT_ERRNO(!entries, "zswap: calloc of entry table failed");
+    // the buffers are page sized, a page may be too large for the stack
+    delta_buf = malloc(VMEM_GEO_PAGESIZE);
+    code_buf = malloc(ZSWAP_MAXCODE);
+    page_buf = malloc(VMEM_GEO_PAGESIZE);
+    TEST_AND_EXIT_ERRNO(!delta_buf || !code_buf || !page_buf, "zswap: malloc of buffers failed");
+}
+
+bool zswap_peek(long pageNo, unsigned char *frame_start) {
+    TEST_AND_EXIT((pageNo < 0) || (pageNo >= VMEM_NBACKING_PAGES), (stderr, "zswap: pageNo out of range\n"));
+    struct zswap_entry *e = entry(pageNo, false);
+    if ((e == NULL) || (e->slot == NULL)) {
+        return false;
+    }
+    read_entry(pageNo, frame_start);
+    return true;
+}
+
+bool zswap_load(long pageNo, unsigned char *frame_start) {
+    loads++;
+    if (!zswap_peek(pageNo, frame_start)) {
+        return false;
+    }
+    hits++;
+    return true;
+}
+
+void zswap_store(long pageNo, const unsigned char *frame_start) {
+    const unsigned char *data = code_buf;
+    int len = 0;
+    int cls = 0;
+
+    TEST_AND_EXIT((pageNo < 0) || (pageNo >= VMEM_NBACKING_PAGES), (stderr, "zswap_store: pageNo out of range\n"));
+
+    struct zswap_entry *e = entry(pageNo, true);
+    if (e->slot != NULL) {
+        drop_entry(pageNo); // replace outdated copy
+    }
+
+    len = compress_page(frame_start, code_buf);
+    if (len >= VMEM_GEO_PAGESIZE) {
+        len = VMEM_GEO_PAGESIZE;
+        data = frame_start;
+    }
+    cls = (len + ZSWAP_CLASSSTEP - 1) / ZSWAP_CLASSSTEP - 1;
+
+    if ((size_t) slab_size(cls) > budget) {
+        // does not fit into the pool at all
+        store_page_to_pagefile(pageNo, (unsigned char *) frame_start);
+        writebacks++;
+        return;
+    }
+    // a new slab is required, if no slab of the class has a free slot
+    while ((classes[cls].partial == NULL) && (slab_bytes + slab_size(cls) > budget)) {
+        writeback_lru();
+    }
+
+    e->cls = cls;
+    e->len = len;
+    e->slot = slab_alloc(cls, &e->slab);
+    memcpy(e->slot, data, len);
+    lru_append(pageNo);
+    nentries++;
+
+    stores++;
+    incompressible += (len == VMEM_GEO_PAGESIZE);
+    bytes_in += VMEM_GEO_PAGESIZE;
+    bytes_out += len;
+}
+
+void zswap_print_stats(FILE *out) {
+    fprintf(out, "zswap loads        %10ld, hits %10ld, hit rate %6.2f %%\n",
+            loads, hits, loads ? 100.0 * hits / loads : 0.0);
+    fprintf(out, "zswap stores       %10ld, incompressible %10ld, writebacks %10ld\n",
+            stores, incompressible, writebacks);
+    fprintf(out, "zswap compression  %10ld bytes -> %10ld bytes, ratio %6.2f\n",
+            bytes_in, bytes_out, bytes_out ? (double) bytes_in / bytes_out : 0.0);
+    fprintf(out, "zswap occupancy    %10d pages, slots %10zu bytes, slabs %zu of %zu bytes (%6.2f %%)\n",
+            nentries, used, slab_bytes, budget, budget ? 100.0 * slab_bytes / budget : 0.0);
+}
+
+void zswap_cleanup(void) {
+    while (lru_head != VOID_IDX) {
+        writeback_lru(); // releases the slabs
+    }
+    free(delta_buf);
+    free(code_buf);
+    free(page_buf);
+    delta_buf = code_buf = page_buf = NULL;
+}
+
+// EOF
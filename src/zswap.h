@@ -0,0 +1,89 @@
+/**
+ * @file zswap.h
+ * @date Oct 2026
+ * @brief Header file of the compressed swap pool. The pool sits between the
+ *        frames of the main memory and the pagefile. Evicted pages are stored
+ *        compressed in memory and written back to the pagefile only when the
+ *        pool runs out of its memory budget.
+ */
+
+#ifndef ZSWAP_H
+#define ZSWAP_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ *****************************************************************************************
+ *  @brief      This function initializes the compressed swap pool.
+ *
+ *  @param      budget Number of bytes the pool may use to store compressed pages.
+ *
+ *  @return     void
+ ****************************************************************************************/
+void zswap_init(size_t budget);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function loads a page out of the pool. The pool keeps its copy,
+ *              hence a clean page may be dropped from main memory later on.
+ *
+ *  @param      pageNo Number of the page that should be loaded.
+ *
+ *  @param      frame_start Starting address of frame that should store the page.
+ *
+ *  @return     true, if the page has been found in the pool. Otherwise the page must
+ *              be fetched from the pagefile.
+ ****************************************************************************************/
+bool zswap_load(long pageNo, unsigned char *frame_start);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function reads a page out of the pool like zswap_load, but it is
+ *              not counted as load. It serves the memory manager, that reads the 
+ *              backing copy of a page for another reason than a page fault.
+ *
+ *  @param      pageNo Number of the page that should be read.
+ *
+ *  @param      frame_start Buffer that should store the page.
+ *
+ *  @return     true, if the page has been found in the pool.
+ ****************************************************************************************/
+bool zswap_peek(long pageNo, unsigned char *frame_start);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function stores a page in the pool. An older copy of this page will
+ *              be replaced. If the memory budget of the pool is exceeded, the least
+ *              recently stored pages will be written back to the pagefile.
+ *
+ *  @param      pageNo Number of the page that should be stored.
+ *
+ *  @param      frame_start Starting address of the frame that contains the page.
+ *
+ *  @return     void
+ ****************************************************************************************/
+void zswap_store(long pageNo, const unsigned char *frame_start);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function prints hit rate, compression ratio and occupancy
+ *              of the pool.
+ *
+ *  @param      out Stream the statistics are printed to.
+ *
+ *  @return     void
+ ****************************************************************************************/
+void zswap_print_stats(FILE *out);
+
+/**
+ *****************************************************************************************
+ *  @brief      This function writes all pages of the pool back to the pagefile
+ *              and releases the pool.
+ *
+ *  @return     void
+ ****************************************************************************************/
+void zswap_cleanup(void);
+
+#endif /* ZSWAP_H */